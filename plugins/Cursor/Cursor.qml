@@ -34,6 +34,8 @@ MousePointer {
             x: -imageInfo.hotspot.x
             y: -imageInfo.hotspot.y
             source: imageInfo.imageSource
+            frameX: imageInfo.frameX
+            frameY: imageInfo.frameY
 
             interpolate: false
 
@@ -51,12 +53,22 @@ MousePointer {
 
     Loader {
         active: mousePointer.visible && imageInfo.frameCount === 1
-        sourceComponent: Image {
+        // The image holds all the cursors of the theme, changing the shape
+        // only moves it around under the clip
+        sourceComponent: Item {
             x: -imageInfo.hotspot.x
             y: -imageInfo.hotspot.y
-            source: imageInfo.imageSource
-            width: sourceSize.width
-            height: sourceSize.height
+            width: imageInfo.frameWidth
+            height: imageInfo.frameHeight
+            clip: true
+
+            Image {
+                x: -imageInfo.frameX
+                y: -imageInfo.frameY
+                source: imageInfo.imageSource
+                width: sourceSize.width
+                height: sourceSize.height
+            }
         }
     }
 }
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CursorAtlas.h"
+#include "CursorImageProvider.h"
+
+#include <QPainter>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+// Keeps neighbouring frames apart should the texture ever be filtered
+static const int kPadding = 1;
+
+CursorAtlas::CursorAtlas(const QString &themeName, int cursorHeight, int generation,
+                         const QList<QPair<QString, const CursorImage*> > &cursors)
+    : m_themeName(themeName)
+    , m_cursorHeight(cursorHeight)
+    , m_generation(generation)
+{
+    QVector<const CursorImage*> images;
+    int widest = 0;
+    qint64 area = 0;
+    for (int i = 0; i < cursors.count(); ++i) {
+        const CursorImage *cursorImage = cursors[i].second;
+        if (cursorImage && !cursorImage->qimage.isNull() && !images.contains(cursorImage)) {
+            images << cursorImage;
+            widest = qMax(widest, cursorImage->qimage.width());
+            area += qint64(cursorImage->qimage.width() + kPadding) * (cursorImage->qimage.height() + kPadding);
+        }
+    }
+
+    // Shelf packing: tallest first, left to right, in rows about as wide
+    // as the atlas will be tall
+    std::sort(images.begin(), images.end(), [](const CursorImage *a, const CursorImage *b) {
+        return a->qimage.height() > b->qimage.height();
+    });
+
+    const int atlasWidth = qMax(widest, (int) std::ceil(std::sqrt((double) area)));
+    QHash<const CursorImage*, QPoint> placed;
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+    Q_FOREACH(const CursorImage *cursorImage, images) {
+        const QSize size = cursorImage->qimage.size();
+        if (x > 0 && x + size.width() > atlasWidth) {
+            y += shelfHeight + kPadding;
+            x = 0;
+            shelfHeight = 0;
+        }
+        placed.insert(cursorImage, QPoint(x, y));
+        x += size.width() + kPadding;
+        shelfHeight = qMax(shelfHeight, size.height());
+    }
+
+    m_image = QImage(qMax(1, atlasWidth), qMax(1, y + shelfHeight), QImage::Format_ARGB32);
+    m_image.fill(Qt::transparent);
+    {
+        QPainter painter(&m_image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (auto it = placed.constBegin(); it != placed.constEnd(); ++it) {
+            painter.drawImage(it.value(), it.key()->qimage);
+        }
+    }
+
+    for (int i = 0; i < cursors.count(); ++i) {
+        const CursorImage *cursorImage = cursors[i].second;
+        if (placed.contains(cursorImage)) {
+            Cursor cursor;
+            cursor.position = placed.value(cursorImage);
+            cursor.hotspot = cursorImage->hotspot;
+            cursor.frameWidth = cursorImage->frameWidth;
+            cursor.frameHeight = cursorImage->frameHeight;
+            cursor.frameCount = cursorImage->frameCount;
+            cursor.frameDuration = cursorImage->frameDuration;
+            m_cursors.insert(cursors[i].first, cursor);
+            m_cursorNames << cursors[i].first;
+        }
+    }
+}
+
+QUrl CursorAtlas::source() const
+{
+    return QUrl(QStringLiteral("image://cursor/atlas/%1/%2/%3")
+        .arg(m_themeName)
+        .arg(m_cursorHeight)
+        .arg(m_generation));
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CURSOR_ATLAS_H
+#define CURSOR_ATLAS_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QPoint>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+class CursorImage;
+
+/*
+ * The cursors of a theme, at a given height, packed in a single image.
+ *
+ * Each cursor keeps its frames in a row, as in CursorImage::qimage. Names
+ * that resolve to the same CursorImage (e.g. through fallbacks) share the
+ * same frames. The atlas doesn't keep the CursorImages it was built from.
+ *
+ * The source() of an atlas is unique to it, so a rebuilt atlas is never
+ * confused with an older one in the pixmap cache.
+ */
+class CursorAtlas
+{
+public:
+    // Everything needed to show a cursor out of the atlas
+    struct Cursor {
+        // Where its first frame is, the others follow in the same row
+        QPoint position;
+        QPoint hotspot;
+        int frameWidth{0};
+        int frameHeight{0};
+        int frameCount{1};
+        int frameDuration{40};
+    };
+
+    CursorAtlas(const QString &themeName, int cursorHeight, int generation,
+                const QList<QPair<QString, const CursorImage*> > &cursors);
+
+    QString themeName() const { return m_themeName; }
+    int cursorHeight() const { return m_cursorHeight; }
+    int generation() const { return m_generation; }
+
+    QImage image() const { return m_image; }
+    QUrl source() const;
+    int byteCount() const { return m_image.byteCount(); }
+
+    bool contains(const QString &cursorName) const { return m_cursors.contains(cursorName); }
+    Cursor cursor(const QString &cursorName) const { return m_cursors.value(cursorName); }
+    // In the order they were given, building an atlas out of the same
+    // names again packs them the same way
+    QStringList cursorNames() const { return m_cursorNames; }
+
+private:
+    QString m_themeName;
+    int m_cursorHeight;
+    int m_generation;
+    QImage m_image;
+    QHash<QString, Cursor> m_cursors;
+    QStringList m_cursorNames;
+};
+
+#endif // CURSOR_ATLAS_H
@@ -19,6 +19,13 @@
 CursorImageInfo::CursorImageInfo(QObject *parent)
     : QObject(parent)
 {
+    // Nothing to show yet
+    m_cursor.frameCount = 0;
+
+    if (CursorImageProvider::instance()) {
+        connect(CursorImageProvider::instance(), &CursorImageProvider::atlasReady,
+                this, &CursorImageInfo::onAtlasReady);
+    }
 }
 
 void CursorImageInfo::setCursorName(const QString &cursorName)
@@ -50,9 +57,15 @@ void CursorImageInfo::setThemeName(const QString &themeName)
 
 void CursorImageInfo::update()
 {
-    m_cursorImage = CursorImageProvider::instance()->fetchCursor(m_themeName, m_cursorName, (int) m_cursorHeight);
+    CursorImageProvider *provider = CursorImageProvider::instance();
+    if (!provider || !provider->fetchCursor(m_themeName, m_cursorName, (int) m_cursorHeight, &m_cursor, &m_imageSource)) {
+        // onAtlasReady() will tell
+        return;
+    }
 
     Q_EMIT hotspotChanged();
+    Q_EMIT frameXChanged();
+    Q_EMIT frameYChanged();
     Q_EMIT frameWidthChanged();
     Q_EMIT frameHeightChanged();
     Q_EMIT frameCountChanged();
@@ -60,56 +73,9 @@ void CursorImageInfo::update()
     Q_EMIT imageSourceChanged();
 }
 
-QPoint CursorImageInfo::hotspot() const
-{
-    if (m_cursorImage) {
-        return m_cursorImage->hotspot;
-    } else {
-        return QPoint();
-    }
-}
-
-qreal CursorImageInfo::frameWidth() const
-{
-    if (m_cursorImage) {
-        return m_cursorImage->frameWidth;
-    } else {
-        return 0;
-    }
-}
-
-qreal CursorImageInfo::frameHeight() const
-{
-    if (m_cursorImage) {
-        return m_cursorImage->frameHeight;
-    } else {
-        return 0;
-    }
-}
-
-int CursorImageInfo::frameCount() const
-{
-    if (m_cursorImage) {
-        return m_cursorImage->frameCount;
-    } else {
-        return 0;
-    }
-}
-
-int CursorImageInfo::frameDuration() const
+void CursorImageInfo::onAtlasReady(const QString &themeName, int cursorHeight)
 {
-    if (m_cursorImage) {
-        return m_cursorImage->frameDuration;
-    } else {
-        return 0;
+    if (themeName == m_themeName && cursorHeight == (int) m_cursorHeight) {
+        update();
     }
 }
-
-QUrl CursorImageInfo::imageSource() const
-{
-    auto urlString = QString("image://cursor/%1/%2/%3")
-        .arg(m_themeName, m_cursorName)
-        .arg(m_cursorHeight);
-
-    return QUrl(urlString);
-}
@@ -32,6 +32,9 @@ class CursorImageInfo : public QObject
     Q_PROPERTY(qreal cursorHeight READ cursorHeight WRITE setCursorHeight NOTIFY cursorHeightChanged)
 
     Q_PROPERTY(QPoint hotspot READ hotspot NOTIFY hotspotChanged)
+    // Where the first frame is in imageSource
+    Q_PROPERTY(qreal frameX READ frameX NOTIFY frameXChanged)
+    Q_PROPERTY(qreal frameY READ frameY NOTIFY frameYChanged)
     Q_PROPERTY(qreal frameWidth READ frameWidth NOTIFY frameWidthChanged)
     Q_PROPERTY(qreal frameHeight READ frameHeight NOTIFY frameHeightChanged)
     Q_PROPERTY(int frameCount READ frameCount NOTIFY frameCountChanged)
@@ -50,18 +53,22 @@ public:
     qreal cursorHeight() const { return m_cursorHeight; }
     void setCursorHeight(qreal);
 
-    QPoint hotspot() const;
-    qreal frameWidth() const;
-    qreal frameHeight() const;
-    int frameCount() const;
-    int frameDuration() const;
-    QUrl imageSource() const;
+    QPoint hotspot() const { return m_cursor.hotspot; }
+    qreal frameX() const { return m_cursor.position.x(); }
+    qreal frameY() const { return m_cursor.position.y(); }
+    qreal frameWidth() const { return m_cursor.frameWidth; }
+    qreal frameHeight() const { return m_cursor.frameHeight; }
+    int frameCount() const { return m_cursor.frameCount; }
+    int frameDuration() const { return m_cursor.frameDuration; }
+    QUrl imageSource() const { return m_imageSource; }
 
 Q_SIGNALS:
     void themeNameChanged();
     void cursorNameChanged();
     void cursorHeightChanged();
     void hotspotChanged();
+    void frameXChanged();
+    void frameYChanged();
     void frameWidthChanged();
     void frameHeightChanged();
     void frameCountChanged();
@@ -70,13 +77,16 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     void update();
+    void onAtlasReady(const QString &themeName, int cursorHeight);
 
 private:
     QString m_themeName;
     QString m_cursorName;
     qreal m_cursorHeight{0};
 
-    CursorImage *m_cursorImage{nullptr};
+    // Until the theme is loaded these stay at what was shown before
+    CursorAtlas::Cursor m_cursor;
+    QUrl m_imageSource;
 };
 
 #endif // CURSOR_IMAGE_INFO_H
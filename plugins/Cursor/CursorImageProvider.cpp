@@ -15,15 +15,31 @@
  */
 
 #include "CursorImageProvider.h"
+#include "CursorAtlas.h"
 
 #include <QCursor>
 #include <QDebug>
 #include <QFile>
 #include <QPainter>
 #include <QSvgRenderer>
+#include <QtConcurrent>
 
 CursorImageProvider *CursorImageProvider::m_instance = nullptr;
 
+// Enough for a handful of themes or heights
+static const qint64 kMaxAtlasBytes = 4 * 1024 * 1024;
+
+// What goes in a new atlas, so the usual shape changes don't need a new one.
+// These are the names the Qt cursor shapes map to plus the ones the shell uses.
+static const char *const atlasCursorNames[] = {
+    "left_ptr", "up_arrow", "cross", "watch", "ibeam", "size_ver", "size_hor",
+    "size_bdiag", "size_fdiag", "size_all", "blank", "split_v", "split_h", "hand",
+    "forbidden", "whats_this", "left_ptr_watch", "openhand", "closedhand",
+    "dnd-copy", "dnd-move", "dnd-link", "grabbing",
+    "left_side", "right_side", "top_side", "bottom_side",
+    "top_left_corner", "top_right_corner", "bottom_left_corner", "bottom_right_corner",
+};
+
 /////
 // BuiltInCursorImage
 
@@ -155,6 +171,8 @@ CursorImageProvider::CursorImageProvider()
     }
     m_instance = this;
 
+    m_loaderPool.setMaxThreadCount(1);
+
     m_fallbackNames[QStringLiteral("closedhand")].append(QStringLiteral("grabbing"));
     m_fallbackNames[QStringLiteral("closedhand")].append(QStringLiteral("dnd-none"));
 
@@ -222,69 +240,139 @@ CursorImageProvider::CursorImageProvider()
 
 CursorImageProvider::~CursorImageProvider()
 {
-    {
-        QList< QMap<QString, CursorImage*> > cursorList = m_cursors.values();
-
-        for (int i = 0; i < cursorList.count(); ++i) {
-            QList<CursorImage*> cursorImageList = cursorList[i].values();
-            for (int j = 0; j < cursorImageList.count(); ++j) {
-                delete cursorImageList[j];
-            }
+    m_loaderPool.clear();
+    m_loaderPool.waitForDone();
+    // Loaded, but we never got to hear about it
+    Q_FOREACH(QFutureWatcher<CursorAtlas*> *watcher, m_pendingLoads) {
+        if (watcher->future().isFinished()) {
+            delete watcher->result();
         }
     }
 
-    m_cursors.clear();
+    qDeleteAll(m_atlases);
+    m_atlases.clear();
     m_instance = nullptr;
 }
 
-QImage CursorImageProvider::requestImage(const QString &cursorThemeAndNameAndHeight, QSize *size, const QSize & /*requestedSize*/)
+QString CursorImageProvider::atlasKey(const QString &themeName, int cursorHeight)
 {
-    CursorImage *cursorImage = fetchCursor(cursorThemeAndNameAndHeight);
-    size->setWidth(cursorImage->qimage.width());
-    size->setHeight(cursorImage->qimage.height());
-
-    return cursorImage->qimage;
+    return QStringLiteral("%1/%2").arg(themeName).arg(cursorHeight);
 }
 
-CursorImage *CursorImageProvider::fetchCursor(const QString &cursorThemeAndNameAndHeight)
+QImage CursorImageProvider::requestImage(const QString &cursorThemeAndNameAndHeight, QSize *size, const QSize & /*requestedSize*/)
 {
-    QString themeName;
-    QString cursorName;
-    int cursorHeight;
-    {
+    QImage image;
+
+    // atlas/themeName/cursorHeight/generation
+    if (cursorThemeAndNameAndHeight.startsWith(QLatin1String("atlas/"))) {
+        const QStringList atlasIdList = cursorThemeAndNameAndHeight.split('/');
+        if (atlasIdList.size() != 4) {
+            return QImage();
+        }
+        // A request for an older generation gets the current one, whoever
+        // asked for it is about to switch to it anyway
+        image = atlasImage(atlasIdList[1], atlasIdList[2].toInt());
+    } else {
+        // themeName/cursorName/cursorHeight
         QStringList themeAndNameList = cursorThemeAndNameAndHeight.split('/');
         if (themeAndNameList.size() != 3) {
-            return nullptr;
+            return QImage();
         }
-        themeName = themeAndNameList[0];
-        cursorName = themeAndNameList[1];
+        const QString &themeName = themeAndNameList[0];
+        const QString &cursorName = themeAndNameList[1];
 
         bool ok;
-        cursorHeight = themeAndNameList[2].toInt(&ok);
+        int cursorHeight = themeAndNameList[2].toInt(&ok);
         if (!ok) {
             cursorHeight = 32;
             qWarning().nospace() << "CursorImageProvider: invalid cursor height ("<<themeAndNameList[2]<<")."
                 " Falling back to "<<cursorHeight<<" pixels";
         }
+
+        if (cursorName.startsWith(QLatin1String("custom"))) {
+            if (m_customCursorImage) {
+                image = m_customCursorImage->qimage;
+            } else {
+                CursorAtlas::Cursor cursor;
+                image = atlasImage(themeName, QStringLiteral("left_ptr"), cursorHeight, &cursor)
+                    .copy(QRect(cursor.position, QSize(cursor.frameWidth * cursor.frameCount, cursor.frameHeight)));
+            }
+        } else {
+            CursorAtlas::Cursor cursor;
+            image = atlasImage(themeName, cursorName, cursorHeight, &cursor)
+                .copy(QRect(cursor.position, QSize(cursor.frameWidth * cursor.frameCount, cursor.frameHeight)));
+        }
     }
 
-    return fetchCursor(themeName, cursorName, cursorHeight);
+    *size = image.size();
+    return image;
 }
 
-CursorImage *CursorImageProvider::fetchCursor(const QString &themeName, const QString &cursorName, int cursorHeight)
+bool CursorImageProvider::fetchCursor(const QString &themeName, const QString &requestedCursorName, int cursorHeight,
+                                      CursorAtlas::Cursor *cursor, QUrl *imageSource)
 {
-    CursorImage *cursorImage = fetchCursorHelper(themeName, cursorName, cursorHeight);
+    QString cursorName = requestedCursorName;
+    if (cursorName.startsWith(QLatin1String("custom"))) {
+        if (!m_customCursorImage) {
+            cursorName = QStringLiteral("left_ptr");
+        } else {
+            *cursor = CursorAtlas::Cursor();
+            cursor->hotspot = m_customCursorImage->hotspot;
+            cursor->frameWidth = m_customCursorImage->frameWidth;
+            cursor->frameHeight = m_customCursorImage->frameHeight;
+            *imageSource = QUrl(QStringLiteral("image://cursor/%1/%2/%3")
+                .arg(themeName, cursorName)
+                .arg(cursorHeight));
+            return true;
+        }
+    }
+
+    const QString key = atlasKey(themeName, cursorHeight);
+    QMutexLocker locker(&m_atlasMutex);
+
+    const CursorAtlas *atlas = m_atlases.value(key);
+    if (atlas && atlas->contains(cursorName)) {
+        m_atlasesByUse.removeOne(key);
+        m_atlasesByUse.append(key);
+        *cursor = atlas->cursor(cursorName);
+        *imageSource = atlas->source();
+        return true;
+    }
+
+    if (!m_loadingAtlases.contains(key)) {
+        QStringList cursorNames = atlasCursorNamesFor(key);
+        cursorNames << cursorName;
+        loadAtlasAsync(themeName, cursorNames, cursorHeight);
+    }
+    return false;
+}
+
+CursorImage *CursorImageProvider::loadCursor(const QString &themeName, const QString &cursorName, int cursorHeight,
+                                             QHash<QString, CursorImage*> &loaded) const
+{
+    auto load = [&](const QString &name) {
+        CursorImage *cursorImage = loaded.value(name);
+        if (!cursorImage) {
+            if (name == QLatin1String("blank")) {
+                cursorImage = new BlankCursorImage();
+            } else {
+                cursorImage = new XCursorImage(themeName, name, cursorHeight);
+            }
+            loaded.insert(name, cursorImage);
+        }
+        return cursorImage;
+    };
+
+    CursorImage *cursorImage = load(cursorName);
 
     // Try some fallbacks
     if (cursorImage->qimage.isNull()) {
-        if (m_fallbackNames.contains(cursorName)) {
-            const QStringList &fallbackNames = m_fallbackNames[cursorName];
-            int i = 0;
-            while (cursorImage->qimage.isNull() && i < fallbackNames.count()) {
-                qDebug().nospace() << "CursorImageProvider: "<< cursorName <<" not found, trying " << fallbackNames.at(i);
-                cursorImage = fetchCursorHelper(themeName, fallbackNames.at(i), cursorHeight);
-                ++i;
-            }
+        const QStringList fallbackNames = m_fallbackNames.value(cursorName);
+        int i = 0;
+        while (cursorImage->qimage.isNull() && i < fallbackNames.count()) {
+            qDebug().nospace() << "CursorImageProvider: "<< cursorName <<" not found, trying " << fallbackNames.at(i);
+            cursorImage = load(fallbackNames.at(i));
+            ++i;
         }
     }
 
@@ -292,38 +380,163 @@ CursorImage *CursorImageProvider::fetchCursor(const QString &themeName, const QS
     if (cursorImage->qimage.isNull() && cursorName != QLatin1String("left_ptr")) {
         qDebug() << "CursorImageProvider:" << cursorName
             << "not found (nor its fallbacks, if any). Going for \"left_ptr\" as a last resort.";
-        cursorImage = fetchCursorHelper(themeName, QStringLiteral("left_ptr"), cursorHeight);
+        cursorImage = load(QStringLiteral("left_ptr"));
     }
 
     if (cursorImage->qimage.isNull()) {
         // finally, go for the built-in cursor
         qWarning() << "CursorImageProvider: couldn't find any cursors. Using the built-in one";
-        if (!m_builtInCursorImage || m_builtInCursorImage->requestedHeight != cursorHeight) {
-            m_builtInCursorImage.reset(new BuiltInCursorImage(cursorHeight));
+        cursorImage = loaded.value(QString());
+        if (!cursorImage) {
+            cursorImage = new BuiltInCursorImage(cursorHeight);
+            loaded.insert(QString(), cursorImage);
         }
-        cursorImage = m_builtInCursorImage.data();
     }
 
     return cursorImage;
 }
 
-CursorImage *CursorImageProvider::fetchCursorHelper(const QString &themeName, const QString &cursorName, int cursorHeight)
+CursorAtlas *CursorImageProvider::loadAtlas(const QString &themeName, QStringList cursorNames, int cursorHeight, int generation) const
 {
-    if (cursorName == QLatin1String("blank")) {
-        return &m_blankCursorImage;
-    } else if (cursorName.startsWith(QLatin1String("custom"))) {
-        return m_customCursorImage.data();
-    } else {
-        QMap<QString, CursorImage*> &themeCursors = m_cursors[themeName];
+    for (const char *name : atlasCursorNames) {
+        if (!cursorNames.contains(QLatin1String(name))) {
+            cursorNames << QString::fromLatin1(name);
+        }
+    }
 
-        if (!themeCursors.contains(cursorName)) {
-            themeCursors[cursorName] = new XCursorImage(themeName, cursorName, cursorHeight);
-        } else if (themeCursors[cursorName]->requestedHeight != cursorHeight) {
-            delete themeCursors.take(cursorName);
-            themeCursors[cursorName] = new XCursorImage(themeName, cursorName, cursorHeight);
+    QHash<QString, CursorImage*> loaded;
+    QList<QPair<QString, const CursorImage*> > cursors;
+    Q_FOREACH(const QString &cursorName, cursorNames) {
+        if (!cursorName.startsWith(QLatin1String("custom"))) {
+            cursors << qMakePair(cursorName, (const CursorImage*) loadCursor(themeName, cursorName, cursorHeight, loaded));
         }
+    }
+
+    CursorAtlas *atlas = new CursorAtlas(themeName, cursorHeight, generation, cursors);
+    qDeleteAll(loaded);
+    return atlas;
+}
+
+void CursorImageProvider::loadAtlasAsync(const QString &themeName, const QStringList &cursorNames, int cursorHeight)
+{
+    // m_atlasMutex is locked
+    m_loadingAtlases.insert(atlasKey(themeName, cursorHeight));
+    const int generation = ++m_atlasGeneration;
+
+    auto watcher = new QFutureWatcher<CursorAtlas*>(this);
+    m_pendingLoads.insert(watcher);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] {
+        m_pendingLoads.remove(watcher);
+        watcher->deleteLater();
+
+        CursorAtlas *atlas = watcher->result();
+        const QString themeName = atlas->themeName();
+        const int cursorHeight = atlas->cursorHeight();
+        {
+            QMutexLocker locker(&m_atlasMutex);
+            m_loadingAtlases.remove(atlasKey(themeName, cursorHeight));
+            insertAtlas(atlas);
+        }
+        Q_EMIT atlasReady(themeName, cursorHeight);
+    });
+
+    watcher->setFuture(QtConcurrent::run(&m_loaderPool, [=] {
+        return loadAtlas(themeName, cursorNames, cursorHeight, generation);
+    }));
+}
+
+QImage CursorImageProvider::atlasImage(const QString &themeName, const QString &cursorName, int cursorHeight,
+                                      CursorAtlas::Cursor *cursor)
+{
+    QMutexLocker locker(&m_atlasMutex);
+
+    const CursorAtlas *atlas = m_atlases.value(atlasKey(themeName, cursorHeight));
+    if (atlas && atlas->contains(cursorName)) {
+        *cursor = atlas->cursor(cursorName);
+        return atlas->image();
+    }
+
+    QStringList cursorNames = atlasCursorNamesFor(atlasKey(themeName, cursorHeight));
+    cursorNames << cursorName;
+    const int generation = ++m_atlasGeneration;
+
+    locker.unlock();
+    CursorAtlas *loaded = loadAtlas(themeName, cursorNames, cursorHeight, generation);
+    *cursor = loaded->cursor(cursorName);
+    const QImage image = loaded->image();
+    locker.relock();
+
+    insertAtlas(loaded);
+    return image;
+}
+
+QImage CursorImageProvider::atlasImage(const QString &themeName, int cursorHeight)
+{
+    const QString key = atlasKey(themeName, cursorHeight);
+    QMutexLocker locker(&m_atlasMutex);
+
+    const CursorAtlas *atlas = m_atlases.value(key);
+    if (atlas) {
+        return atlas->image();
+    }
+
+    // Evicted while a cursor still shows it. Building it out of the same
+    // names gives the same layout, and keeping its generation its source,
+    // so the frames the cursor has are still right.
+    const bool restored = m_evictedAtlases.contains(key);
+    const EvictedAtlas evicted = restored ? m_evictedAtlases.value(key)
+                                          : EvictedAtlas{QStringList(), ++m_atlasGeneration};
+
+    locker.unlock();
+    CursorAtlas *loaded = loadAtlas(themeName, evicted.cursorNames, cursorHeight, evicted.generation);
+    const QImage image = loaded->image();
+    locker.relock();
+
+    insertAtlas(loaded);
+    locker.unlock();
+
+    if (!restored) {
+        // Nothing showed this one before, let them fetch their cursors again
+        Q_EMIT atlasReady(themeName, cursorHeight);
+    }
+    return image;
+}
 
-        return themeCursors[cursorName];
+QStringList CursorImageProvider::atlasCursorNamesFor(const QString &key) const
+{
+    // m_atlasMutex is locked
+    const CursorAtlas *atlas = m_atlases.value(key);
+    return atlas ? atlas->cursorNames() : m_evictedAtlases.value(key).cursorNames;
+}
+
+void CursorImageProvider::insertAtlas(CursorAtlas *atlas)
+{
+    // m_atlasMutex is locked, atlas is ours to keep or delete
+    const QString key = atlasKey(atlas->themeName(), atlas->cursorHeight());
+
+    CursorAtlas *previous = m_atlases.value(key);
+    if (previous && previous->generation() > atlas->generation()) {
+        // A newer one made it first
+        delete atlas;
+        return;
+    }
+    delete previous;
+    m_atlases.insert(key, atlas);
+    m_evictedAtlases.remove(key);
+    m_atlasesByUse.removeOne(key);
+    m_atlasesByUse.append(key);
+
+    qint64 byteCount = 0;
+    Q_FOREACH(const CursorAtlas *cached, m_atlases) {
+        byteCount += cached->byteCount();
+    }
+    // Keep at least the one we just made
+    while (byteCount > kMaxAtlasBytes && m_atlasesByUse.count() > 1) {
+        const QString evictedKey = m_atlasesByUse.takeFirst();
+        CursorAtlas *evicted = m_atlases.take(evictedKey);
+        byteCount -= evicted->byteCount();
+        m_evictedAtlases.insert(evictedKey, EvictedAtlas{evicted->cursorNames(), evicted->generation()});
+        delete evicted;
     }
 }
 
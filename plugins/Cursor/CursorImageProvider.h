@@ -17,8 +17,15 @@
 #ifndef CURSORIMAGEPROVIDER_H
 #define CURSORIMAGEPROVIDER_H
 
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QObject>
 #include <QQuickImageProvider>
 #include <QScopedPointer>
+#include <QSet>
+#include <QThreadPool>
+
+#include "CursorAtlas.h"
 
 // xcursor static lib
 extern "C"
@@ -68,8 +75,15 @@ public:
     CustomCursorImage(const QCursor &cursor);
 };
 
-class CursorImageProvider : public QQuickImageProvider
+/*
+ * Cursors come out of a CursorAtlas per theme and height. Atlases are built
+ * on a worker thread, fetchCursor() reports when one isn't ready yet and
+ * atlasReady() is emitted once it is. The least recently used atlases are
+ * dropped once they take more than a few MB.
+ */
+class CursorImageProvider : public QObject, public QQuickImageProvider
 {
+    Q_OBJECT
 public:
     CursorImageProvider();
     virtual ~CursorImageProvider();
@@ -79,25 +93,58 @@ public:
 
     QImage requestImage(const QString &cursorThemeAndNameAndHeight, QSize *size, const QSize &requestedSize) override;
 
-    CursorImage *fetchCursor(const QString &themeName, const QString &cursorName, int cursorHeight);
+    // Fills in the cursor and the image it is in. Returns false, after
+    // starting to load it, if the theme isn't ready at that height.
+    bool fetchCursor(const QString &themeName, const QString &cursorName, int cursorHeight,
+                     CursorAtlas::Cursor *cursor, QUrl *imageSource);
 
     void setCustomCursor(const QCursor &customCursor);
 
-private:
-    CursorImage *fetchCursor(const QString &cursorThemeAndNameAndHeight);
-    CursorImage *fetchCursorHelper(const QString &themeName, const QString &cursorName, int cursorHeight);
+Q_SIGNALS:
+    void atlasReady(const QString &themeName, int cursorHeight);
 
-    // themeName -> (cursorName -> cursorImage)
-    // TODO: discard old, unused, cursors
-    QMap<QString, QMap<QString, CursorImage*> > m_cursors;
+private:
+    CursorImage *loadCursor(const QString &themeName, const QString &cursorName, int cursorHeight,
+                            QHash<QString, CursorImage*> &loaded) const;
+    CursorAtlas *loadAtlas(const QString &themeName, QStringList cursorNames, int cursorHeight, int generation) const;
+    void loadAtlasAsync(const QString &themeName, const QStringList &cursorNames, int cursorHeight);
+    QImage atlasImage(const QString &themeName, const QString &cursorName, int cursorHeight,
+                      CursorAtlas::Cursor *cursor);
+    QImage atlasImage(const QString &themeName, int cursorHeight);
+    void insertAtlas(CursorAtlas *atlas);
+    QStringList atlasCursorNamesFor(const QString &key) const;
+
+    static QString atlasKey(const QString &themeName, int cursorHeight);
 
-    QScopedPointer<CursorImage> m_builtInCursorImage;
-    BlankCursorImage m_blankCursorImage;
     QScopedPointer<CursorImage> m_customCursorImage;
 
+    // Only read once constructed, so safe to use from the loader thread
     QMap<QString, QStringList> m_fallbackNames;
 
+    // Guards the atlas members, requestImage() can be called from the
+    // pixmap reader thread
+    QMutex m_atlasMutex;
+    // "themeName/cursorHeight" -> atlas
+    QMap<QString, CursorAtlas*> m_atlases;
+    // Least recently used first
+    QStringList m_atlasesByUse;
+    QSet<QString> m_loadingAtlases;
+    int m_atlasGeneration{0};
+
+    // What evicted atlases were built from, so one that is still shown
+    // can be rebuilt with the same layout and source
+    struct EvictedAtlas {
+        QStringList cursorNames;
+        int generation;
+    };
+    QMap<QString, EvictedAtlas> m_evictedAtlases;
+
+    QThreadPool m_loaderPool;
+    QSet<QFutureWatcher<CursorAtlas*>*> m_pendingLoads;
+
     static CursorImageProvider *m_instance;
+
+    friend class CursorImageProviderTest;
 };
 
 #endif // CURSORIMAGEPROVIDER_H
@@ -16,8 +16,13 @@
 
 #include "abstractdashview.h"
 
+#include <private/qquickimagebase_p.h>
 #include <private/qquickitem_p.h>
 
+#include <QNetworkAccessManager>
+#include <QQmlEngine>
+#include <QTimer>
+
 AbstractDashView::AbstractDashView()
  : m_delegateModel(nullptr)
  , m_asyncRequestedIndex(-1)
@@ -29,11 +34,22 @@ AbstractDashView::AbstractDashView()
  , m_needsRelayout(false)
  , m_delegateValidated(false)
  , m_implicitHeightDirty(false)
+ , m_incubationBudget(0)
+ , m_pendingItems(0)
+ , m_creationPostponed(false)
 {
     connect(this, &AbstractDashView::widthChanged, this, &AbstractDashView::relayout);
     connect(this, &AbstractDashView::heightChanged, this, &AbstractDashView::onHeightChanged);
 }
 
+AbstractDashView::~AbstractDashView()
+{
+    // The priorities are process wide and counted, they outlive the view
+    Q_FOREACH(const QVector<QUrl> &urls, m_shownItems) {
+        setUrlsVisible(urls, false);
+    }
+}
+
 QAbstractItemModel *AbstractDashView::model() const
 {
     return m_delegateModel ? m_delegateModel->model().value<QAbstractItemModel *>() : nullptr;
@@ -166,6 +182,40 @@ void AbstractDashView::setDisplayMarginEnd(qreal end)
     emit displayMarginEndChanged();
 }
 
+int AbstractDashView::incubationBudget() const
+{
+    return m_incubationBudget;
+}
+
+void AbstractDashView::setIncubationBudget(int budget)
+{
+    if (budget < 0) {
+        qmlInfo(this) << "Cannot set a negative incubation budget";
+        return;
+    }
+
+    if (m_incubationBudget != budget) {
+        m_incubationBudget = budget;
+        if (isComponentComplete()) {
+            polish();
+        }
+        Q_EMIT incubationBudgetChanged();
+    }
+}
+
+int AbstractDashView::pendingItems() const
+{
+    return m_pendingItems;
+}
+
+void AbstractDashView::setPendingItems(int pendingItems)
+{
+    if (m_pendingItems != pendingItems) {
+        m_pendingItems = pendingItems;
+        Q_EMIT pendingItemsChanged();
+    }
+}
+
 void AbstractDashView::createDelegateModel()
 {
     m_delegateModel = new QQmlDelegateModel(qmlContext(this), this);
@@ -185,13 +235,26 @@ void AbstractDashView::refill()
     const qreal bufferFrom = from - m_buffer;
     const qreal bufferTo = to + m_buffer;
 
+    m_creationPostponed = false;
     bool added = addVisibleItems(from, to, false);
     bool removed = removeNonVisibleItems(bufferFrom, bufferTo);
-    added |= addVisibleItems(bufferFrom, bufferTo, true);
+
+    // Only start with the buffer once all the visible items are there
+    if (!m_creationPostponed) {
+        added |= addVisibleItems(bufferFrom, bufferTo, true);
+        setPendingItems(0);
+    } else {
+        setPendingItems(qMax(1, estimatePendingItems(from, to)));
+        // Calling polish() from here would make the window call updatePolish again
+        // before rendering, so wait until we get back to the event loop
+        QTimer::singleShot(0, this, &AbstractDashView::polish);
+    }
 
     if (added || removed) {
         m_implicitHeightDirty = true;
-        polish();
+        if (!m_creationPostponed) {
+            polish();
+        }
     }
 }
 
@@ -211,6 +274,11 @@ bool AbstractDashView::addVisibleItems(qreal fillFromY, qreal fillToY, bool asyn
     findBottomModelIndexToAdd(&modelIndex, &yPos);
     bool changed = false;
     while (modelIndex < m_delegateModel->count() && yPos <= fillToY) {
+        if (!asynchronous && changed && incubationBudgetExhausted()) {
+            m_creationPostponed = true;
+            return changed;
+        }
+
         if (!createItem(modelIndex, asynchronous))
             break;
 
@@ -220,6 +288,11 @@ bool AbstractDashView::addVisibleItems(qreal fillFromY, qreal fillToY, bool asyn
 
     findTopModelIndexToAdd(&modelIndex, &yPos);
     while (modelIndex >= 0 && yPos > fillFromY) {
+        if (!asynchronous && changed && incubationBudgetExhausted()) {
+            m_creationPostponed = true;
+            return changed;
+        }
+
         if (!createItem(modelIndex, asynchronous))
             break;
 
@@ -230,6 +303,39 @@ bool AbstractDashView::addVisibleItems(qreal fillFromY, qreal fillToY, bool asyn
     return changed;
 }
 
+bool AbstractDashView::incubationBudgetExhausted() const
+{
+    return m_incubationBudget > 0 && m_polishTimer.isValid() && m_polishTimer.elapsed() >= m_incubationBudget;
+}
+
+int AbstractDashView::estimatePendingItems(qreal fillFromY, qreal fillToY)
+{
+    if (!delegate() || m_delegateModel->count() == 0)
+        return 0;
+
+    // We don't know the size of the items we have not created yet
+    // so use the average size of the ones we know about, several
+    // items share the same height when there are several columns
+    const int count = m_delegateModel->count();
+    const qreal averageHeight = averageHeightPerItem();
+    const qreal itemHeight = averageHeight > 0 ? averageHeight : height();
+
+    int pending = 0;
+    int modelIndex;
+    qreal yPos;
+    findBottomModelIndexToAdd(&modelIndex, &yPos);
+    if (modelIndex < count && yPos <= fillToY) {
+        const int fitting = itemHeight > 0 ? (fillToY - yPos) / itemHeight : count;
+        pending += qMin(count - modelIndex, 1 + fitting);
+    }
+    findTopModelIndexToAdd(&modelIndex, &yPos);
+    if (modelIndex >= 0 && yPos > fillFromY) {
+        const int fitting = itemHeight > 0 ? (yPos - fillFromY) / itemHeight : count;
+        pending += qMin(modelIndex + 1, 1 + fitting);
+    }
+    return pending;
+}
+
 QQuickItem *AbstractDashView::createItem(int modelIndex, bool asynchronous)
 {
     if (asynchronous && m_asyncRequestedIndex != -1)
@@ -259,6 +365,9 @@ QQuickItem *AbstractDashView::createItem(int modelIndex, bool asynchronous)
 
 void AbstractDashView::releaseItem(QQuickItem *item)
 {
+    if (m_shownItems.contains(item)) {
+        setUrlsVisible(m_shownItems.take(item), false);
+    }
     QQuickItemPrivate::get(item)->removeItemChangeListener(this, QQuickItemPrivate::Geometry);
     QQmlDelegateModel::ReleaseFlags flags = m_delegateModel->release(item);
     if (flags & QQmlDelegateModel::Destroyed) {
@@ -271,6 +380,40 @@ void AbstractDashView::setImplicitHeightDirty()
     m_implicitHeightDirty = true;
 }
 
+void AbstractDashView::setItemCulled(QQuickItem *item, bool culled)
+{
+    QQuickItemPrivate::get(item)->setCulled(culled);
+
+    if (!culled && !m_shownItems.contains(item)) {
+        QVector<QUrl> urls;
+        Q_FOREACH(QQuickImageBase *image, item->findChildren<QQuickImageBase*>()) {
+            const QUrl source = image->source();
+            if (source.scheme() == QLatin1String("http") || source.scheme() == QLatin1String("https")) {
+                urls << source;
+            }
+        }
+        m_shownItems.insert(item, urls);
+        setUrlsVisible(urls, true);
+    } else if (culled && m_shownItems.contains(item)) {
+        setUrlsVisible(m_shownItems.take(item), false);
+    }
+}
+
+void AbstractDashView::setUrlsVisible(const QVector<QUrl> &urls, bool visible)
+{
+    // The shell's QueuedNetworkAccessManager serves the urls of visible images first,
+    // other managers don't have setUrlVisible and are left alone. It counts the
+    // calls, a url other views show too stays visible until they hide it as well.
+    QQmlEngine *engine = qmlEngine(this);
+    QNetworkAccessManager *manager = engine ? engine->networkAccessManager() : nullptr;
+    if (!manager || manager->metaObject()->indexOfMethod("setUrlVisible(QUrl,bool)") == -1)
+        return;
+
+    Q_FOREACH(const QUrl &url, urls) {
+        QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, url), Q_ARG(bool, visible));
+    }
+}
+
 void AbstractDashView::itemCreated(int modelIndex, QObject *object)
 {
     QQuickItem *item = qmlobject_cast<QQuickItem*>(object);
@@ -328,6 +471,8 @@ void AbstractDashView::updatePolish()
     if (!model())
         return;
 
+    m_polishTimer.start();
+
     if (m_needsRelayout) {
         doRelayout();
         m_needsRelayout = false;
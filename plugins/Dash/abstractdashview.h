@@ -17,6 +17,10 @@
 #ifndef ABSTRACTDASHVIEW_H
 #define ABSTRACTDASHVIEW_H
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QUrl>
+#include <QVector>
 #include <QQuickItem>
 
 class QAbstractItemModel;
@@ -41,6 +45,8 @@ class AbstractDashView : public QQuickItem, public QQuickItemChangeListener
     Q_PROPERTY(qreal displayMarginEnd READ displayMarginEnd
                                       WRITE setDisplayMarginEnd
                                       NOTIFY displayMarginEndChanged)
+    Q_PROPERTY(int incubationBudget READ incubationBudget WRITE setIncubationBudget NOTIFY incubationBudgetChanged)
+    Q_PROPERTY(int pendingItems READ pendingItems NOTIFY pendingItemsChanged)
 
 friend class VerticalJournalTest;
 friend class HorizontalJournalTest;
@@ -48,6 +54,7 @@ friend class OrganicGridTest;
 
 public:
     AbstractDashView();
+    ~AbstractDashView();
 
     QAbstractItemModel *model() const;
     void setModel(QAbstractItemModel *model);
@@ -70,6 +77,13 @@ public:
     qreal displayMarginEnd() const;
     void setDisplayMarginEnd(qreal);
 
+    // Milliseconds per polish that can be spent creating delegates, 0 means no limit
+    int incubationBudget() const;
+    void setIncubationBudget(int);
+
+    // Estimation of how many items of the visible area are still to be created
+    int pendingItems() const;
+
 Q_SIGNALS:
     void modelChanged();
     void delegateChanged();
@@ -78,6 +92,8 @@ Q_SIGNALS:
     void cacheBufferChanged();
     void displayMarginBeginningChanged();
     void displayMarginEndChanged();
+    void incubationBudgetChanged();
+    void pendingItemsChanged();
 
 protected Q_SLOTS:
     void relayout();
@@ -88,6 +104,8 @@ protected:
 
     void releaseItem(QQuickItem *item);
     void setImplicitHeightDirty();
+    // Culls the item and moves the network requests of its images ahead while it's shown
+    void setItemCulled(QQuickItem *item, bool culled);
 
 private Q_SLOTS:
     void itemCreated(int modelIndex, QObject *object);
@@ -99,6 +117,10 @@ private:
     void refill();
     bool addVisibleItems(qreal fillFromY, qreal fillToY, bool asynchronous);
     QQuickItem *createItem(int modelIndex, bool asynchronous);
+    bool incubationBudgetExhausted() const;
+    int estimatePendingItems(qreal fillFromY, qreal fillToY);
+    void setPendingItems(int pendingItems);
+    void setUrlsVisible(const QVector<QUrl> &urls, bool visible);
 
     virtual void findBottomModelIndexToAdd(int *modelIndex, qreal *yPos) = 0;
     virtual void findTopModelIndexToAdd(int *modelIndex, qreal *yPos) = 0;
@@ -108,6 +130,9 @@ private:
     virtual void doRelayout() = 0;
     virtual void updateItemCulling(qreal visibleFromY, qreal visibleToY) = 0;
     virtual void calculateImplicitHeight() = 0;
+    // Vertical space taken by each item, i.e. the height of a row divided by the items in it,
+    // from the items laid out so far. 0 if it's not known yet
+    virtual qreal averageHeightPerItem() const = 0;
     virtual void processModelRemoves(const QVector<QQmlChangeSet::Change> &removes) = 0;
 
     QQmlDelegateModel *m_delegateModel;
@@ -115,6 +140,11 @@ private:
     // Index we are waiting because we requested it asynchronously
     int m_asyncRequestedIndex;
 
+    // Items whose images have their requests moved ahead, with the urls
+    // that were moved, which are the ones to give back even if the images
+    // show others by now
+    QHash<QQuickItem*, QVector<QUrl>> m_shownItems;
+
     int m_columnSpacing;
     int m_rowSpacing;
     int m_buffer;
@@ -123,6 +153,13 @@ private:
     bool m_needsRelayout;
     bool m_delegateValidated;
     bool m_implicitHeightDirty;
+
+    int m_incubationBudget;
+    int m_pendingItems;
+    // Set when addVisibleItems stopped because the budget was used
+    bool m_creationPostponed;
+    // Started at each updatePolish, tells how much of m_incubationBudget we have used
+    QElapsedTimer m_polishTimer;
 };
 
 #endif
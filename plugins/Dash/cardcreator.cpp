@@ -0,0 +1,1190 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cardcreator.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQmlEngine>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QtMath>
+
+#include <utime.h>
+
+
+static const char kImportsCode[] =
+    "import QtQuick 2.4;\n"
+    "import Ubuntu.Components 1.3;\n"
+    "import Ubuntu.Settings.Components 0.1;\n"
+    "import Dash 0.1;\n"
+    "import Utils 0.1;\n";
+
+// %1 is whether the card is interactive or not
+static const char kCardCode[] =
+    "AbstractButton {\n"
+    "    id: root;\n"
+    "    property var cardData;\n"
+    "    property string backgroundShapeStyle: \"flat\";\n"
+    "    property real fontScale: 1.0;\n"
+    "    property var scopeStyle: null;\n"
+    "    readonly property string title: cardData && cardData[\"title\"] || \"\";\n"
+    "    property bool showHeader: true;\n"
+    "    implicitWidth: childrenRect.width;\n"
+    "    enabled: %1;\n"
+    "\n";
+
+// %1 is the template["card-background"]["elements"][0]
+// %2 is the template["card-background"]["elements"][1]
+// %3 is whether the loader should be asynchronous or not
+// %4 is the template["card-background"] string
+static const char kBackgroundLoaderCode[] =
+    "Loader {\n"
+    "    id: backgroundLoader;\n"
+    "    objectName: \"backgroundLoader\";\n"
+    "    anchors.fill: parent;\n"
+    "    asynchronous: %3;\n"
+    "    visible: status === Loader.Ready;\n"
+    "    sourceComponent: UbuntuShape {\n"
+    "        objectName: \"background\";\n"
+    "        radius: \"small\";\n"
+    "        aspect: {\n"
+    "            switch (root.backgroundShapeStyle) {\n"
+    "                case \"inset\": return UbuntuShape.Inset;\n"
+    "                case \"shadow\": return UbuntuShape.DropShadow;\n"
+    "                default:\n"
+    "                case \"flat\": return UbuntuShape.Flat;\n"
+    "            }\n"
+    "        }\n"
+    "        backgroundColor: getColor(0) || \"white\";\n"
+    "        secondaryBackgroundColor: getColor(1) || backgroundColor;\n"
+    "        backgroundMode: UbuntuShape.VerticalGradient;\n"
+    "        anchors.fill: parent;\n"
+    "        source: backgroundImage.source ? backgroundImage : null;\n"
+    "        property real luminance: Style.luminance(backgroundColor);\n"
+    "        property Image backgroundImage: Image {\n"
+    "            objectName: \"backgroundImage\";\n"
+    "            source: {\n"
+    "                if (cardData && typeof cardData[\"background\"] === \"string\") return cardData[\"background\"];\n"
+    "                else return %4;\n"
+    "            }\n"
+    "        }\n"
+    "        function getColor(index) {\n"
+    "            if (cardData && typeof cardData[\"background\"] === \"object\"\n"
+    "            && (cardData[\"background\"][\"type\"] === \"color\" || cardData[\"background\"][\"type\"] === \"gradient\")) {\n"
+    "                return cardData[\"background\"][\"elements\"][index];\n"
+    "            } else return index === 0 ? %1 : %2;\n"
+    "        }\n"
+    "    }\n"
+    "}\n";
+
+// %1 is the aspect of the UbuntuShape
+static const char kArtUbuntuShapeCode[] =
+    "UbuntuShape {\n"
+    "    anchors.fill: parent;\n"
+    "    source: artImage;\n"
+    "    sourceFillMode: UbuntuShape.PreserveAspectCrop;\n"
+    "    radius: \"small\";\n"
+    "    aspect: %1;\n"
+    "}";
+
+static const char kArtProportionalShapeCode[] =
+    "ProportionalShape {\n"
+    "    anchors.left: parent.left;\n"
+    "    anchors.right: parent.right;\n"
+    "    source: artImage;\n"
+    "    aspect: UbuntuShape.DropShadow;\n"
+    "}";
+
+// %1 is used as anchors of artShapeLoader
+// %2 is used as image width
+// %3 is used as image height
+// %4 is whether the image should be visible
+// %5 is whether the loader should be asynchronous or not
+// %6 is the shape code we want to use
+// %7 is injected as code to artImage
+// %8 is used as image fallback
+static const char kArtShapeHolderCode[] =
+    "Loader {\n"
+    "    id: artShapeLoader;\n"
+    "    height: root.fixedArtShapeSize.height;\n"
+    "    width: root.fixedArtShapeSize.width;\n"
+    "    anchors { %1 }\n"
+    "    objectName: \"artShapeLoader\";\n"
+    "    readonly property string cardArt: cardData && cardData[\"art\"] || %8;\n"
+    "    onCardArtChanged: { if (item) { item.image.source = cardArt; } }\n"
+    "    active: cardArt != \"\";\n"
+    "    asynchronous: %5;\n"
+    "    visible: status === Loader.Ready;\n"
+    "    sourceComponent: Item {\n"
+    "        id: artShape;\n"
+    "        objectName: \"artShape\";\n"
+    "        visible: image.status === Image.Ready;\n"
+    "        readonly property alias image: artImage;\n"
+    "        %6\n"
+    "        width: root.fixedArtShapeSize.width;\n"
+    "        height: root.fixedArtShapeSize.height;\n"
+    "        CroppedImageMinimumSourceSize {\n"
+    "            id: artImage;\n"
+    "            objectName: \"artImage\";\n"
+    "            source: artShapeLoader.cardArt;\n"
+    "            asynchronous: %5;\n"
+    "            visible: %4;\n"
+    "            width: %2;\n"
+    "            height: %3;\n"
+    "            %7\n"
+    "        }\n"
+    "    }\n"
+    "}\n";
+
+// %1 is used as anchors of artShapeLoader
+// %2 is used as image width
+// %3 is used as image height
+// %4 is whether the image should be visible
+// %5 is whether the loader should be asynchronous or not
+// %6 is the shape code we want to use
+// %7 is injected as code to artImage
+// %8 is used as image fallback
+static const char kArtShapeHolderCodeCardToolCard[] =
+    "Loader {\n"
+    "    id: artShapeLoader;\n"
+    "    anchors { %1 }\n"
+    "    objectName: \"artShapeLoader\";\n"
+    "    readonly property string cardArt: cardData && cardData[\"art\"] || %8;\n"
+    "    onCardArtChanged: { if (item) { item.image.source = cardArt; } }\n"
+    "    active: cardArt != \"\";\n"
+    "    asynchronous: %5;\n"
+    "    visible: status === Loader.Ready;\n"
+    "    sourceComponent: Item {\n"
+    "        id: artShape;\n"
+    "        objectName: \"artShape\";\n"
+    "        visible: image.status === Image.Ready;\n"
+    "        readonly property alias image: artImage;\n"
+    "        %6\n"
+    "        width: image.status !== Image.Ready ? 0 : image.width;\n"
+    "        height: image.status !== Image.Ready ? 0 : image.height;\n"
+    "        CroppedImageMinimumSourceSize {\n"
+    "            id: artImage;\n"
+    "            objectName: \"artImage\";\n"
+    "            source: artShapeLoader.cardArt;\n"
+    "            asynchronous: %5;\n"
+    "            visible: %4;\n"
+    "            width: %2;\n"
+    "            height: %3;\n"
+    "            %7\n"
+    "        }\n"
+    "    }\n"
+    "}\n";
+
+// %1 is anchors.fill
+// %2 is width
+// %3 is height
+// %4 is whether the icon should be asynchronous or not
+static const char kAudioButtonCode[] =
+    "AbstractButton {\n"
+    "    id: audioButton;\n"
+    "    anchors.fill: %1;\n"
+    "    width: %2;\n"
+    "    height: %3;\n"
+    "    readonly property url source: (cardData[\"quickPreviewData\"] && cardData[\"quickPreviewData\"][\"uri\"]) || \"\";\n"
+    "    UbuntuShape {\n"
+    "        anchors.fill: parent;\n"
+    "        visible: parent.pressed;\n"
+    "        radius: \"small\";\n"
+    "    }\n"
+    "    Rectangle {\n"
+    "        color: Qt.rgba(0, 0, 0, 0.5);\n"
+    "        anchors.centerIn: parent;\n"
+    "        width: parent.width * 0.5;\n"
+    "        height: width;\n"
+    "        radius: width / 2;\n"
+    "    }\n"
+    "    Icon {\n"
+    "        anchors.centerIn: parent;\n"
+    "        width: parent.width * 0.3;\n"
+    "        height: width;\n"
+    "        opacity: 0.9;\n"
+    "        name: DashAudioPlayer.playing && AudioUrlComparer.compare(parent.source, DashAudioPlayer.currentSource) ? \"media-playback-pause\" : \"media-playback-start\";\n"
+    "        color: \"white\";\n"
+    "        asynchronous: %4;\n"
+    "    }\n"
+    "    onClicked: {\n"
+    "        if (AudioUrlComparer.compare(source, DashAudioPlayer.currentSource)) {\n"
+    "            if (DashAudioPlayer.playing) {\n"
+    "                DashAudioPlayer.pause();\n"
+    "            } else {\n"
+    "                DashAudioPlayer.play();\n"
+    "            }\n"
+    "        } else {\n"
+    "            var playlist = (cardData[\"quickPreviewData\"] && cardData[\"quickPreviewData\"][\"playlist\"]) || null;\n"
+    "            DashAudioPlayer.playSource(source, playlist);\n"
+    "        }\n"
+    "    }\n"
+    "    onPressAndHold: {\n"
+    "        root.pressAndHold();\n"
+    "    }\n"
+    "}";
+
+// %1 is whether the loader should be asynchronous or not
+// %2 is the header height code
+static const char kOverlayLoaderCode[] =
+    "Loader {\n"
+    "    id: overlayLoader;\n"
+    "    readonly property real overlayHeight: %2 + units.gu(2);\n"
+    "    anchors.fill: artShapeLoader;\n"
+    "    active: artShapeLoader.active && artShapeLoader.item && artShapeLoader.item.image.status === Image.Ready || false;\n"
+    "    asynchronous: %1;\n"
+    "    visible: showHeader && status === Loader.Ready;\n"
+    "    sourceComponent: UbuntuShapeOverlay {\n"
+    "        id: overlay;\n"
+    "        property real luminance: Style.luminance(overlayColor);\n"
+    "        aspect: UbuntuShape.Flat;\n"
+    "        radius: \"small\";\n"
+    "        overlayColor: cardData && cardData[\"overlayColor\"] || \"#99000000\";\n"
+    "        overlayRect: Qt.rect(0, 1 - overlayLoader.overlayHeight / height, 1, 1);\n"
+    "    }\n"
+    "}\n";
+
+// %1 is used as anchors of row
+// %2 is used as height code of row
+// %3 is the comma separated row elements
+static const char kHeaderRowCode[] =
+    "Row {\n"
+    "    id: row;\n"
+    "    objectName: \"outerRow\";\n"
+    "    property real margins: units.gu(1);\n"
+    "    spacing: margins;\n"
+    "    %2anchors { %1 }\n"
+    "    anchors.right: parent.right;\n"
+    "    anchors.margins: margins;\n"
+    "    anchors.rightMargin: 0;\n"
+    "    data: [\n"
+    "        %3\n"
+    "    ]\n"
+    "}\n";
+
+// %1 is used as anchors of mascotShapeLoader
+// %2 is whether the loader should be asynchronous or not
+static const char kMascotShapeLoaderCode[] =
+    "Loader {\n"
+    "    id: mascotShapeLoader;\n"
+    "    objectName: \"mascotShapeLoader\";\n"
+    "    asynchronous: %2;\n"
+    "    active: mascotImage.status === Image.Ready;\n"
+    "    visible: showHeader && active && status === Loader.Ready;\n"
+    "    width: units.gu(6);\n"
+    "    height: units.gu(5.625);\n"
+    "    sourceComponent: UbuntuShape { aspect: UbuntuShape.Flat; image: mascotImage }\n"
+    "    anchors { %1 }\n"
+    "}\n";
+
+// %1 is used as anchors of mascotImage
+// %2 is used as visible of mascotImage
+// %3 is injected as code to mascotImage
+// %4 is used as fallback image
+static const char kMascotImageCode[] =
+    "CroppedImageMinimumSourceSize {\n"
+    "    id: mascotImage;\n"
+    "    objectName: \"mascotImage\";\n"
+    "    anchors { %1 }\n"
+    "    source: cardData && cardData[\"mascot\"] || %4;\n"
+    "    width: units.gu(6);\n"
+    "    height: units.gu(5.625);\n"
+    "    horizontalAlignment: Image.AlignHCenter;\n"
+    "    verticalAlignment: Image.AlignVCenter;\n"
+    "    visible: %2;\n"
+    "    %3\n"
+    "}\n";
+
+// %1 is used as anchors of titleLabel
+// %2 is used as color of titleLabel
+// %3 is used as extra condition for visible of titleLabel
+// %4 is used as title width
+// %5 is used as horizontal alignment
+static const char kTitleLabelCode[] =
+    "Label {\n"
+    "    id: titleLabel;\n"
+    "    objectName: \"titleLabel\";\n"
+    "    anchors { %1 }\n"
+    "    elide: Text.ElideRight;\n"
+    "    fontSize: \"small\";\n"
+    "    wrapMode: Text.Wrap;\n"
+    "    maximumLineCount: 2;\n"
+    "    font.pixelSize: Math.round(FontUtils.sizeToPixels(fontSize) * fontScale);\n"
+    "    color: %2;\n"
+    "    visible: showHeader %3;\n"
+    "    width: %4;\n"
+    "    text: root.title;\n"
+    "    font.weight: Font.Normal;\n"
+    "    horizontalAlignment: %5;\n"
+    "}\n";
+
+// %1 is used as extra anchors of emblemIcon
+// %2 is used as color of emblemIcon
+// FIXME The width code is a
+// Workaround for bug https://bugs.launchpad.net/ubuntu/+source/ubuntu-ui-toolkit/+bug/1421293
+static const char kEmblemIconCode[] =
+    "Icon {\n"
+    "    id: emblemIcon;\n"
+    "    objectName: \"emblemIcon\";\n"
+    "    anchors {\n"
+    "        bottom: titleLabel.baseline;\n"
+    "        right: parent.right;\n"
+    "        %1\n"
+    "    }\n"
+    "    source: cardData && cardData[\"emblem\"] || \"\";\n"
+    "    color: %2;\n"
+    "    height: source != \"\" ? titleLabel.font.pixelSize : 0;\n"
+    "    width: implicitWidth > 0 && implicitHeight > 0 ? (implicitWidth / implicitHeight * height) : implicitWidth;\n"
+    "}\n";
+
+// %1 is used as anchors of touchdown effect
+static const char kTouchdownCode[] =
+    "Loader {\n"
+    "    active: root.pressed;\n"
+    "    anchors { %1 }\n"
+    "    sourceComponent: UbuntuShape {\n"
+    "        objectName: \"touchdown\";\n"
+    "        anchors.fill: parent;\n"
+    "        radius: \"small\";\n"
+    "        borderSource: \"radius_pressed.sci\"\n"
+    "    }\n"
+    "}\n";
+
+// %1 is used as anchors of subtitleLabel
+// %2 is used as color of subtitleLabel
+static const char kSubtitleLabelCode[] =
+    "Label {\n"
+    "    id: subtitleLabel;\n"
+    "    objectName: \"subtitleLabel\";\n"
+    "    anchors { %1 }\n"
+    "    anchors.topMargin: units.dp(2);\n"
+    "    elide: Text.ElideRight;\n"
+    "    maximumLineCount: 1;\n"
+    "    fontSize: \"x-small\";\n"
+    "    font.pixelSize: Math.round(FontUtils.sizeToPixels(fontSize) * fontScale);\n"
+    "    color: %2;\n"
+    "    visible: titleLabel.visible && titleLabel.text;\n"
+    "    text: cardData && cardData[\"subtitle\"] || \"\";\n"
+    "    font.weight: Font.Light;\n"
+    "}\n";
+
+// %1 is used as anchors of attributesRow
+// %2 is used as color of attributesRow
+static const char kAttributesRowCode[] =
+    "CardAttributes {\n"
+    "    id: attributesRow;\n"
+    "    objectName: \"attributesRow\";\n"
+    "    anchors { %1 }\n"
+    "    color: %2;\n"
+    "    fontScale: root.fontScale;\n"
+    "    model: cardData && cardData[\"attributes\"];\n"
+    "}\n";
+
+// %1 is used as anchors of socialActionsRow
+// %2 is used as color of socialActionsRow
+static const char kSocialActionsRowCode[] =
+    "CardSocialActions {\n"
+    "    id: socialActionsRow;\n"
+    "    objectName: \"socialActionsRow\";\n"
+    "    anchors { %1 }\n"
+    "    color: %2;\n"
+    "    model: cardData && cardData[\"socialActions\"];\n"
+    "    onClicked: root.action(actionId);\n"
+    "}\n";
+
+// %1 is used as top anchor of summary
+// %2 is used as topMargin anchor of summary
+// %3 is used as color of summary
+static const char kSummaryLabelCode[] =
+    "Label {\n"
+    "    id: summary;\n"
+    "    objectName: \"summaryLabel\";\n"
+    "    anchors {\n"
+    "        top: %1;\n"
+    "        left: parent.left;\n"
+    "        right: parent.right;\n"
+    "        margins: units.gu(1);\n"
+    "        topMargin: %2;\n"
+    "    }\n"
+    "    wrapMode: Text.Wrap;\n"
+    "    maximumLineCount: 5;\n"
+    "    elide: Text.ElideRight;\n"
+    "    text: cardData && cardData[\"summary\"] || \"\";\n"
+    "    height: text ? implicitHeight : 0;\n"
+    "    fontSize: \"x-small\";\n"
+    "    font.weight: Font.Light;\n"
+    "    color: %3;\n"
+    "}\n";
+
+// %1 is used as bottom anchor of audio progress bar
+// %2 is used as left anchor of audio progress bar
+// %3 is used as text color
+static const char kAudioProgressBarCode[] =
+    "CardAudioProgress {\n"
+    "    id: audioProgressBar;\n"
+    "    duration: (cardData[\"quickPreviewData\"] && cardData[\"quickPreviewData\"][\"duration\"]) || 0;\n"
+    "    source: (cardData[\"quickPreviewData\"] && cardData[\"quickPreviewData\"][\"uri\"]) || \"\";\n"
+    "    anchors {\n"
+    "        bottom: %1;\n"
+    "        left: %2;\n"
+    "        right: parent.right;\n"
+    "        margins: units.gu(1);\n"
+    "    }\n"
+    "    color: %3;\n"
+    "}";
+// %1 is used as anchors of headerTitleContainer
+// %2 is used as implicitHeight of headerTitleContainer
+// %3 is the comma separated container elements
+static const char kHeaderContainerCode[] =
+    "Item {\n"
+    "    id: headerTitleContainer;\n"
+    "    anchors { %1 }\n"
+    "    width: parent.width - x;\n"
+    "    implicitHeight: %2;\n"
+    "    data: [\n"
+    "        %3\n"
+    "    ]\n"
+    "}\n";
+
+// The template and components come from JSON. These follow the JavaScript
+// semantics the card generation was written with
+
+static bool isTruthy(const QVariant &value)
+{
+    switch (static_cast<int>(value.type())) {
+        case QVariant::Invalid:
+        case QMetaType::Nullptr:
+            return false;
+        case QVariant::Bool:
+            return value.toBool();
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Double: {
+            const double number = value.toDouble();
+            return number != 0 && !qIsNaN(number);
+        }
+        case QVariant::String:
+            return !value.toString().isEmpty();
+        default:
+            return true;
+    }
+}
+
+static bool isObject(const QVariant &value)
+{
+    return value.type() == QVariant::Map;
+}
+
+static bool isString(const QVariant &value)
+{
+    return value.type() == QVariant::String;
+}
+
+static QVariant member(const QVariant &object, const QString &key)
+{
+    return isObject(object) ? object.toMap().value(key) : QVariant();
+}
+
+static bool isStringEqual(const QVariant &value, const QString &string)
+{
+    return isString(value) && value.toString() == string;
+}
+
+static QString encodeURI(const QString &uri)
+{
+    return QString::fromLatin1(QUrl::toPercentEncoding(uri, "#$&'()*+,/:;=?@!"));
+}
+
+// Shortest representation that reads back to the same number
+static QString numberToString(double number)
+{
+    for (int precision = 1; precision < 17; ++precision) {
+        const QString string = QString::number(number, 'g', precision);
+        if (string.toDouble() == number) {
+            return string;
+        }
+    }
+    return QString::number(number, 'g', 17);
+}
+
+static QString artShapeAspectCode(const QVariant &aspectRatio)
+{
+    if (!isTruthy(aspectRatio)) {
+        return QStringLiteral("1");
+    }
+    switch (static_cast<int>(aspectRatio.type())) {
+        case QVariant::Bool:
+            return QStringLiteral("true");
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Double:
+            return numberToString(aspectRatio.toDouble());
+        case QVariant::String: {
+            bool isNumber;
+            aspectRatio.toString().toDouble(&isNumber);
+            return isNumber ? aspectRatio.toString() : QStringLiteral("1");
+        }
+        default:
+            return QStringLiteral("1");
+    }
+}
+
+static QString sanitizeColor(const QString &color)
+{
+    // This is not the perfect regexp for color
+    // but what we're trying to do here is just protect
+    // against injection so it's ok
+    static const QRegularExpression colorRegExp(QStringLiteral("\\A[#a-z0-9]*\\z"), QRegularExpression::CaseInsensitiveOption);
+    return colorRegExp.match(color).hasMatch() ? color : QString();
+}
+
+static QString templateArg(const char *codeTemplate)
+{
+    return QString::fromLatin1(codeTemplate);
+}
+
+// Stable for equal inputs, QJsonObject sorts the keys
+static QString cardCacheKey(const QVariantMap &cardTemplate, const QVariantMap &components,
+                            bool isCardTool, const QString &artShapeStyle, const QString &categoryLayout)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QJsonDocument(QJsonObject::fromVariantMap(cardTemplate)).toJson(QJsonDocument::Compact));
+    hash.addData(QJsonDocument(QJsonObject::fromVariantMap(components)).toJson(QJsonDocument::Compact));
+    hash.addData(isCardTool ? "1\n" : "0\n", 2);
+    hash.addData(artShapeStyle.toUtf8() + '\n');
+    hash.addData(categoryLayout.toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+const int CardCreator::maxCachedCards;
+
+CardCreator::CardCreator(QQmlEngine *engine, QObject *parent)
+ : QObject(parent)
+ , m_engine(engine)
+{
+    // Named after the hash of this file, so cards generated by any other version of the
+    // code are thrown away. The compiled units the engine caches next to the files
+    // depend on the Qt version too
+    const QString cacheRoot = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/unity8/cards");
+    const QString cacheName = QStringLiteral("%1-qt%2").arg(QLatin1String(CARDCREATOR_SOURCE_HASH).left(12), QLatin1String(qVersion()));
+
+    QDir cacheRootDir(cacheRoot);
+    Q_FOREACH(const QString &entry, cacheRootDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        if (entry != cacheName) {
+            QDir(cacheRootDir.filePath(entry)).removeRecursively();
+        }
+    }
+
+    if (cacheRootDir.mkpath(cacheName)) {
+        m_cacheDir = cacheRootDir.filePath(cacheName);
+        removeUnusedCards();
+    } else {
+        qWarning() << "CardCreator: Could not create the cache directory" << cacheRootDir.filePath(cacheName);
+    }
+}
+
+QString CardCreator::cardString(const QVariantMap &cardTemplate, const QVariantMap &components,
+                                bool isCardTool, const QString &artShapeStyle,
+                                const QString &categoryLayout) const
+{
+    const QString templateInteractive = cardTemplate.contains(QStringLiteral("non-interactive"))
+                                        && isTruthy(cardTemplate.value(QStringLiteral("non-interactive"))) ? QStringLiteral("false") : QStringLiteral("true");
+
+    QString code = templateArg(kCardCode).arg(templateInteractive);
+
+    if (!isCardTool) {
+        code += QLatin1String("property int fixedHeaderHeight: -1;\n"
+                              "property size fixedArtShapeSize: Qt.size(-1, -1);\n");
+    }
+
+    const QVariant art = components.value(QStringLiteral("art"));
+    const QVariant cardBackground = cardTemplate.value(QStringLiteral("card-background"));
+    const bool hasArt = isTruthy(member(art, QStringLiteral("field")));
+    const bool hasSummary = isTruthy(components.value(QStringLiteral("summary")));
+    const bool isConciergeMode = isTruthy(member(art, QStringLiteral("conciergeMode")));
+    const bool artAndSummary = hasArt && hasSummary && !isConciergeMode;
+    const bool isHorizontal = isStringEqual(cardTemplate.value(QStringLiteral("card-layout")), QStringLiteral("horizontal"));
+    const bool hasCardBackground = isTruthy(cardBackground) || isTruthy(components.value(QStringLiteral("background")));
+    const bool hasBackground = (!isHorizontal && (hasCardBackground || artAndSummary)) || (hasSummary && hasCardBackground);
+    const bool hasTitle = isTruthy(components.value(QStringLiteral("title")));
+    const bool hasMascot = isTruthy(components.value(QStringLiteral("mascot")));
+    const bool hasEmblem = isTruthy(components.value(QStringLiteral("emblem")))
+                           && !(hasMascot && isStringEqual(cardTemplate.value(QStringLiteral("card-size")), QStringLiteral("small")));
+    const QVariant overlay = cardTemplate.value(QStringLiteral("overlay"));
+    const bool headerAsOverlay = hasArt && overlay.type() == QVariant::Bool && overlay.toBool() && (hasTitle || hasMascot);
+    const bool hasSubtitle = hasTitle && isTruthy(components.value(QStringLiteral("subtitle")));
+    const bool hasHeaderRow = hasMascot && hasTitle;
+    const bool hasAttributes = hasTitle && isTruthy(member(components.value(QStringLiteral("attributes")), QStringLiteral("field")));
+    const bool hasSocialActions = hasTitle && isTruthy(components.value(QStringLiteral("social-actions")));
+    bool isAudio = isStringEqual(cardTemplate.value(QStringLiteral("quick-preview-type")), QStringLiteral("audio"));
+    const QString asynchronous = isCardTool ? QStringLiteral("false") : QStringLiteral("true");
+
+    code += QLatin1String("signal action(var actionId);\n");
+    if (isAudio) {
+        // For now we only support audio cards with [optional] art, title, subtitle
+        // in horizontal mode
+        // Anything else makes it behave not like an audio card
+        isAudio = !hasSummary && isHorizontal && !hasMascot && !hasEmblem && !headerAsOverlay && !hasAttributes;
+    }
+
+    if (hasBackground) {
+        QString templateCardBackground;
+        if (isString(cardBackground)) {
+            templateCardBackground = QStringLiteral("decodeURI(\"%1\")").arg(encodeURI(cardBackground.toString()));
+        } else {
+            templateCardBackground = QStringLiteral("\"\"");
+        }
+
+        QString backgroundElements0 = QStringLiteral("undefined");
+        QString backgroundElements1 = QStringLiteral("undefined");
+        const QVariant backgroundType = member(cardBackground, QStringLiteral("type"));
+        if (isStringEqual(backgroundType, QStringLiteral("color")) || isStringEqual(backgroundType, QStringLiteral("gradient"))) {
+            const QVariantList elements = member(cardBackground, QStringLiteral("elements")).toList();
+            if (elements.count() > 0 && elements[0].isValid()) {
+                backgroundElements0 = QStringLiteral("\"%1\"").arg(sanitizeColor(elements[0].toString()));
+            }
+            if (elements.count() > 1 && elements[1].isValid()) {
+                backgroundElements1 = QStringLiteral("\"%1\"").arg(sanitizeColor(elements[1].toString()));
+            }
+        }
+        code += templateArg(kBackgroundLoaderCode).arg(backgroundElements0).arg(backgroundElements1).arg(asynchronous).arg(templateCardBackground);
+    }
+
+    if (hasArt) {
+        QString artShapeAspect;
+        if (isCardTool) {
+            code += QLatin1String("readonly property size artShapeSize: artShapeLoader.item ? Qt.size(artShapeLoader.item.width, artShapeLoader.item.height) : Qt.size(-1, -1);\n");
+            artShapeAspect = artShapeAspectCode(member(art, QStringLiteral("aspect-ratio")));
+        } else {
+            artShapeAspect = QStringLiteral("(root.fixedArtShapeSize.width / root.fixedArtShapeSize.height)");
+        }
+
+        QString widthCode, heightCode;
+        QString artAnchors;
+        if (isHorizontal) {
+            artAnchors = QStringLiteral("left: parent.left");
+            if (hasMascot || hasTitle) {
+                widthCode = QStringLiteral("height * ") + artShapeAspect;
+                heightCode = QStringLiteral("headerHeight + 2 * units.gu(1)");
+            } else {
+                // This side of the else is a bit silly, who wants an horizontal layout without mascot and title?
+                // So we define a "random" height of the image height + 2 gu for the margins
+                widthCode = QStringLiteral("height * ") + artShapeAspect;
+                heightCode = QStringLiteral("units.gu(7.625)");
+            }
+        } else {
+            artAnchors = QStringLiteral("horizontalCenter: parent.horizontalCenter;");
+            widthCode = QStringLiteral("root.width");
+            heightCode = QStringLiteral("width / ") + artShapeAspect;
+        }
+
+        const QVariant fallbackValue = member(art, QStringLiteral("fallback"));
+        const QString fallback = !isCardTool && isTruthy(fallbackValue) ? encodeURI(fallbackValue.toString()) : QString();
+        QString fallbackStatusCode;
+        QString fallbackURICode = QStringLiteral("\"\"");
+        if (!fallback.isEmpty()) {
+            // fallbackStatusCode has %8 in it because we want to substitute it for fallbackURICode
+            // which in kArtShapeHolderCode is %8
+            fallbackStatusCode = QStringLiteral("onStatusChanged: if (status === Image.Error) source = %8;");
+            fallbackURICode = QStringLiteral("decodeURI(\"%1\")").arg(fallback);
+        }
+        QString artShapeHolderShapeCode;
+        if (!isConciergeMode) {
+            if (artShapeStyle == QLatin1String("icon")) {
+                artShapeHolderShapeCode = templateArg(kArtProportionalShapeCode);
+            } else {
+                QString artShapeHolderShapeAspect;
+                if (artShapeStyle == QLatin1String("inset")) {
+                    artShapeHolderShapeAspect = QStringLiteral("UbuntuShape.Inset");
+                } else if (artShapeStyle == QLatin1String("shadow")) {
+                    artShapeHolderShapeAspect = QStringLiteral("UbuntuShape.DropShadow");
+                } else {
+                    artShapeHolderShapeAspect = QStringLiteral("UbuntuShape.Flat");
+                }
+                artShapeHolderShapeCode = templateArg(kArtUbuntuShapeCode).arg(artShapeHolderShapeAspect);
+            }
+        }
+        const char *artShapeHolderCode = isCardTool ? kArtShapeHolderCodeCardToolCard : kArtShapeHolderCode;
+        code += templateArg(artShapeHolderCode).arg(artAnchors)
+                                               .arg(widthCode)
+                                               .arg(heightCode)
+                                               .arg(isConciergeMode ? QStringLiteral("true") : QStringLiteral("false"))
+                                               .arg(asynchronous)
+                                               .arg(artShapeHolderShapeCode)
+                                               .arg(fallbackStatusCode)
+                                               .arg(fallbackURICode);
+    } else if (isCardTool) {
+        code += QLatin1String("readonly property size artShapeSize: Qt.size(-1, -1);\n");
+    }
+
+    if (headerAsOverlay) {
+        const QString headerHeightCode = isCardTool ? QStringLiteral("headerHeight") : QStringLiteral("root.fixedHeaderHeight");
+        code += templateArg(kOverlayLoaderCode).arg(asynchronous).arg(headerHeightCode);
+    }
+
+    QString headerVerticalAnchors;
+    if (headerAsOverlay) {
+        headerVerticalAnchors = QStringLiteral("bottom: artShapeLoader.bottom;\n"
+                                               "bottomMargin: units.gu(1);\n");
+    } else {
+        if (hasArt) {
+            if (isHorizontal) {
+                headerVerticalAnchors = QStringLiteral("top: artShapeLoader.top;\n"
+                                                       "topMargin: units.gu(1);\n");
+            } else {
+                headerVerticalAnchors = QStringLiteral("top: artShapeLoader.bottom;\n"
+                                                       "topMargin: units.gu(1);\n");
+            }
+        } else {
+            headerVerticalAnchors = QStringLiteral("top: parent.top;\n"
+                                                   "topMargin: units.gu(1);\n");
+        }
+    }
+
+    QString headerLeftAnchor;
+    bool headerLeftAnchorHasMargin = false;
+    if (isHorizontal && hasArt) {
+        headerLeftAnchor = QStringLiteral("left: artShapeLoader.right;\n"
+                                          "leftMargin: units.gu(1);\n");
+        headerLeftAnchorHasMargin = true;
+    } else if (isHorizontal && isAudio) {
+        headerLeftAnchor = QStringLiteral("left: audioButton.right;\n"
+                                          "leftMargin: units.gu(1);\n");
+        headerLeftAnchorHasMargin = true;
+    } else {
+        headerLeftAnchor = QStringLiteral("left: parent.left;\n");
+    }
+
+    const bool touchdownOnArtShape = !hasBackground && hasArt && !hasMascot && !hasSummary && !isAudio;
+
+    if (hasHeaderRow) {
+        code += QLatin1String("readonly property int headerHeight: row.height;\n");
+    } else if (hasMascot) {
+        code += QLatin1String("readonly property int headerHeight: mascotImage.height;\n");
+    } else if (hasAttributes) {
+        if (hasTitle && hasSubtitle) {
+            code += QLatin1String("readonly property int headerHeight: titleLabel.height + subtitleLabel.height + subtitleLabel.anchors.topMargin + attributesRow.height + attributesRow.anchors.topMargin;\n");
+        } else if (hasTitle) {
+            code += QLatin1String("readonly property int headerHeight: titleLabel.height + attributesRow.height + attributesRow.anchors.topMargin;\n");
+        } else {
+            code += QLatin1String("readonly property int headerHeight: attributesRow.height;\n");
+        }
+    } else if (isAudio) {
+        if (hasSubtitle) {
+            code += QLatin1String("readonly property int headerHeight: titleLabel.height + subtitleLabel.height + subtitleLabel.anchors.topMargin + audioProgressBar.height + audioProgressBar.anchors.topMargin;\n");
+        } else if (hasTitle) {
+            code += QLatin1String("readonly property int headerHeight: titleLabel.height + audioProgressBar.height + audioProgressBar.anchors.topMargin;\n");
+        } else {
+            code += QLatin1String("readonly property int headerHeight: audioProgressBar.height;\n");
+        }
+    } else if (hasSubtitle) {
+        code += QLatin1String("readonly property int headerHeight: titleLabel.height + subtitleLabel.height + subtitleLabel.anchors.topMargin;\n");
+    } else if (hasTitle) {
+        code += QLatin1String("readonly property int headerHeight: titleLabel.height;\n");
+    } else {
+        code += QLatin1String("readonly property int headerHeight: 0;\n");
+    }
+
+    QString mascotShapeCode;
+    QString mascotCode;
+    if (hasMascot) {
+        const bool useMascotShape = !hasBackground && !headerAsOverlay;
+        QString mascotAnchors;
+        if (!hasHeaderRow) {
+            mascotAnchors += headerLeftAnchor;
+            mascotAnchors += headerVerticalAnchors;
+            if (!headerLeftAnchorHasMargin) {
+                mascotAnchors += QLatin1String("leftMargin: units.gu(1);\n");
+            }
+        } else {
+            mascotAnchors = QStringLiteral("verticalCenter: parent.verticalCenter;");
+        }
+
+        if (useMascotShape) {
+            mascotShapeCode = templateArg(kMascotShapeLoaderCode).arg(mascotAnchors).arg(asynchronous);
+        }
+
+        const QString mascotImageVisible = useMascotShape ? QStringLiteral("false") : QStringLiteral("showHeader");
+        const QVariant fallbackValue = member(components.value(QStringLiteral("mascot")), QStringLiteral("fallback"));
+        const QString fallback = !isCardTool && isTruthy(fallbackValue) ? encodeURI(fallbackValue.toString()) : QString();
+        QString fallbackStatusCode;
+        QString fallbackURICode = QStringLiteral("\"\"");
+        if (!fallback.isEmpty()) {
+            // fallbackStatusCode has %4 in it because we want to substitute it for fallbackURICode
+            // which in kMascotImageCode is %4
+            fallbackStatusCode = QStringLiteral("onStatusChanged: if (status === Image.Error) source = %4;");
+            fallbackURICode = QStringLiteral("decodeURI(\"%1\")").arg(fallback);
+        }
+        mascotCode = templateArg(kMascotImageCode).arg(mascotAnchors).arg(mascotImageVisible).arg(fallbackStatusCode).arg(fallbackURICode);
+    }
+
+    const QString summaryColorWithBackground = QStringLiteral("backgroundLoader.active && backgroundLoader.item && root.scopeStyle ? root.scopeStyle.getTextColor(backgroundLoader.item.luminance) : (backgroundLoader.item && backgroundLoader.item.luminance > 0.7 ? theme.palette.normal.baseText : \"white\")");
+    const QString foregroundColor = QStringLiteral("root.scopeStyle ? root.scopeStyle.foreground : theme.palette.normal.baseText");
+
+    const bool hasTitleContainer = hasTitle && (hasEmblem || (hasMascot && (hasSubtitle || hasAttributes)));
+    QString titleSubtitleCode;
+    if (hasTitle) {
+        QString titleColor;
+        if (headerAsOverlay) {
+            titleColor = QStringLiteral("root.scopeStyle && overlayLoader.item ? root.scopeStyle.getTextColor(overlayLoader.item.luminance) : (overlayLoader.item && overlayLoader.item.luminance > 0.7 ? theme.palette.normal.baseText : \"white\")");
+        } else if (hasSummary) {
+            titleColor = QStringLiteral("summary.color");
+        } else if (hasBackground) {
+            titleColor = summaryColorWithBackground;
+        } else {
+            titleColor = foregroundColor;
+        }
+
+        QString titleAnchors;
+        QString subtitleAnchors;
+        QString attributesAnchors;
+        QString titleContainerAnchors;
+        QString titleRightAnchor;
+        QString titleWidth = QStringLiteral("undefined");
+
+        QString extraRightAnchor;
+        QString extraLeftAnchor;
+        if (!touchdownOnArtShape) {
+            extraRightAnchor = QStringLiteral("rightMargin: units.gu(1);\n");
+            extraLeftAnchor = QStringLiteral("leftMargin: units.gu(1);\n");
+        } else if (headerAsOverlay && !hasEmblem) {
+            extraRightAnchor = QStringLiteral("rightMargin: units.gu(1);\n");
+        }
+
+        if (hasMascot) {
+            titleContainerAnchors = QStringLiteral("verticalCenter: parent.verticalCenter; ");
+        } else {
+            titleContainerAnchors = QStringLiteral("right: parent.right; ");
+            titleContainerAnchors += headerLeftAnchor;
+            titleContainerAnchors += headerVerticalAnchors;
+            if (!headerLeftAnchorHasMargin) {
+                titleContainerAnchors += extraLeftAnchor;
+            }
+        }
+        if (hasEmblem) {
+            titleRightAnchor = QStringLiteral("right: emblemIcon.left;\n"
+                                              "rightMargin: emblemIcon.width > 0 ? units.gu(0.5) : 0;\n");
+        } else {
+            titleRightAnchor = QStringLiteral("right: parent.right;\n");
+            titleRightAnchor += extraRightAnchor;
+        }
+
+        if (hasTitleContainer) {
+            // Using headerTitleContainer
+            titleAnchors = titleRightAnchor;
+            titleAnchors += QLatin1String("left: parent.left;\n"
+                                          "top: parent.top;");
+            subtitleAnchors = QStringLiteral("right: parent.right;\n"
+                                             "left: parent.left;\n");
+            subtitleAnchors += extraRightAnchor;
+            if (hasSubtitle) {
+                attributesAnchors = subtitleAnchors + QLatin1String("top: subtitleLabel.bottom;\n");
+                subtitleAnchors += QLatin1String("top: titleLabel.bottom;\n");
+            } else {
+                attributesAnchors = subtitleAnchors + QLatin1String("top: titleLabel.bottom;\n");
+            }
+        } else if (hasMascot) {
+            // Using row without titleContainer
+            titleAnchors = QStringLiteral("verticalCenter: parent.verticalCenter;\n");
+            titleWidth = QStringLiteral("parent.width - x");
+        } else {
+            if (headerAsOverlay) {
+                // Using anchors to the overlay
+                titleAnchors = titleRightAnchor;
+                titleAnchors += QLatin1String("left: parent.left;\n"
+                                              "leftMargin: units.gu(1);\n"
+                                              "top: overlayLoader.top;\n"
+                                              "topMargin: units.gu(1) + overlayLoader.height - overlayLoader.overlayHeight;\n");
+            } else {
+                // Using anchors to the mascot/parent
+                titleAnchors = titleRightAnchor;
+                titleAnchors += headerLeftAnchor;
+                titleAnchors += headerVerticalAnchors;
+                if (!headerLeftAnchorHasMargin) {
+                    titleAnchors += extraLeftAnchor;
+                }
+            }
+            subtitleAnchors = QStringLiteral("left: titleLabel.left;\n"
+                                             "leftMargin: titleLabel.leftMargin;\n");
+            subtitleAnchors += extraRightAnchor;
+            if (hasEmblem) {
+                // using container
+                subtitleAnchors += QLatin1String("right: parent.right;\n");
+            } else {
+                subtitleAnchors += QLatin1String("right: titleLabel.right;\n");
+            }
+
+            if (hasSubtitle) {
+                attributesAnchors = subtitleAnchors + QLatin1String("top: subtitleLabel.bottom;\n");
+                subtitleAnchors += QLatin1String("top: titleLabel.bottom;\n");
+            } else {
+                attributesAnchors = subtitleAnchors + QLatin1String("top: titleLabel.bottom;\n");
+            }
+        }
+
+        QString titleAlignment = QStringLiteral("Text.AlignHCenter");
+        const QVariant title = components.value(QStringLiteral("title"));
+        if (isHorizontal || !isObject(title) || isStringEqual(member(title, QStringLiteral("align")), QStringLiteral("left"))) {
+            titleAlignment = QStringLiteral("Text.AlignLeft");
+        }
+        const QStringList keys = { QStringLiteral("mascot"), QStringLiteral("emblem"), QStringLiteral("subtitle"), QStringLiteral("attributes"), QStringLiteral("summary") };
+        Q_FOREACH(const QString &key, keys) {
+            const QVariant component = components.value(key);
+            if (isString(component) || isString(member(component, QStringLiteral("field")))) {
+                titleAlignment = QStringLiteral("Text.AlignLeft");
+            }
+        }
+
+        // code for different elements
+        const QString titleLabelVisibleExtra = headerAsOverlay ? QStringLiteral("&& overlayLoader.active") : QString();
+        const QString titleCode = templateArg(kTitleLabelCode).arg(titleAnchors).arg(titleColor).arg(titleLabelVisibleExtra).arg(titleWidth).arg(titleAlignment);
+        QString subtitleCode;
+        QString attributesCode;
+
+        // code for the title container
+        QStringList containerCode;
+        QString containerHeight = QStringLiteral("titleLabel.height");
+        containerCode << titleCode;
+        if (hasSubtitle) {
+            subtitleCode = templateArg(kSubtitleLabelCode).arg(subtitleAnchors).arg(titleColor);
+            containerCode << subtitleCode;
+            containerHeight += QLatin1String(" + subtitleLabel.height");
+        }
+        if (hasEmblem) {
+            containerCode << templateArg(kEmblemIconCode).arg(extraRightAnchor).arg(titleColor);
+        }
+        if (hasAttributes) {
+            attributesCode = templateArg(kAttributesRowCode).arg(attributesAnchors).arg(titleColor);
+            containerCode << attributesCode;
+            containerHeight += QLatin1String(" + attributesRow.height");
+        }
+
+        if (hasTitleContainer) {
+            // use container
+            titleSubtitleCode = templateArg(kHeaderContainerCode).arg(titleContainerAnchors).arg(containerHeight).arg(containerCode.join(QLatin1Char(',')));
+        } else {
+            // no container
+            titleSubtitleCode = titleCode;
+            if (hasSubtitle) {
+                titleSubtitleCode += subtitleCode;
+            }
+            if (hasAttributes) {
+                titleSubtitleCode += attributesCode;
+            }
+        }
+    }
+
+    if (hasHeaderRow) {
+        QStringList rowCode;
+        if (!mascotShapeCode.isEmpty()) {
+            rowCode << mascotShapeCode;
+        }
+        rowCode << mascotCode << titleSubtitleCode;
+        const QString heightCode = isCardTool ? QString() : QStringLiteral("height: root.fixedHeaderHeight;\n");
+        code += templateArg(kHeaderRowCode).arg(headerVerticalAnchors + headerLeftAnchor).arg(heightCode).arg(rowCode.join(QLatin1Char(',')));
+    } else {
+        code += mascotShapeCode + mascotCode + titleSubtitleCode;
+    }
+
+    if (isAudio) {
+        const QString audioProgressBarLeftAnchor = QStringLiteral("audioButton.right");
+        const QString audioProgressBarBottomAnchor = QStringLiteral("audioButton.bottom");
+
+        code += templateArg(kAudioProgressBarCode).arg(audioProgressBarBottomAnchor)
+                                                  .arg(audioProgressBarLeftAnchor)
+                                                  .arg(foregroundColor);
+
+        QString audioButtonAnchorsFill;
+        QString audioButtonWidth;
+        QString audioButtonHeight;
+        if (hasArt) {
+            audioButtonAnchorsFill = QStringLiteral("artShapeLoader");
+            audioButtonWidth = QStringLiteral("undefined");
+            audioButtonHeight = QStringLiteral("undefined");
+        } else {
+            audioButtonAnchorsFill = QStringLiteral("undefined");
+            audioButtonWidth = QStringLiteral("height");
+            audioButtonHeight = isCardTool ? QStringLiteral("headerHeight + 2 * units.gu(1)")
+                                           : QStringLiteral("root.fixedHeaderHeight + 2 * units.gu(1)");
+        }
+        code += templateArg(kAudioButtonCode).arg(audioButtonAnchorsFill).arg(audioButtonWidth).arg(audioButtonHeight).arg(asynchronous);
+    }
+
+    // What the summary and the social actions go below
+    QString topAnchor;
+    if (isHorizontal && hasArt) topAnchor = QStringLiteral("artShapeLoader.bottom");
+    else if (headerAsOverlay && hasArt) topAnchor = QStringLiteral("artShapeLoader.bottom");
+    else if (hasHeaderRow) topAnchor = QStringLiteral("row.bottom");
+    else if (hasTitleContainer) topAnchor = QStringLiteral("headerTitleContainer.bottom");
+    else if (hasMascot) topAnchor = QStringLiteral("mascotImage.bottom");
+    else if (hasAttributes) topAnchor = QStringLiteral("attributesRow.bottom");
+    else if (hasSubtitle) topAnchor = QStringLiteral("subtitleLabel.bottom");
+    else if (hasTitle) topAnchor = QStringLiteral("titleLabel.bottom");
+    else if (hasArt) topAnchor = QStringLiteral("artShapeLoader.bottom");
+    else topAnchor = QStringLiteral("parent.top");
+
+    if (hasSummary) {
+        const QString summaryColor = hasBackground ? summaryColorWithBackground : foregroundColor;
+        const QString summaryTopMargin = hasMascot || hasSubtitle || hasAttributes ? QStringLiteral("anchors.margins") : QStringLiteral("0");
+
+        code += templateArg(kSummaryLabelCode).arg(topAnchor).arg(summaryTopMargin).arg(summaryColor);
+    }
+
+    if (hasSocialActions) {
+        QString socialTopAnchor;
+        if (hasSummary) socialTopAnchor = QStringLiteral("summary.bottom;");
+        else if (topAnchor == QLatin1String("parent.top")) socialTopAnchor = topAnchor;
+        else socialTopAnchor = topAnchor + QLatin1Char(';');
+
+        const QString socialAnchors = QStringLiteral("top: ") + socialTopAnchor + QStringLiteral(" left: parent.left; right: parent.right; topMargin: units.gu(1);");
+        const QString socialColor = hasBackground ? summaryColorWithBackground : foregroundColor;
+
+        code += templateArg(kSocialActionsRowCode).arg(socialAnchors).arg(socialColor);
+    }
+
+    if (artShapeStyle != QLatin1String("shadow") && artShapeStyle != QLatin1String("icon") && !isCardTool) {
+        QString touchdownAnchors;
+        if (hasBackground) {
+            touchdownAnchors = QStringLiteral("fill: backgroundLoader");
+        } else if (touchdownOnArtShape) {
+            touchdownAnchors = QStringLiteral("fill: artShapeLoader");
+        } else {
+            touchdownAnchors = QStringLiteral("fill: root");
+        }
+        code += templateArg(kTouchdownCode).arg(touchdownAnchors);
+    }
+
+    QString implicitHeight;
+    if (isCardTool || categoryLayout != QLatin1String("grid")) {
+        if (hasSocialActions) {
+            implicitHeight = QStringLiteral("socialActionsRow.y + socialActionsRow.height + units.gu(1)");
+        } else if (hasSummary) {
+            implicitHeight = QStringLiteral("summary.y + summary.height + units.gu(1)");
+        } else if (isAudio) {
+            implicitHeight = QStringLiteral("audioButton.height");
+        } else if (headerAsOverlay) {
+            implicitHeight = QStringLiteral("artShapeLoader.height");
+        } else if (hasHeaderRow) {
+            implicitHeight = QStringLiteral("row.y + row.height + units.gu(1)");
+        } else if (hasMascot) {
+            implicitHeight = QStringLiteral("mascotImage.y + mascotImage.height");
+        } else if (hasTitleContainer) {
+            implicitHeight = QStringLiteral("headerTitleContainer.y + headerTitleContainer.height + units.gu(1)");
+        } else if (hasAttributes) {
+            implicitHeight = QStringLiteral("attributesRow.y + attributesRow.height + units.gu(1)");
+        } else if (hasSubtitle) {
+            implicitHeight = QStringLiteral("subtitleLabel.y + subtitleLabel.height + units.gu(1)");
+        } else if (hasTitle) {
+            implicitHeight = QStringLiteral("titleLabel.y + titleLabel.height + units.gu(1)");
+        } else if (hasArt) {
+            implicitHeight = QStringLiteral("artShapeLoader.height");
+        }
+    }
+    if (!implicitHeight.isEmpty()) {
+        code += QLatin1String("implicitHeight: ") + implicitHeight + QLatin1String(";\n");
+    }
+
+    // Close the AbstractButton
+    code += QLatin1String("}\n");
+
+    return code;
+}
+
+QQmlComponent *CardCreator::createCardComponent(const QVariantMap &cardTemplate, const QVariantMap &components,
+                                                bool isCardTool, const QString &artShapeStyle,
+                                                const QString &categoryLayout, const QString &identifier)
+{
+    QString cachePath;
+    if (!m_cacheDir.isEmpty()) {
+        cachePath = m_cacheDir + QLatin1Char('/') + cardCacheKey(cardTemplate, components, isCardTool, artShapeStyle, categoryLayout) + QStringLiteral(".qml");
+
+        if (QFile::exists(cachePath)) {
+            QQmlComponent *component = new QQmlComponent(m_engine, QUrl::fromLocalFile(cachePath), this);
+            if (!component->isError()) {
+                // The modification time tells which cards are the least recently used
+                utime(QFile::encodeName(cachePath).constData(), nullptr);
+                QQmlEngine::setObjectOwnership(component, QQmlEngine::CppOwnership);
+                return component;
+            }
+            // Most probably a file left half written, generate it again
+            qWarning() << "CardCreator: Discarding broken cached card" << cachePath << component->errors();
+            delete component;
+            QFile::remove(cachePath);
+        }
+    }
+
+    const QString code = QLatin1String(kImportsCode) + cardString(cardTemplate, components, isCardTool, artShapeStyle, categoryLayout);
+
+    QQmlComponent *component = new QQmlComponent(m_engine, this);
+    if (!cachePath.isEmpty() && writeCachedCard(cachePath, code)) {
+        // Loading from the file lets the engine cache the compiled unit too
+        component->loadUrl(QUrl::fromLocalFile(cachePath));
+    } else {
+        QUrl url(identifier);
+        if (url.isEmpty() || !url.isValid()) {
+            url = QUrl(QStringLiteral("inline"));
+        }
+        component->setData(code.toUtf8(), url);
+    }
+
+    if (component->isError()) {
+        qWarning() << "ERROR: Invalid component created.";
+        qWarning() << "Template:" << cardTemplate;
+        qWarning() << "Components:" << components;
+        qWarning() << "Errors:" << component->errors();
+        qWarning().noquote() << "Code:" << code;
+        delete component;
+        if (!cachePath.isEmpty()) {
+            QFile::remove(cachePath);
+        }
+        return nullptr;
+    }
+
+    QQmlEngine::setObjectOwnership(component, QQmlEngine::CppOwnership);
+    return component;
+}
+
+void CardCreator::removeUnusedCards() const
+{
+    // Most recently used first
+    const QFileInfoList cards = QDir(m_cacheDir).entryInfoList(QStringList() << QStringLiteral("*.qml"), QDir::Files, QDir::Time);
+    for (int i = maxCachedCards; i < cards.count(); ++i) {
+        QFile::remove(cards[i].filePath());
+        // The compiled unit, if the engine left one
+        QFile::remove(cards[i].filePath() + QLatin1Char('c'));
+    }
+}
+
+bool CardCreator::writeCachedCard(const QString &cachePath, const QString &code) const
+{
+    // QSaveFile so a crash never leaves a truncated card behind
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(code.toUtf8());
+    return file.commit();
+}
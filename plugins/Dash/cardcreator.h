@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARDCREATOR_H
+#define CARDCREATOR_H
+
+#include <QObject>
+#include <QQmlComponent>
+#include <QVariantMap>
+
+class QQmlEngine;
+
+/**
+    Creates the components of the Dash cards
+
+    The card for a category is generated from its template and components
+    and compiled into a component that is then used as delegate for all the
+    results of the category.
+
+    This used to be done in CardCreator.js, the generated code is the same
+    but it is put together natively instead of with JavaScript string
+    operations. The code still has to be compiled by the QML engine on the
+    GUI thread, only the disk cache below saves that on later starts.
+
+    The components have no creation context. CardCreator.js used to create
+    them in the context of CardCreatorCache, now the views create the cards
+    in their own context. The generated code only uses its own ids and the
+    root context properties (units, theme, i18n), which both chains reach.
+
+    The generated cards are also cached on disk, keyed by a hash of the
+    inputs, so on the next start they are loaded without generating
+    them again. The cache directory is named after a hash of cardcreator.cpp
+    taken at build time, so a new version of the generator starts with an
+    empty cache. Only the maxCachedCards most recently used cards are kept.
+*/
+class CardCreator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CardCreator(QQmlEngine *engine, QObject *parent = nullptr);
+
+    // The least recently used cards beyond this are removed from the disk cache on start
+    static const int maxCachedCards = 200;
+
+    // The code of the card, without the imports
+    Q_INVOKABLE QString cardString(const QVariantMap &cardTemplate, const QVariantMap &components,
+                                   bool isCardTool, const QString &artShapeStyle,
+                                   const QString &categoryLayout = QString()) const;
+
+    // Returns nullptr if the generated code does not compile.
+    // identifier is used as url of the component in error messages
+    // when the card can not be cached on disk
+    Q_INVOKABLE QQmlComponent *createCardComponent(const QVariantMap &cardTemplate, const QVariantMap &components,
+                                                   bool isCardTool, const QString &artShapeStyle,
+                                                   const QString &categoryLayout = QString(),
+                                                   const QString &identifier = QString());
+
+private:
+    void removeUnusedCards() const;
+    bool writeCachedCard(const QString &cachePath, const QString &code) const;
+
+    QQmlEngine *m_engine;
+    // Empty if the cards can not be cached on disk
+    QString m_cacheDir;
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cardcreatorcache.h"
+
+#include "cardcreator.h"
+
+#include <QHash>
+
+// Walks maps and lists so that equal values hash the same
+// no matter how they were built
+static uint structuralHash(const QVariant &value, uint seed)
+{
+    switch (static_cast<int>(value.type())) {
+        case QVariant::Map: {
+            // Shares the data with value, no copy
+            const QVariantMap map = value.toMap();
+            uint hash = qHash(map.count(), seed);
+            for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+                hash = structuralHash(it.value(), qHash(it.key(), hash));
+            }
+            return hash;
+        }
+        case QVariant::List: {
+            const QVariantList list = value.toList();
+            uint hash = qHash(list.count(), seed);
+            Q_FOREACH(const QVariant &item, list) {
+                hash = structuralHash(item, hash);
+            }
+            return hash;
+        }
+        case QVariant::Bool:
+            return qHash(value.toBool(), seed);
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Double:
+            // 1 and 1.0 compare equal so they have to hash the same
+            return qHash(value.toDouble(), seed);
+        case QVariant::Invalid:
+            return qHash(-1, seed);
+        default:
+            return qHash(value.toString(), seed);
+    }
+}
+
+CardCreatorCache::CardCreatorCache(QQmlEngine *engine, QObject *parent)
+ : QObject(parent)
+ , m_cardCreator(new CardCreator(engine, this))
+ , m_hits(0)
+ , m_misses(0)
+{
+}
+
+QQmlComponent *CardCreatorCache::getCardComponent(const QVariant &cardTemplate, const QVariant &components,
+                                                  bool isCardTool, const QString &artShapeStyle,
+                                                  const QString &categoryLayout)
+{
+    if (!cardTemplate.isValid() || !components.isValid())
+        return nullptr;
+
+    uint hash = structuralHash(cardTemplate, 0);
+    hash = structuralHash(components, hash);
+    hash = qHash(isCardTool, hash);
+    hash = qHash(artShapeStyle, hash);
+    hash = qHash(categoryLayout, hash);
+
+    for (auto it = m_cards.constFind(hash); it != m_cards.constEnd() && it.key() == hash; ++it) {
+        const CachedCard &card = it.value();
+        if (card.isCardTool == isCardTool && card.artShapeStyle == artShapeStyle && card.categoryLayout == categoryLayout
+                && card.cardTemplate == cardTemplate && card.components == components) {
+            ++m_hits;
+            Q_EMIT countersChanged();
+            return card.component;
+        }
+    }
+
+    // Cards that fail to be created are cached too so they are not retried for each delegate
+    QQmlComponent *component = m_cardCreator->createCardComponent(cardTemplate.toMap(), components.toMap(),
+                                                                  isCardTool, artShapeStyle, categoryLayout);
+    m_cards.insert(hash, { cardTemplate, components, isCardTool, artShapeStyle, categoryLayout, component });
+    ++m_misses;
+    Q_EMIT countersChanged();
+    return component;
+}
+
+int CardCreatorCache::hits() const
+{
+    return m_hits;
+}
+
+int CardCreatorCache::misses() const
+{
+    return m_misses;
+}
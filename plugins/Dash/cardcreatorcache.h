@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARDCREATORCACHE_H
+#define CARDCREATORCACHE_H
+
+#include <QMultiHash>
+#include <QObject>
+#include <QQmlComponent>
+#include <QVariant>
+
+class CardCreator;
+class QQmlEngine;
+
+/**
+    Caches the card components created by CardCreator
+
+    getCardComponent is called for every delegate of the Dash, so the lookup
+    hashes the template and components structurally instead of serializing
+    them to build a key. Equal inputs get the same component.
+*/
+class CardCreatorCache : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int hits READ hits NOTIFY countersChanged)
+    Q_PROPERTY(int misses READ misses NOTIFY countersChanged)
+
+public:
+    explicit CardCreatorCache(QQmlEngine *engine, QObject *parent = nullptr);
+
+    // Returns nullptr if cardTemplate or components are undefined
+    // or the card could not be created
+    Q_INVOKABLE QQmlComponent *getCardComponent(const QVariant &cardTemplate, const QVariant &components,
+                                                bool isCardTool, const QString &artShapeStyle,
+                                                const QString &categoryLayout);
+
+    int hits() const;
+    int misses() const;
+
+Q_SIGNALS:
+    void countersChanged();
+
+private:
+    struct CachedCard {
+        QVariant cardTemplate;
+        QVariant components;
+        bool isCardTool;
+        QString artShapeStyle;
+        QString categoryLayout;
+        QQmlComponent *component;
+    };
+
+    CardCreator *m_cardCreator;
+    QMultiHash<uint, CachedCard> m_cards;
+    int m_hits;
+    int m_misses;
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dashviewlayouts.h"
+
+#include <math.h>
+
+VerticalJournalLayout::VerticalJournalLayout(qreal columnWidth, qreal columnSpacing, qreal rowSpacing)
+ : m_columnWidth(columnWidth)
+ , m_columnSpacing(columnSpacing)
+ , m_rowSpacing(rowSpacing)
+{
+}
+
+int VerticalJournalLayout::columnCount(qreal width) const
+{
+    return qMax(1., floor((double)(width + m_columnSpacing) / (m_columnWidth + m_columnSpacing)));
+}
+
+qreal VerticalJournalLayout::columnX(int column) const
+{
+    return column * (m_columnWidth + m_columnSpacing);
+}
+
+int VerticalJournalLayout::columnToAppend(const QVector<qreal> &columnBottoms) const
+{
+    int column = 0;
+    for (int i = 1; i < columnBottoms.count(); ++i) {
+        if (columnBottoms[i] < columnBottoms[column]) {
+            column = i;
+        }
+    }
+    return column;
+}
+
+qreal VerticalJournalLayout::appendY(qreal columnBottom) const
+{
+    return columnBottom + m_rowSpacing;
+}
+
+qreal VerticalJournalLayout::prependY(qreal columnTop, qreal height) const
+{
+    return columnTop - m_rowSpacing - height;
+}
+
+QVector<QPointF> VerticalJournalLayout::layout(const QVector<qreal> &heights, qreal width) const
+{
+    QVector<qreal> columnBottoms(columnCount(width), -m_rowSpacing);
+    QVector<QPointF> positions;
+    positions.reserve(heights.count());
+    Q_FOREACH(const qreal height, heights) {
+        const int column = columnToAppend(columnBottoms);
+        const qreal y = appendY(columnBottoms[column]);
+        positions << QPointF(columnX(column), y);
+        columnBottoms[column] = y + height;
+    }
+    return positions;
+}
+
+HorizontalJournalLayout::HorizontalJournalLayout(qreal rowHeight, qreal columnSpacing, qreal rowSpacing)
+ : m_rowHeight(rowHeight)
+ , m_columnSpacing(columnSpacing)
+ , m_rowSpacing(rowSpacing)
+{
+}
+
+QPointF HorizontalJournalLayout::appendPosition(const QPointF &previousPos, qreal previousWidth, qreal itemWidth, qreal width, bool *startsRow) const
+{
+    const qreal x = previousPos.x() + previousWidth + m_columnSpacing;
+    *startsRow = x + itemWidth > width;
+    if (*startsRow) {
+        return QPointF(0, previousPos.y() + m_rowHeight + m_rowSpacing);
+    } else {
+        return QPointF(x, previousPos.y());
+    }
+}
+
+QPointF HorizontalJournalLayout::prependPosition(const QPointF &nextPos, qreal itemWidth, bool lastInRow, qreal lastInRowX) const
+{
+    if (lastInRow) {
+        // Going back from the start of a row, so go to the end of the previous one
+        return QPointF(lastInRowX, nextPos.y() - m_rowSpacing - m_rowHeight);
+    } else {
+        return QPointF(nextPos.x() - m_columnSpacing - itemWidth, nextPos.y());
+    }
+}
+
+QVector<QPointF> HorizontalJournalLayout::layout(const QVector<qreal> &widths, qreal width) const
+{
+    QVector<QPointF> positions;
+    positions.reserve(widths.count());
+    for (int i = 0; i < widths.count(); ++i) {
+        if (i == 0) {
+            positions << QPointF(0, 0);
+        } else {
+            bool startsRow;
+            positions << appendPosition(positions[i - 1], widths[i - 1], widths[i], width, &startsRow);
+        }
+    }
+    return positions;
+}
+
+OrganicGridLayout::OrganicGridLayout(const QSizeF &smallDelegateSize, const QSizeF &bigDelegateSize, qreal columnSpacing, qreal rowSpacing)
+ : m_smallDelegateSize(smallDelegateSize)
+ , m_bigDelegateSize(bigDelegateSize)
+ , m_columnSpacing(columnSpacing)
+ , m_rowSpacing(rowSpacing)
+{
+}
+
+qreal OrganicGridLayout::moduleWidth() const
+{
+    return m_smallDelegateSize.width() * 2 + m_columnSpacing * 2 + m_bigDelegateSize.width();
+}
+
+qreal OrganicGridLayout::moduleHeight() const
+{
+    return m_smallDelegateSize.height() + m_rowSpacing + m_bigDelegateSize.height();
+}
+
+int OrganicGridLayout::modulesPerRow(qreal width) const
+{
+    const int modules = floor((width + m_columnSpacing) / (moduleWidth() + m_columnSpacing));
+    return qMax(1, modules);
+}
+
+QPointF OrganicGridLayout::position(int modelIndex, int modulesPerRow) const
+{
+    const int itemsPerRow = modulesPerRow * 6;
+    const int rowIndex = floor(modelIndex / itemsPerRow);
+    const int columnIndex = floor((modelIndex - rowIndex * itemsPerRow) / 6);
+
+    qreal yPos = (moduleHeight() + m_rowSpacing) * rowIndex;
+    const int moduleIndex = modelIndex % 6;
+    if (moduleIndex == 2) {
+        yPos += m_smallDelegateSize.height() + m_rowSpacing;
+    } else if (moduleIndex == 3 || moduleIndex == 5) {
+        yPos += m_bigDelegateSize.height() + m_rowSpacing;
+    }
+
+    qreal xPos = (moduleWidth() + m_columnSpacing) * columnIndex;
+    if (moduleIndex == 1) {
+        xPos += m_smallDelegateSize.width() + m_columnSpacing;
+    } else if (moduleIndex == 3) {
+        xPos += m_bigDelegateSize.width() + m_columnSpacing;
+    } else if (moduleIndex == 4) {
+        xPos += (m_smallDelegateSize.width() + m_columnSpacing) * 2;
+    } else if (moduleIndex == 5) {
+        xPos += m_bigDelegateSize.width() + m_smallDelegateSize.width() + m_columnSpacing * 2;
+    }
+
+    return QPointF(xPos, yPos);
+}
+
+QSizeF OrganicGridLayout::size(int modelIndex) const
+{
+    const int moduleIndex = modelIndex % 6;
+    if (moduleIndex == 0 || moduleIndex == 1 || moduleIndex == 3 || moduleIndex == 5) {
+        return m_smallDelegateSize;
+    } else {
+        return m_bigDelegateSize;
+    }
+}
+
+qreal OrganicGridLayout::height(int itemCount, int modulesPerRow) const
+{
+    const int itemsPerRow = modulesPerRow * 6;
+    const int fullRows = floor(itemCount / itemsPerRow);
+    const qreal fullRowsHeight = fullRows == 0 ? 0 : fullRows * moduleHeight() + m_rowSpacing * (fullRows - 1);
+
+    const int remainingItems = itemCount - fullRows * itemsPerRow;
+    if (remainingItems == 0) {
+        return fullRowsHeight;
+    } else if (remainingItems <= 2) {
+        return fullRowsHeight + m_smallDelegateSize.height() + m_rowSpacing;
+    } else {
+        return fullRowsHeight + m_rowSpacing + moduleHeight();
+    }
+}
+
+QVector<QPointF> OrganicGridLayout::layout(int itemCount, qreal width) const
+{
+    const int modules = modulesPerRow(width);
+    QVector<QPointF> positions;
+    positions.reserve(itemCount);
+    for (int i = 0; i < itemCount; ++i) {
+        positions << position(i, modules);
+    }
+    return positions;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DASHVIEWLAYOUTS_H
+#define DASHVIEWLAYOUTS_H
+
+#include <QPointF>
+#include <QSizeF>
+#include <QVector>
+
+/**
+    The layout algorithms of VerticalJournal, HorizontalJournal and OrganicGrid
+
+    They only deal with sizes and positions, not with items, so they can be
+    used from any thread and measured without a scene. The views use them
+    to position the delegates they create, the layout() functions lay out
+    a whole model at once given the size of all its items.
+
+    They are cheap value classes, the views create them when needed with
+    their current properties.
+*/
+
+class VerticalJournalLayout
+{
+public:
+    VerticalJournalLayout(qreal columnWidth, qreal columnSpacing, qreal rowSpacing);
+
+    int columnCount(qreal width) const;
+    qreal columnX(int column) const;
+
+    // Given the bottom of each column (-rowSpacing for empty columns) returns
+    // the column the next item goes to, the topmost one, leftmost on ties
+    int columnToAppend(const QVector<qreal> &columnBottoms) const;
+    qreal appendY(qreal columnBottom) const;
+    qreal prependY(qreal columnTop, qreal height) const;
+
+    QVector<QPointF> layout(const QVector<qreal> &heights, qreal width) const;
+
+private:
+    qreal m_columnWidth;
+    qreal m_columnSpacing;
+    qreal m_rowSpacing;
+};
+
+class HorizontalJournalLayout
+{
+public:
+    HorizontalJournalLayout(qreal rowHeight, qreal columnSpacing, qreal rowSpacing);
+
+    // Position of an item of itemWidth that goes after the item at previousPos
+    // of previousWidth, startsRow tells if it had to go to the next row
+    QPointF appendPosition(const QPointF &previousPos, qreal previousWidth, qreal itemWidth, qreal width, bool *startsRow) const;
+
+    // Position of an item of itemWidth that goes before the item at nextPos.
+    // If the item is the last of its row lastInRowX is its x
+    QPointF prependPosition(const QPointF &nextPos, qreal itemWidth, bool lastInRow, qreal lastInRowX) const;
+
+    QVector<QPointF> layout(const QVector<qreal> &widths, qreal width) const;
+
+private:
+    qreal m_rowHeight;
+    qreal m_columnSpacing;
+    qreal m_rowSpacing;
+};
+
+class OrganicGridLayout
+{
+public:
+    OrganicGridLayout(const QSizeF &smallDelegateSize, const QSizeF &bigDelegateSize, qreal columnSpacing, qreal rowSpacing);
+
+    int modulesPerRow(qreal width) const;
+
+    QPointF position(int modelIndex, int modulesPerRow) const;
+    QSizeF size(int modelIndex) const;
+    qreal height(int itemCount, int modulesPerRow) const;
+
+    QVector<QPointF> layout(int itemCount, qreal width) const;
+
+private:
+    qreal moduleWidth() const;
+    qreal moduleHeight() const;
+
+    QSizeF m_smallDelegateSize;
+    QSizeF m_bigDelegateSize;
+    qreal m_columnSpacing;
+    qreal m_rowSpacing;
+};
+
+#endif
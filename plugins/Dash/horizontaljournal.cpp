@@ -18,9 +18,11 @@
  * The implementation is centered around m_visibleItems
  * that a list for each of the items in the view.
  * m_firstVisibleIndex is the index of the first item in m_visibleItems
- * m_lastInRowIndexPosition is a map that contains the x position
- * of items that are the last ones of a row so we can reconstruct the rows
- * when building back
+ * m_rowBreaks contains, for each row that has been completed, the index
+ * and x position of its last item so we can reconstruct the rows
+ * when building back. Since rows are completed in model order it is
+ * sorted and can be binary searched. It is only truncated from the first
+ * index that changes
  */
 
 #include "horizontaljournal.h"
@@ -30,6 +32,8 @@
 #include <private/qqmldelegatemodel_p.h>
 #include <private/qquickitem_p.h>
 
+#include <algorithm>
+
 HorizontalJournal::HorizontalJournal()
  : m_firstVisibleIndex(-1)
  , m_rowHeight(0)
@@ -56,6 +60,35 @@ void HorizontalJournal::setRowHeight(qreal rowHeight)
     }
 }
 
+HorizontalJournalLayout HorizontalJournal::journalLayout() const
+{
+    return HorizontalJournalLayout(m_rowHeight, columnSpacing(), rowSpacing());
+}
+
+int HorizontalJournal::rowBreakAtOrAfter(int modelIndex) const
+{
+    const auto it = std::lower_bound(m_rowBreaks.constBegin(), m_rowBreaks.constEnd(), modelIndex,
+                                     [](const RowBreak &rowBreak, int index) { return rowBreak.lastIndex < index; });
+    return it - m_rowBreaks.constBegin();
+}
+
+bool HorizontalJournal::isLastInRow(int modelIndex) const
+{
+    const int row = rowBreakAtOrAfter(modelIndex);
+    return row < m_rowBreaks.count() && m_rowBreaks[row].lastIndex == modelIndex;
+}
+
+void HorizontalJournal::addRowBreak(int modelIndex, qreal x)
+{
+    truncateRowBreaks(modelIndex);
+    m_rowBreaks.append({modelIndex, x});
+}
+
+void HorizontalJournal::truncateRowBreaks(int fromModelIndex)
+{
+    m_rowBreaks.resize(rowBreakAtOrAfter(fromModelIndex));
+}
+
 void HorizontalJournal::findBottomModelIndexToAdd(int *modelIndex, qreal *yPos)
 {
     if (m_visibleItems.isEmpty()) {
@@ -63,7 +96,7 @@ void HorizontalJournal::findBottomModelIndexToAdd(int *modelIndex, qreal *yPos)
         *yPos = 0;
     } else {
         *modelIndex = m_firstVisibleIndex + m_visibleItems.count();
-        if (m_lastInRowIndexPosition.contains(*modelIndex - 1)) {
+        if (isLastInRow(*modelIndex - 1)) {
             *yPos = m_visibleItems.last()->y() + m_rowHeight + rowSpacing();
         } else {
             *yPos = m_visibleItems.last()->y();
@@ -78,7 +111,7 @@ void HorizontalJournal::findTopModelIndexToAdd(int *modelIndex, qreal *yPos)
         *yPos = INT_MIN;
     } else {
         *modelIndex = m_firstVisibleIndex - 1;
-        if (m_lastInRowIndexPosition.contains(*modelIndex)) {
+        if (isLastInRow(*modelIndex)) {
             *yPos = m_visibleItems.first()->y() - rowSpacing() - m_rowHeight;
         } else {
             *yPos = m_visibleItems.first()->y();
@@ -99,7 +132,9 @@ bool HorizontalJournal::removeNonVisibleItems(qreal bufferFromY, qreal bufferToY
     while (!m_visibleItems.isEmpty() && m_visibleItems.last()->y() > bufferToY) {
         releaseItem(m_visibleItems.takeLast());
         changed = true;
-        m_lastInRowIndexPosition.remove(m_firstVisibleIndex + m_visibleItems.count());
+    }
+    if (changed && !m_visibleItems.isEmpty()) {
+        truncateRowBreaks(m_firstVisibleIndex + m_visibleItems.count());
     }
 
     if (m_visibleItems.isEmpty()) {
@@ -126,27 +161,18 @@ void HorizontalJournal::addItemToView(int modelIndex, QQuickItem *item)
         // modelIndex has to be either m_firstVisibleIndex - 1 or m_firstVisibleIndex + m_visibleItems.count()
         if (modelIndex == m_firstVisibleIndex + m_visibleItems.count()) {
             QQuickItem *lastItem = m_visibleItems.last();
-            if (lastItem->x() + lastItem->width() + columnSpacing() + item->width() <= width()) {
-                // Fits in the row
-                item->setY(lastItem->y());
-                item->setX(lastItem->x() + lastItem->width() + columnSpacing());
-            } else {
-                // Starts a new row
-                item->setY(lastItem->y() + m_rowHeight + rowSpacing());
-                item->setX(0);
-                m_lastInRowIndexPosition[modelIndex - 1] = lastItem->x();
+            bool startsRow;
+            item->setPosition(journalLayout().appendPosition(lastItem->position(), lastItem->width(), item->width(), width(), &startsRow));
+            if (startsRow) {
+                addRowBreak(modelIndex - 1, lastItem->x());
             }
             m_visibleItems << item;
         } else if (modelIndex == m_firstVisibleIndex - 1) {
             QQuickItem *firstItem = m_visibleItems.first();
-            if (m_lastInRowIndexPosition.contains(modelIndex)) {
-                // It is the last item of its row, so start a new one since we're going back
-                item->setY(firstItem->y() - rowSpacing() - m_rowHeight);
-                item->setX(m_lastInRowIndexPosition[modelIndex]);
-            } else {
-                item->setY(firstItem->y());
-                item->setX(firstItem->x() - columnSpacing() - item->width());
-            }
+            const int row = rowBreakAtOrAfter(modelIndex);
+            const bool lastInRow = row < m_rowBreaks.count() && m_rowBreaks[row].lastIndex == modelIndex;
+            const qreal lastInRowX = lastInRow ? m_rowBreaks[row].lastX : 0;
+            item->setPosition(journalLayout().prependPosition(firstItem->position(), item->width(), lastInRow, lastInRowX));
             m_firstVisibleIndex = modelIndex;
             m_visibleItems.prepend(item);
         } else {
@@ -162,7 +188,7 @@ void HorizontalJournal::cleanupExistingItems()
     Q_FOREACH(QQuickItem *item, m_visibleItems)
         releaseItem(item);
     m_visibleItems.clear();
-    m_lastInRowIndexPosition.clear();
+    m_rowBreaks.clear();
     m_firstVisibleIndex = -1;
     setImplicitHeightDirty();
 }
@@ -179,6 +205,17 @@ void HorizontalJournal::calculateImplicitHeight()
     }
 }
 
+qreal HorizontalJournal::averageHeightPerItem() const
+{
+    if (m_visibleItems.isEmpty())
+        return 0;
+
+    // Until a row is completed all the items we have are in the same row
+    const qreal itemsPerRow = m_rowBreaks.isEmpty() ? m_visibleItems.count()
+                                                    : (m_rowBreaks.last().lastIndex + 1.) / m_rowBreaks.count();
+    return (m_rowHeight + rowSpacing()) / itemsPerRow;
+}
+
 void HorizontalJournal::processModelRemoves(const QVector<QQmlChangeSet::Change> &removes)
 {
     Q_FOREACH(const QQmlChangeSet::Change remove, removes) {
@@ -189,7 +226,7 @@ void HorizontalJournal::processModelRemoves(const QVector<QQmlChangeSet::Change>
             const int lastIndex = m_firstVisibleIndex + m_visibleItems.count() - 1;
             if (indexToRemove == lastIndex) {
                 releaseItem(m_visibleItems.takeLast());
-                m_lastInRowIndexPosition.remove(indexToRemove);
+                truncateRowBreaks(indexToRemove);
             } else {
                 if (indexToRemove < lastIndex) {
                     qDebug() << "HorizontalJournal only supports removal from the end of the model, resetting instead";
@@ -216,7 +253,7 @@ void HorizontalJournal::doRelayout()
         int i = 0;
         const QList<QQuickItem*> allItems = m_visibleItems;
         m_visibleItems.clear();
-        m_lastInRowIndexPosition.clear();
+        m_rowBreaks.clear();
         Q_FOREACH(QQuickItem *item, allItems) {
             addItemToView(i, item);
             ++i;
@@ -226,7 +263,7 @@ void HorizontalJournal::doRelayout()
             releaseItem(item);
         }
         m_visibleItems.clear();
-        m_lastInRowIndexPosition.clear();
+        m_rowBreaks.clear();
         m_firstVisibleIndex = -1;
     }
 }
@@ -234,6 +271,6 @@ void HorizontalJournal::doRelayout()
 void HorizontalJournal::updateItemCulling(qreal visibleFromY, qreal visibleToY)
 {
     Q_FOREACH(QQuickItem *item, m_visibleItems) {
-        QQuickItemPrivate::get(item)->setCulled(item->y() + m_rowHeight <= visibleFromY || item->y() >= visibleToY);
+        setItemCulled(item, item->y() + m_rowHeight <= visibleFromY || item->y() >= visibleToY);
     }
 }
@@ -18,6 +18,7 @@
 #define HORIZONTALJOURNAL_H
 
 #include "abstractdashview.h"
+#include "dashviewlayouts.h"
 
  /** A horizontal journal is a view that creates delegates
    * based on a model and layouts them one after the other
@@ -50,13 +51,28 @@ private:
     void addItemToView(int modelIndex, QQuickItem *item) override;
     void cleanupExistingItems() override;
     void calculateImplicitHeight() override;
+    qreal averageHeightPerItem() const override;
     void doRelayout() override;
     void updateItemCulling(qreal visibleFromY, qreal visibleToY) override;
     void processModelRemoves(const QVector<QQmlChangeSet::Change> &removes) override;
 
+    struct RowBreak
+    {
+        int lastIndex; // Model index of the last item of the row
+        qreal lastX; // x of that item
+    };
+
+    HorizontalJournalLayout journalLayout() const;
+
+    int rowBreakAtOrAfter(int modelIndex) const;
+    bool isLastInRow(int modelIndex) const;
+    void addRowBreak(int modelIndex, qreal x);
+    void truncateRowBreaks(int fromModelIndex);
+
     int m_firstVisibleIndex;
     QList<QQuickItem*> m_visibleItems;
-    QMap<int, double> m_lastInRowIndexPosition;
+    // Sorted by lastIndex, one per row that has been completed, row n is m_rowBreaks[n]
+    QVector<RowBreak> m_rowBreaks;
     int m_rowHeight;
 };
 
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "itemheightindex.h"
+
+#include <QtGlobal>
+
+ItemHeightIndex::ItemHeightIndex()
+ : m_measuredHeight(0)
+ , m_measuredCount(0)
+{
+}
+
+void ItemHeightIndex::reset(int count)
+{
+    m_heights.fill(-1, qMax(0, count));
+    rebuild();
+}
+
+void ItemHeightIndex::insert(int index, int count)
+{
+    if (count <= 0 || index < 0 || index > m_heights.count())
+        return;
+
+    m_heights.insert(index, count, -1);
+    rebuild();
+}
+
+void ItemHeightIndex::remove(int index, int count)
+{
+    if (index < 0 || index >= m_heights.count())
+        return;
+
+    m_heights.remove(index, qMin(count, m_heights.count() - index));
+    rebuild();
+}
+
+int ItemHeightIndex::count() const
+{
+    return m_heights.count();
+}
+
+int ItemHeightIndex::measuredCount() const
+{
+    return m_measuredCount;
+}
+
+bool ItemHeightIndex::isMeasured(int index) const
+{
+    return index >= 0 && index < m_heights.count() && m_heights[index] >= 0;
+}
+
+void ItemHeightIndex::setHeight(int index, qreal height)
+{
+    if (index < 0 || index >= m_heights.count() || height < 0)
+        return;
+
+    const qreal oldHeight = m_heights[index];
+    if (oldHeight == height)
+        return;
+
+    const qreal heightDiff = height - qMax<qreal>(0, oldHeight);
+    const int measuredDiff = oldHeight < 0 ? 1 : 0;
+    m_heights[index] = height;
+    m_measuredHeight += heightDiff;
+    m_measuredCount += measuredDiff;
+
+    const int n = m_heights.count();
+    for (int i = index + 1; i <= n; i += i & -i) {
+        m_heightTree[i] += heightDiff;
+        m_measuredTree[i] += measuredDiff;
+    }
+}
+
+qreal ItemHeightIndex::height(int index) const
+{
+    if (index < 0 || index >= m_heights.count())
+        return 0;
+
+    return m_heights[index] >= 0 ? m_heights[index] : estimatedHeight();
+}
+
+qreal ItemHeightIndex::estimatedHeight() const
+{
+    return m_measuredCount > 0 ? m_measuredHeight / m_measuredCount : 0;
+}
+
+qreal ItemHeightIndex::position(int index) const
+{
+    index = qBound(0, index, m_heights.count());
+
+    qreal height = 0;
+    int measured = 0;
+    for (int i = index; i > 0; i -= i & -i) {
+        height += m_heightTree[i];
+        measured += m_measuredTree[i];
+    }
+    return height + (index - measured) * estimatedHeight();
+}
+
+qreal ItemHeightIndex::totalHeight() const
+{
+    return m_measuredHeight + (m_heights.count() - m_measuredCount) * estimatedHeight();
+}
+
+void ItemHeightIndex::rebuild()
+{
+    const int n = m_heights.count();
+    m_heightTree.fill(0, n + 1);
+    m_measuredTree.fill(0, n + 1);
+    m_measuredHeight = 0;
+    m_measuredCount = 0;
+
+    for (int i = 1; i <= n; ++i) {
+        const qreal height = m_heights[i - 1];
+        if (height >= 0) {
+            m_heightTree[i] += height;
+            m_measuredTree[i] += 1;
+            m_measuredHeight += height;
+            m_measuredCount++;
+        }
+        const int parent = i + (i & -i);
+        if (parent <= n) {
+            m_heightTree[parent] += m_heightTree[i];
+            m_measuredTree[parent] += m_measuredTree[i];
+        }
+    }
+}
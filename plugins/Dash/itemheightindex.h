@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ITEMHEIGHTINDEX_H
+#define ITEMHEIGHTINDEX_H
+
+#include <QVector>
+
+/**
+    Prefix sums of the heights of the items of a list
+
+    Items whose height has not been measured yet are accounted with
+    the average height of the measured ones. Measuring an item and
+    asking for a position are O(log n), inserting and removing
+    items is O(n).
+
+    Internally it is a pair of Fenwick trees, one with the measured heights
+    and one with the number of measured items, so that changing the
+    estimated height doesn't need touching the trees.
+*/
+class ItemHeightIndex
+{
+public:
+    ItemHeightIndex();
+
+    // Sets the index to count non measured items
+    void reset(int count);
+    void insert(int index, int count);
+    void remove(int index, int count);
+
+    int count() const;
+    int measuredCount() const;
+
+    bool isMeasured(int index) const;
+    void setHeight(int index, qreal height);
+
+    // Measured height, or estimated height if not measured
+    qreal height(int index) const;
+    qreal estimatedHeight() const;
+
+    // Sum of the heights of the items before index
+    qreal position(int index) const;
+    qreal totalHeight() const;
+
+private:
+    void rebuild();
+
+    QVector<qreal> m_heights; // -1 for non measured items
+    QVector<qreal> m_heightTree; // 1-based
+    QVector<int> m_measuredTree; // 1-based
+    qreal m_measuredHeight;
+    int m_measuredCount;
+};
+
+#endif
@@ -83,6 +83,15 @@
  * items of the list are visible, otherwise we just live with good enough
  * values that make the list scrollable
  *
+ * To estimate minYExtent and the content height we need the height of
+ * the items that are not created. By default we use the average height
+ * of m_visibleItems. If trackItemHeights is set m_heightIndex remembers
+ * the height of every item we have created, updated in createItem and
+ * itemGeometryChanged, and gives the size of the non created ranges in
+ * logarithmic time, so the estimation doesn't change each time items are
+ * created or released. It also gives the position positionAtIndex jumps to.
+ * m_heightIndex follows the model inserts and removes in onModelUpdated.
+ *
  * There are a few things that are not really implemented or tested properly
  * which we don't use at the moment like changing the model, changing
  * the section delegate, having a section delegate that changes its size, etc.
@@ -155,6 +164,7 @@ ListViewWithPageHeader::ListViewWithPageHeader()
  , m_inLayout(false)
  , m_inContentHeightKeepHeaderShown(false)
  , m_cacheBuffer(0)
+ , m_trackItemHeights(false)
 {
     m_clipItem = new QQuickItem(contentItem());
 //     m_clipItem = new QQuickRectangle(contentItem());
@@ -219,6 +229,8 @@ void ListViewWithPageHeader::setDelegate(QQmlComponent *delegate)
         m_visibleItems.clear();
         initializeValuesForEmptyList();
 
+        m_heightIndex.reset(0);
+
         m_delegateModel->setDelegate(delegate);
 
         Q_EMIT delegateChanged();
@@ -359,43 +371,81 @@ void ListViewWithPageHeader::setCacheBuffer(int cacheBuffer)
     }
 }
 
+bool ListViewWithPageHeader::trackItemHeights() const
+{
+    return m_trackItemHeights;
+}
+
+void ListViewWithPageHeader::setTrackItemHeights(bool trackItemHeights)
+{
+    if (trackItemHeights != m_trackItemHeights) {
+        m_trackItemHeights = trackItemHeights;
+        m_heightIndex.reset(0);
+        if (m_trackItemHeights) {
+            syncHeightIndex();
+        }
+        m_contentHeightDirty = true;
+        polish();
+        Q_EMIT trackItemHeightsChanged();
+    }
+}
+
 void ListViewWithPageHeader::positionAtBeginning()
 {
-    if (m_delegateModel->count() <= 0)
+    positionAtIndex(0);
+}
+
+void ListViewWithPageHeader::positionAtIndex(int modelIndex)
+{
+    if (modelIndex < 0 || modelIndex >= m_delegateModel->count())
         return;
 
-    qreal headerHeight = (m_headerItem ? m_headerItem->height() : 0);
-    if (m_firstVisibleIndex != 0) {
+    // Only the first item has the header above it
+    const qreal headerHeight = (m_headerItem ? m_headerItem->height() : 0);
+    const qreal topMargin = modelIndex == 0 ? headerHeight : 0;
+    ListItem *item = itemAtIndex(modelIndex);
+    if (!item) {
+        // Where the item would be if all the ones before it were created
+        const qreal itemPos = headerHeight + estimatedPosition(modelIndex);
+
         // TODO This could be optimized by trying to reuse the interesection
         // of items that may end up intersecting between the existing
         // m_visibleItems and the items we are creating in the next loop
-        Q_FOREACH(ListItem *item, m_visibleItems)
-            releaseItem(item);
+        Q_FOREACH(ListItem *visibleItem, m_visibleItems)
+            releaseItem(visibleItem);
         m_visibleItems.clear();
         m_firstVisibleIndex = -1;
 
-        // Create the item 0, it will be already correctly positioned at createItem()
+        // Create the item, item 0 will be already correctly positioned at createItem()
         m_clipItem->setY(0);
-        ListItem *item = createItem(0, false);
+        item = createItem(modelIndex, false);
+        if (!item)
+            return;
+        if (modelIndex != 0) {
+            item->setY(itemPos);
+            item->setCulled(false);
+            adjustMinYExtent();
+        }
         // Create the subsequent items
-        int modelIndex = 1;
+        int nextIndex = modelIndex + 1;
         qreal pos = item->y() + item->height();
-        const qreal bufferTo = height() + m_cacheBuffer;
-        while (modelIndex < m_delegateModel->count() && pos <= bufferTo) {
-            if (!(item = createItem(modelIndex, false)))
+        const qreal bufferTo = item->y() - topMargin + height() + m_cacheBuffer;
+        while (nextIndex < m_delegateModel->count() && pos <= bufferTo) {
+            ListItem *nextItem = createItem(nextIndex, false);
+            if (!nextItem)
                 break;
-            pos += item->height();
-            ++modelIndex;
+            pos += nextItem->height();
+            ++nextIndex;
         }
 
-        m_previousContentY = m_visibleItems.first()->y() - headerHeight;
+        m_previousContentY = item->y() - topMargin;
     }
-    setContentY(m_visibleItems.first()->y() + m_clipItem->y() - headerHeight);
+    setContentY(item->y() + m_clipItem->y() - topMargin);
     if (m_headerItem) {
         // TODO This should not be needed and the code that adjust the m_headerItem position
         // in viewportMoved() should be enough but in some cases we have not found a way to reproduce
         // yet the code of viewportMoved() fails so here we make sure that at least if we are calling
-        // positionAtBeginning the header item will be correctly positioned
+        // positionAtIndex the header item will be correctly positioned
         m_headerItem->setY(-m_minYExtent);
     }
 }
@@ -816,6 +866,9 @@ void ListViewWithPageHeader::updateSectionItem(int modelIndex)
                 item->setSectionItem(nullptr);
             }
         }
+        if (m_trackItemHeights) {
+            m_heightIndex.setHeight(modelIndex, item->height());
+        }
     }
 }
 
@@ -931,6 +984,9 @@ ListViewWithPageHeader::ListItem *ListViewWithPageHeader::createItem(int modelIn
             if (listItem->sectionItem()) {
                 listItem->sectionItem()->setProperty("delegate", QVariant::fromValue(listItem->m_item));
             }
+            if (m_trackItemHeights) {
+                m_heightIndex.setHeight(modelIndex, listItem->height());
+            }
             adjustMinYExtent();
             m_contentHeightDirty = true;
         }
@@ -987,14 +1043,21 @@ void ListViewWithPageHeader::onHeightChanged()
 }
 
 
-void ListViewWithPageHeader::onModelUpdated(const QQmlChangeSet &changeSet, bool /*reset*/)
+void ListViewWithPageHeader::onModelUpdated(const QQmlChangeSet &changeSet, bool reset)
 {
-    // TODO Do something with reset
+    // TODO Do something else with reset
 //     qDebug() << "ListViewWithPageHeader::onModelUpdated" << changeSet << reset;
     const auto oldFirstVisibleIndex = m_firstVisibleIndex;
 
+    if (reset) {
+        m_heightIndex.reset(0);
+    }
+
     Q_FOREACH(const QQmlChangeSet::Change remove, changeSet.removes()) {
 //         qDebug() << "ListViewWithPageHeader::onModelUpdated Remove" << remove.index << remove.count;
+        if (m_trackItemHeights) {
+            m_heightIndex.remove(remove.index, remove.count);
+        }
         if (remove.index + remove.count > m_firstVisibleIndex && remove.index < m_firstVisibleIndex + m_visibleItems.count()) {
             const qreal oldFirstValidIndexPos = m_visibleItems.first()->y();
             // If all the items we are removing are either not created or culled
@@ -1048,6 +1111,9 @@ void ListViewWithPageHeader::onModelUpdated(const QQmlChangeSet &changeSet, bool
 
     Q_FOREACH(const QQmlChangeSet::Change insert, changeSet.inserts()) {
 //         qDebug() << "ListViewWithPageHeader::onModelUpdated Insert" << insert.index << insert.count;
+        if (m_trackItemHeights) {
+            m_heightIndex.insert(insert.index, insert.count);
+        }
         const bool insertingInValidIndexes = insert.index > m_firstVisibleIndex && insert.index < m_firstVisibleIndex + m_visibleItems.count();
         const bool firstItemWithViewOnTop = insert.index == 0 && m_firstVisibleIndex == 0 && m_visibleItems.first()->y() + m_clipItem->y() > contentY();
         if (insertingInValidIndexes || firstItemWithViewOnTop)
@@ -1145,6 +1211,9 @@ void ListViewWithPageHeader::itemGeometryChanged(QQuickItem *item, const QRectF
 {
     const qreal heightDiff = newGeometry.height() - oldGeometry.height();
     if (heightDiff != 0) {
+        if (m_trackItemHeights) {
+            updateItemHeight(item);
+        }
         if (!m_visibleItems.isEmpty()) {
             ListItem *firstItem = m_visibleItems.first();
             const auto prevFirstItemY = firstItem->y();
@@ -1212,17 +1281,7 @@ void ListViewWithPageHeader::adjustMinYExtent()
     if (m_visibleItems.isEmpty() || (contentHeight() + m_minYExtent < height())) {
         m_minYExtent = 0;
     } else {
-        qreal nonCreatedHeight = 0;
-        if (m_firstVisibleIndex != 0) {
-            // Calculate the average height of items to estimate the position of the list start
-            const int visibleItems = m_visibleItems.count();
-            qreal visibleItemsHeight = 0;
-            Q_FOREACH(ListItem *item, m_visibleItems) {
-                visibleItemsHeight += item->height();
-            }
-            nonCreatedHeight = m_firstVisibleIndex * visibleItemsHeight / visibleItems;
-//             qDebug() << m_firstVisibleIndex << visibleItemsHeight << visibleItems << nonCreatedHeight;
-        }
+        const qreal nonCreatedHeight = nonCreatedHeightBefore();
         const qreal headerHeight = (m_headerItem ? m_headerItem->implicitHeight() : 0);
         m_minYExtent = nonCreatedHeight - m_visibleItems.first()->y() - m_clipItem->y() + headerHeight;
         if (m_minYExtent != 0 && qFuzzyIsNull(m_minYExtent)) {
@@ -1232,6 +1291,75 @@ void ListViewWithPageHeader::adjustMinYExtent()
     }
 }
 
+void ListViewWithPageHeader::syncHeightIndex()
+{
+    // If we missed some model change start again with the heights of the items we have
+    if (m_delegateModel && m_heightIndex.count() != m_delegateModel->count()) {
+        m_heightIndex.reset(m_delegateModel->count());
+        for (int i = 0; i < m_visibleItems.count(); ++i) {
+            m_heightIndex.setHeight(m_firstVisibleIndex + i, m_visibleItems[i]->height());
+        }
+    }
+}
+
+void ListViewWithPageHeader::updateItemHeight(QQuickItem *item)
+{
+    // item is either the delegate or the section item of one of m_visibleItems
+    for (int i = 0; i < m_visibleItems.count(); ++i) {
+        ListItem *listItem = m_visibleItems[i];
+        if (listItem->m_item == item || listItem->sectionItem() == item) {
+            m_heightIndex.setHeight(m_firstVisibleIndex + i, listItem->height());
+            return;
+        }
+    }
+}
+
+qreal ListViewWithPageHeader::estimatedPosition(int modelIndex) const
+{
+    if (modelIndex <= 0)
+        return 0;
+
+    if (m_trackItemHeights && m_heightIndex.count() == m_delegateModel->count()) {
+        return m_heightIndex.position(modelIndex);
+    }
+
+    if (m_visibleItems.isEmpty())
+        return 0;
+
+    // Calculate the average height of items to estimate the position
+    const int visibleItems = m_visibleItems.count();
+    qreal visibleItemsHeight = 0;
+    Q_FOREACH(ListItem *item, m_visibleItems) {
+        visibleItemsHeight += item->height();
+    }
+    return modelIndex * visibleItemsHeight / visibleItems;
+}
+
+qreal ListViewWithPageHeader::nonCreatedHeightBefore() const
+{
+    return estimatedPosition(m_firstVisibleIndex);
+}
+
+qreal ListViewWithPageHeader::nonCreatedHeightAfter() const
+{
+    const int modelCount = model()->rowCount();
+    const int firstNonCreatedIndex = m_firstVisibleIndex + m_visibleItems.count();
+    if (firstNonCreatedIndex >= modelCount)
+        return 0;
+
+    if (m_trackItemHeights && m_heightIndex.count() == modelCount) {
+        return m_heightIndex.totalHeight() - m_heightIndex.position(firstNonCreatedIndex);
+    }
+
+    const int visibleItems = m_visibleItems.count();
+    qreal visibleItemsHeight = 0;
+    Q_FOREACH(ListItem *item, m_visibleItems) {
+        visibleItemsHeight += item->height();
+    }
+    const int unknownSizes = modelCount - firstNonCreatedIndex;
+    return unknownSizes * visibleItemsHeight / visibleItems;
+}
+
 ListViewWithPageHeader::ListItem *ListViewWithPageHeader::itemAtIndex(int modelIndex) const
 {
     const int visibleIndexedModelIndex = modelIndex - m_firstVisibleIndex;
@@ -1247,6 +1375,9 @@ void ListViewWithPageHeader::layout()
         return;
 
     m_inLayout = true;
+    if (m_trackItemHeights) {
+        syncHeightIndex();
+    }
     if (!m_visibleItems.isEmpty()) {
         const qreal visibleFrom = contentY() - m_clipItem->y() + m_headerItemShownHeight;
         const qreal visibleTo = contentY() + height() - m_clipItem->y();
@@ -1362,19 +1493,7 @@ void ListViewWithPageHeader::updatePolish()
         if (m_visibleItems.isEmpty()) {
             contentHeight = m_headerItem ? m_headerItem->height() : 0;
         } else {
-            const int modelCount = model()->rowCount();
-            const int visibleItems = m_visibleItems.count();
-            const int lastValidIndex = m_firstVisibleIndex + visibleItems - 1;
-            qreal nonCreatedHeight = 0;
-            if (lastValidIndex != modelCount - 1) {
-                const int visibleItems = m_visibleItems.count();
-                qreal visibleItemsHeight = 0;
-                Q_FOREACH(ListItem *item, m_visibleItems) {
-                    visibleItemsHeight += item->height();
-                }
-                const int unknownSizes = modelCount - (m_firstVisibleIndex + visibleItems);
-                nonCreatedHeight = unknownSizes * visibleItemsHeight / visibleItems;
-            }
+            const qreal nonCreatedHeight = nonCreatedHeightAfter();
             ListItem *item = m_visibleItems.last();
             contentHeight = nonCreatedHeight + item->y() + item->height() + m_clipItem->y();
             if (m_firstVisibleIndex != 0) {
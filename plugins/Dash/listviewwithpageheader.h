@@ -20,6 +20,8 @@
 #include <private/qquickitemchangelistener_p.h>
 #include <private/qquickflickable_p.h>
 
+#include "itemheightindex.h"
+
 class QAbstractItemModel;
 class QQuickNumberAnimation;
 class QQmlChangeSet;
@@ -55,6 +57,7 @@ class ListViewWithPageHeader : public QQuickFlickable, public QQuickItemChangeLi
     Q_PROPERTY(int stickyHeaderHeight READ stickyHeaderHeight NOTIFY stickyHeaderHeightChanged)
     Q_PROPERTY(qreal headerItemShownHeight READ headerItemShownHeight NOTIFY headerItemShownHeightChanged)
     Q_PROPERTY(int cacheBuffer READ cacheBuffer WRITE setCacheBuffer NOTIFY cacheBufferChanged)
+    Q_PROPERTY(bool trackItemHeights READ trackItemHeights WRITE setTrackItemHeights NOTIFY trackItemHeightsChanged)
 
     friend class ListViewWithPageHeaderTest;
     friend class ListViewWithPageHeaderTestSection;
@@ -88,7 +91,11 @@ public:
     int cacheBuffer() const;
     void setCacheBuffer(int cacheBuffer);
 
+    bool trackItemHeights() const;
+    void setTrackItemHeights(bool trackItemHeights);
+
     Q_INVOKABLE void positionAtBeginning();
+    Q_INVOKABLE void positionAtIndex(int modelIndex);
     Q_INVOKABLE void showHeader();
     Q_INVOKABLE int firstCreatedIndex() const;
     Q_INVOKABLE int createdItemCount() const;
@@ -110,6 +117,7 @@ Q_SIGNALS:
     void stickyHeaderHeightChanged();
     void headerItemShownHeightChanged();
     void cacheBufferChanged();
+    void trackItemHeightsChanged();
 
 protected:
     void componentComplete() override;
@@ -170,6 +178,11 @@ private:
     QQuickItem *getSectionItem(const QString &sectionText, bool watchGeometry = true);
     void updateSectionItem(int modelIndex);
     void initializeValuesForEmptyList();
+    void syncHeightIndex();
+    void updateItemHeight(QQuickItem *item);
+    qreal estimatedPosition(int modelIndex) const;
+    qreal nonCreatedHeightBefore() const;
+    qreal nonCreatedHeightAfter() const;
 
     QQmlDelegateModel *m_delegateModel;
 
@@ -212,6 +225,11 @@ private:
     // Qt 5.0 doesn't like releasing the items just after itemCreated
     // so we delay the releasing until the next updatePolish
     QList<ListItem *> m_itemsToRelease;
+    // When m_trackItemHeights is set we remember the height of all the items we have
+    // created, the height of the non created ones is estimated from them.
+    // Otherwise the non created items are estimated with the average height of m_visibleItems
+    bool m_trackItemHeights;
+    ItemHeightIndex m_heightIndex;
 };
 
 
@@ -16,8 +16,6 @@
 
 #include "organicgrid.h"
 
-#include <math.h>
-
 #include <private/qquickitem_p.h>
 
 OrganicGrid::OrganicGrid()
@@ -60,44 +58,19 @@ void OrganicGrid::setBigDelegateSize(const QSizeF size)
     }
 }
 
-QPointF OrganicGrid::positionForIndex(int modelIndex) const
+OrganicGridLayout OrganicGrid::gridLayout() const
 {
-    const qreal moduleHeight = m_smallDelegateSize.height() + rowSpacing() + m_bigDelegateSize.height();
-    const qreal moduleWidth = m_smallDelegateSize.width() * 2 + columnSpacing() * 2 + m_bigDelegateSize.width();
-    const int itemsPerRow = m_numberOfModulesPerRow * 6;
-    const int rowIndex = floor(modelIndex / itemsPerRow);
-    const int columnIndex = floor((modelIndex - rowIndex * itemsPerRow) / 6);
-
-    qreal yPos = (moduleHeight + rowSpacing()) * rowIndex;
-    const int moduleIndex = modelIndex % 6;
-    if (moduleIndex == 2) {
-        yPos += m_smallDelegateSize.height() + rowSpacing();
-    } else if (moduleIndex == 3 || moduleIndex == 5) {
-        yPos += m_bigDelegateSize.height() + rowSpacing();
-    }
-
-    qreal xPos = (moduleWidth + columnSpacing()) * columnIndex;
-    if (moduleIndex == 1) {
-        xPos += m_smallDelegateSize.width() + columnSpacing();
-    } else if (moduleIndex == 3) {
-        xPos += m_bigDelegateSize.width() + columnSpacing();
-    } else if (moduleIndex == 4) {
-        xPos += (m_smallDelegateSize.width() + columnSpacing()) * 2;
-    } else if (moduleIndex == 5) {
-        xPos += m_bigDelegateSize.width() + m_smallDelegateSize.width() + columnSpacing() * 2;
-    }
+    return OrganicGridLayout(m_smallDelegateSize, m_bigDelegateSize, columnSpacing(), rowSpacing());
+}
 
-    return QPointF(xPos, yPos);
+QPointF OrganicGrid::positionForIndex(int modelIndex) const
+{
+    return gridLayout().position(modelIndex, m_numberOfModulesPerRow);
 }
 
 QSizeF OrganicGrid::sizeForIndex(int modelIndex) const
 {
-    const int moduleIndex = modelIndex % 6;
-    if (moduleIndex == 0 || moduleIndex == 1 || moduleIndex == 3 || moduleIndex == 5) {
-        return m_smallDelegateSize;
-    } else {
-        return m_bigDelegateSize;
-    }
+    return gridLayout().size(modelIndex);
 }
 
 void OrganicGrid::findBottomModelIndexToAdd(int *modelIndex, qreal *yPos)
@@ -196,9 +169,7 @@ void OrganicGrid::cleanupExistingItems()
 
 void OrganicGrid::doRelayout()
 {
-    const qreal moduleWidth = m_smallDelegateSize.width() * 2 + columnSpacing() * 2 + m_bigDelegateSize.width();
-    m_numberOfModulesPerRow = floor((width() + columnSpacing()) / (moduleWidth + columnSpacing()));
-    m_numberOfModulesPerRow = qMax(1, m_numberOfModulesPerRow);
+    m_numberOfModulesPerRow = gridLayout().modulesPerRow(width());
 
     int i = m_firstVisibleIndex;
     const QList<QQuickItem*> allItems = m_visibleItems;
@@ -212,26 +183,23 @@ void OrganicGrid::doRelayout()
 void OrganicGrid::updateItemCulling(qreal visibleFromY, qreal visibleToY)
 {
     Q_FOREACH(QQuickItem *item, m_visibleItems) {
-        QQuickItemPrivate::get(item)->setCulled(item->y() + item->height() <= visibleFromY || item->y() >= visibleToY);
+        setItemCulled(item, item->y() + item->height() <= visibleFromY || item->y() >= visibleToY);
     }
 }
 
 void OrganicGrid::calculateImplicitHeight()
 {
-    const qreal moduleHeight = m_smallDelegateSize.height() + rowSpacing() + m_bigDelegateSize.height();
     const int itemCount = !model() ? 0 : model()->rowCount();
-    const int itemsPerRow = m_numberOfModulesPerRow * 6;
-    const int fullRows = floor(itemCount / itemsPerRow);
-    const qreal fullRowsHeight = fullRows == 0 ? 0 : fullRows * moduleHeight + rowSpacing() * (fullRows - 1);
+    setImplicitHeight(gridLayout().height(itemCount, m_numberOfModulesPerRow));
+}
 
-    const int remainingItems = itemCount - fullRows * itemsPerRow;
-    if (remainingItems == 0) {
-        setImplicitHeight(fullRowsHeight);
-    } else if (remainingItems <= 2) {
-        setImplicitHeight(fullRowsHeight + m_smallDelegateSize.height() + rowSpacing());
-    } else {
-        setImplicitHeight(fullRowsHeight + rowSpacing() + moduleHeight);
-    }
+qreal OrganicGrid::averageHeightPerItem() const
+{
+    // Each row of modules has 6 items per module
+    const OrganicGridLayout layout = gridLayout();
+    const int modulesPerRow = layout.modulesPerRow(width());
+    const int itemsPerRow = 6 * modulesPerRow;
+    return (layout.height(itemsPerRow, modulesPerRow) + rowSpacing()) / itemsPerRow;
 }
 
 void OrganicGrid::processModelRemoves(const QVector<QQmlChangeSet::Change> &removes)
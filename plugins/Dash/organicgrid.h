@@ -18,6 +18,7 @@
 #define ORGANICGRID_H
 
 #include "abstractdashview.h"
+#include "dashviewlayouts.h"
 
  /** An Organic Grid is is a view that creates delegates
    * based on a model and layouts them in groups of six items (called module).
@@ -68,6 +69,7 @@ Q_SIGNALS:
     void smallDelegateSizeChanged();
     void bigDelegateSizeChanged();
 private:
+    OrganicGridLayout gridLayout() const;
     QPointF positionForIndex(int modelIndex) const;
     QSizeF sizeForIndex(int modelIndex) const;
 
@@ -79,6 +81,7 @@ private:
     void doRelayout() override;
     void updateItemCulling(qreal visibleFromY, qreal visibleToY) override;
     void calculateImplicitHeight() override;
+    qreal averageHeightPerItem() const override;
     void processModelRemoves(const QVector<QQmlChangeSet::Change> &removes) override;
 
     QSizeF m_smallDelegateSize;
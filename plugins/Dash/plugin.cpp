@@ -17,6 +17,8 @@
 
 #include "plugin.h"
 
+#include "cardcreator.h"
+#include "cardcreatorcache.h"
 #include "horizontaljournal.h"
 #include "listviewwithpageheader.h"
 #include "organicgrid.h"
@@ -56,6 +58,20 @@ static QObject *audio_comparer_singleton_provider(QQmlEngine *engine, QJSEngine
     return new AudioComparer();
 }
 
+static QObject *card_creator_singleton_provider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(scriptEngine)
+
+    return new CardCreator(engine);
+}
+
+static QObject *card_creator_cache_singleton_provider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(scriptEngine)
+
+    return new CardCreatorCache(engine);
+}
+
 void DashPlugin::registerTypes(const char *uri)
 {
     Q_ASSERT(uri == QLatin1String("Dash"));
@@ -65,6 +81,8 @@ void DashPlugin::registerTypes(const char *uri)
     qmlRegisterType<OrganicGrid>(uri, 0, 1, "OrganicGrid");
     qmlRegisterType<VerticalJournal>(uri, 0, 1, "VerticalJournal");
     qmlRegisterSingletonType<AudioComparer>(uri, 0, 1, "AudioUrlComparer", audio_comparer_singleton_provider);
+    qmlRegisterSingletonType<CardCreator>(uri, 0, 1, "CardCreator", card_creator_singleton_provider);
+    qmlRegisterSingletonType<CardCreatorCache>(uri, 0, 1, "CardCreatorCache", card_creator_cache_singleton_provider);
 }
 
 #include "plugin.moc"
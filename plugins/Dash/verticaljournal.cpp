@@ -18,19 +18,29 @@
  * The implementation is centered around m_columnVisibleItems
  * that holds a vector of lists. There's a list for each of the
  * columns the view has. In the list the items of the column are
- * ordered as they appear topdown in the view. m_indexColumnMap is
+ * ordered as they appear topdown in the view. m_layout is
  * used when re-building the list up since given a position
  * in the middle of the list and the need to create the previous does
  * not give us enough information to know in which column we have
  * to position the item so that when we reach the item the view is
- * correctly layouted at 0 for all the columns
+ * correctly layouted at 0 for all the columns. For each model index
+ * it stores the column it went to, its y and height and the previous
+ * index in that column, so that finding the item to add on top of a column
+ * is a direct lookup and an index that was already laid out goes back to
+ * the same place.
+ *
+ * Since items are always appended to the shortest column the y of the
+ * entries of m_layout grows with the model index, so when all the items
+ * have gone out of the buffer (i.e. the view was moved far away) we can
+ * binary search m_layout for the index to start creating items from
+ * instead of starting again from index 0.
  */
 #include "verticaljournal.h"
 
-#include <math.h>
-
 #include <private/qquickitem_p.h>
 
+#include <algorithm>
+
 VerticalJournal::VerticalJournal()
  : m_columnWidth(0)
 {
@@ -58,20 +68,69 @@ void VerticalJournal::setColumnWidth(qreal columnWidth)
     }
 }
 
+VerticalJournalLayout VerticalJournal::journalLayout() const
+{
+    return VerticalJournalLayout(m_columnWidth, columnSpacing(), rowSpacing());
+}
+
+void VerticalJournal::truncateLayout(int fromModelIndex)
+{
+    if (fromModelIndex >= m_layout.count())
+        return;
+
+    // Walk each column up to the first index that stays
+    for (int i = 0; i < m_columnLastIndex.count(); ++i) {
+        while (m_columnLastIndex[i] >= fromModelIndex) {
+            m_columnLastIndex[i] = m_layout[m_columnLastIndex[i]].previousInColumn;
+        }
+    }
+    m_layout.resize(fromModelIndex);
+}
+
+int VerticalJournal::seekModelIndex(qreal y) const
+{
+    // The last index laid out at or above y
+    const auto it = std::upper_bound(m_layout.constBegin(), m_layout.constEnd(), y,
+                                     [](qreal y, const LayoutEntry &entry) { return y < entry.y; });
+    int modelIndex = qMax(0, static_cast<int>(it - m_layout.constBegin()) - 1);
+
+    // Items of the other columns that started above it may still reach y, go back
+    // until we have the last item of every column
+    QVector<bool> columnFound(m_columnVisibleItems.count(), false);
+    int columnsToFind = columnFound.count();
+    for (int i = modelIndex; i >= 0 && columnsToFind > 0; --i) {
+        const int column = m_layout[i].column;
+        if (!columnFound[column]) {
+            columnFound[column] = true;
+            --columnsToFind;
+            modelIndex = i;
+        }
+    }
+    return modelIndex;
+}
+
 void VerticalJournal::findBottomModelIndexToAdd(int *modelIndex, qreal *yPos)
 {
     *modelIndex = 0;
     *yPos = std::numeric_limits<qreal>::max();
 
+    bool allColumnsEmpty = true;
     Q_FOREACH(const auto &column, m_columnVisibleItems) {
         if (!column.isEmpty()) {
             const ViewItem &item = column.last();
             *yPos = qMin(*yPos, item.y() + item.height() + rowSpacing());
             *modelIndex = qMax(*modelIndex, item.m_modelIndex + 1);
+            allColumnsEmpty = false;
         } else {
             *yPos = 0;
         }
     }
+
+    if (allColumnsEmpty && !m_layout.isEmpty()) {
+        // Start again where the visible area begins
+        *modelIndex = seekModelIndex(-displayMarginBeginning());
+        *yPos = m_layout[*modelIndex].y;
+    }
 }
 
 void VerticalJournal::findTopModelIndexToAdd(int *modelIndex, qreal *yPos)
@@ -95,15 +154,11 @@ void VerticalJournal::findTopModelIndexToAdd(int *modelIndex, qreal *yPos)
     }
 
     if (*modelIndex > 0) {
-        Q_ASSERT(m_indexColumnMap.contains(*modelIndex));
-        while (*modelIndex > 0 && m_indexColumnMap[*modelIndex] != columnToAddTo) {
-            // We found out that we have to add to columnToAddTo
-            // and thought that we had to add *modelIndex, but history tells
-            // it is not correct, so find up from *modelIndex until we found the index
-            // that has to end up in columnToAddTo
-            *modelIndex = *modelIndex - 1;
-            Q_ASSERT(m_indexColumnMap.contains(*modelIndex));
-        }
+        // We found out that we have to add to columnToAddTo, history
+        // tells which index was laid out just above its first item
+        const int firstColumnIndex = m_columnVisibleItems[columnToAddTo].first().m_modelIndex;
+        Q_ASSERT(firstColumnIndex < m_layout.count());
+        *modelIndex = m_layout[firstColumnIndex].previousInColumn;
     }
 }
 
@@ -134,36 +189,58 @@ void VerticalJournal::addItemToView(int modelIndex, QQuickItem *item)
         item->setWidth(m_columnWidth);
     }
 
-    // Check if we add it to the bottom of existing column items
-    const QList<ViewItem> &firstColumn = m_columnVisibleItems[0];
-    qreal columnToAddY = !firstColumn.isEmpty() ? firstColumn.last().y() + firstColumn.last().height() : -rowSpacing();
-    int columnToAddTo = 0;
-    for (int i = 1; i < m_columnVisibleItems.count(); ++i) {
-        const QList<ViewItem> &column = m_columnVisibleItems[i];
-        const qreal iY = !column.isEmpty() ? column.last().y() + column.last().height() : -rowSpacing();
-        if (iY < columnToAddY) {
-            columnToAddTo = i;
-            columnToAddY = iY;
+    const VerticalJournalLayout layout = journalLayout();
+
+    if (modelIndex < m_layout.count()) {
+        LayoutEntry &entry = m_layout[modelIndex];
+        const int column = entry.column;
+        QList<ViewItem> &columnItems = m_columnVisibleItems[column];
+        if (!columnItems.isEmpty() && columnItems.first().m_modelIndex > modelIndex) {
+            item->setX(layout.columnX(column));
+            item->setY(layout.prependY(columnItems.first().y(), item->height()));
+            entry.y = item->y();
+            entry.height = item->height();
+
+            columnItems.prepend(ViewItem(item, modelIndex));
+            return;
         }
-    }
 
-    const QList<ViewItem> &columnToAdd = m_columnVisibleItems[columnToAddTo];
-    if (columnToAdd.isEmpty() || columnToAdd.last().m_modelIndex < modelIndex) {
-        item->setX(columnToAddTo * (m_columnWidth + columnSpacing()));
-        item->setY(columnToAddY + rowSpacing());
+        if (entry.height == static_cast<float>(item->height())) {
+            // Put it back where it was laid out
+            item->setX(layout.columnX(column));
+            item->setY(entry.y);
 
-        m_columnVisibleItems[columnToAddTo] << ViewItem(item, modelIndex);
-        m_indexColumnMap[modelIndex] = columnToAddTo;
-    } else {
-        Q_ASSERT(m_indexColumnMap.contains(modelIndex));
-        columnToAddTo = m_indexColumnMap[modelIndex];
-        columnToAddY = m_columnVisibleItems[columnToAddTo].first().y();
+            columnItems << ViewItem(item, modelIndex);
+            return;
+        }
 
-        item->setX(columnToAddTo * (m_columnWidth + columnSpacing()));
-        item->setY(columnToAddY - rowSpacing() - item->height());
+        // It has changed size, what was laid out after it is no longer valid
+        truncateLayout(modelIndex);
+    }
 
-        m_columnVisibleItems[columnToAddTo].prepend(ViewItem(item, modelIndex));
+    // Indexes are laid out in order so m_layout only grows by one. Append it
+    // to the column that is shortest taking into account the items that are
+    // no longer created
+    QVector<qreal> columnBottoms(m_columnLastIndex.count());
+    for (int i = 0; i < m_columnLastIndex.count(); ++i) {
+        const int lastIndex = m_columnLastIndex[i];
+        columnBottoms[i] = lastIndex != -1 ? m_layout[lastIndex].y + m_layout[lastIndex].height : -rowSpacing();
     }
+    const int columnToAddTo = layout.columnToAppend(columnBottoms);
+
+    item->setX(layout.columnX(columnToAddTo));
+    item->setY(layout.appendY(columnBottoms[columnToAddTo]));
+
+    Q_ASSERT(modelIndex == m_layout.count());
+    m_layout.resize(modelIndex + 1);
+    LayoutEntry &entry = m_layout[modelIndex];
+    entry.y = item->y();
+    entry.height = item->height();
+    entry.previousInColumn = m_columnLastIndex[columnToAddTo];
+    entry.column = columnToAddTo;
+    m_columnLastIndex[columnToAddTo] = modelIndex;
+
+    m_columnVisibleItems[columnToAddTo] << ViewItem(item, modelIndex);
 }
 
 void VerticalJournal::cleanupExistingItems()
@@ -175,7 +252,8 @@ void VerticalJournal::cleanupExistingItems()
             releaseItem(item.m_item);
         column.clear();
     }
-    m_indexColumnMap.clear();
+    m_layout.clear();
+    m_columnLastIndex.fill(-1);
     setImplicitHeightDirty();
 }
 
@@ -198,6 +276,23 @@ void VerticalJournal::calculateImplicitHeight()
     }
 }
 
+qreal VerticalJournal::averageHeightPerItem() const
+{
+    int itemCount = 0;
+    qreal itemsHeight = 0;
+    Q_FOREACH(const auto &column, m_columnVisibleItems) {
+        Q_FOREACH(const ViewItem &item, column) {
+            itemsHeight += item.height() + rowSpacing();
+            ++itemCount;
+        }
+    }
+    if (itemCount == 0)
+        return 0;
+
+    // Each of the columns grows with one of every m_columnVisibleItems.count() items
+    return itemsHeight / itemCount / m_columnVisibleItems.count();
+}
+
 void VerticalJournal::doRelayout()
 {
     QList<ViewItem> allItems;
@@ -206,9 +301,10 @@ void VerticalJournal::doRelayout()
 
     qSort(allItems);
 
-    const int nColumns = qMax(1., floor((double)(width() + columnSpacing()) / (m_columnWidth + columnSpacing())));
+    const int nColumns = journalLayout().columnCount(width());
     m_columnVisibleItems.resize(nColumns);
-    m_indexColumnMap.clear();
+    m_layout.clear();
+    m_columnLastIndex.fill(-1, nColumns);
     for (int i = 0; i < nColumns; ++i)
         m_columnVisibleItems[i].clear();
 
@@ -231,7 +327,7 @@ void VerticalJournal::updateItemCulling(qreal visibleFromY, qreal visibleToY)
     Q_FOREACH(const auto &column, m_columnVisibleItems) {
         Q_FOREACH(const ViewItem item, column) {
             const bool cull = item.y() + item.height() <= visibleFromY || item.y() >= visibleToY;
-            QQuickItemPrivate::get(item.m_item)->setCulled(cull);
+            setItemCulled(item.m_item, cull);
         }
     }
 }
@@ -258,6 +354,7 @@ void VerticalJournal::processModelRemoves(const QVector<QQmlChangeSet::Change> &
                     lastCreatedIndex = qMax(lastCreatedIndex, lastColumnIndex);
                 }
             }
+            truncateLayout(indexToRemove);
             if (!found) {
                 if (indexToRemove < lastCreatedIndex) {
                     qDebug() << "VerticalJournal only supports removal from the end of the model, resetting instead";
@@ -18,6 +18,7 @@
 #define VERTICALJOURNAL_H
 
 #include "abstractdashview.h"
+#include "dashviewlayouts.h"
 
  /** A vertical journal is a view that creates delegates
    * based on a model and layouts them in columns following
@@ -85,18 +86,36 @@ private:
             int m_modelIndex;
     };
 
+    // Where a model index was laid out, kept small since there is one per laid out index
+    struct LayoutEntry
+    {
+        float y = 0;
+        float height = 0;
+        qint32 previousInColumn = -1; // The model index above it in the same column
+        quint16 column = 0;
+    };
+
+    VerticalJournalLayout journalLayout() const;
+
+    void truncateLayout(int fromModelIndex);
+    int seekModelIndex(qreal y) const;
+
     void findBottomModelIndexToAdd(int *modelIndex, qreal *yPos) override;
     void findTopModelIndexToAdd(int *modelIndex, qreal *yPos) override;
     bool removeNonVisibleItems(qreal bufferFromY, qreal bufferToY) override;
     void addItemToView(int modelIndex, QQuickItem *item) override;
     void cleanupExistingItems() override;
     void calculateImplicitHeight() override;
+    qreal averageHeightPerItem() const override;
     void doRelayout() override;
     void updateItemCulling(qreal visibleFromY, qreal visibleToY) override;
     void processModelRemoves(const QVector<QQmlChangeSet::Change> &removes) override;
 
     QVector<QList<ViewItem>> m_columnVisibleItems;
-    QHash<int, int> m_indexColumnMap;
+    // Indexed by model index, contains all the indexes laid out since the last relayout
+    QVector<LayoutEntry> m_layout;
+    // For each column the last model index of m_layout in it, -1 if none
+    QVector<qint32> m_columnLastIndex;
     int m_columnWidth;
 };
 
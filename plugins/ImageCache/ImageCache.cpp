@@ -17,15 +17,72 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QDirIterator>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QThread>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QtConcurrent>
+
+#include <algorithm>
 
 #include "ImageCache.h"
+#include "ImageScaler.h"
+#include "RawImage.h"
+
+// Enough for the launcher icons and a few screens of dash art
+static const qint64 kMemoryCacheBytes = 32 * 1024 * 1024;
+
+// Disk quota defaults, UNITY8_IMAGECACHE_MAX_MB and UNITY8_IMAGECACHE_MAX_ENTRIES
+// override them
+static const int kDiskCacheMegabytes = 100;
+static const int kDiskCacheEntries = 5000;
+
+// Going over the quota evicts down to this much of it, so that the next
+// images cached don't go over it again right away
+static const int kEvictToPercent = 90;
+
+// Files not in the index are only removed once they are this old, so the
+// ones being written right now are left alone
+static const int kOrphanGraceSecs = 60 * 60;
+
+// Never 0, a quota of one entry keeps it
+static qint64 evictionTarget(qint64 quota)
+{
+    return quota - quota * (100 - kEvictToPercent) / 100;
+}
+
+static int environmentLimit(const char *name, int defaultValue)
+{
+    bool ok;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
 
 ImageCache::ImageCache()
   : QQuickImageProvider(QQmlImageProviderBase::Image,
                         QQmlImageProviderBase::ForceAsynchronousImageLoading)
+  , m_memoryCache(kMemoryCacheBytes)
+  , m_index(imageCacheRoot() + QStringLiteral("/index"))
+  , m_rawFormat(qgetenv("UNITY8_IMAGECACHE_FORMAT") == "raw")
+  , m_maxDiskBytes(qint64(environmentLimit("UNITY8_IMAGECACHE_MAX_MB", kDiskCacheMegabytes)) * 1024 * 1024)
+  , m_maxDiskEntries(environmentLimit("UNITY8_IMAGECACHE_MAX_ENTRIES", kDiskCacheEntries))
+  , m_compactionListener(nullptr)
+{
+    m_compactionPool.setMaxThreadCount(1);
+    m_prewarmPool.setMaxThreadCount(1);
+
+    // Also removes what was left behind by an older index
+    compact();
+}
+
+ImageCache::~ImageCache()
 {
+    m_stopping.store(1);
+    m_prewarmPool.clear();
+    m_prewarmPool.waitForDone();
+    m_compactionPool.waitForDone();
 }
 
 QString ImageCache::imageCacheRoot()
@@ -38,35 +95,53 @@ QString ImageCache::imageCacheRoot()
     return QDir::cleanPath(xdgCache) + QStringLiteral("/unity8/imagecache");
 }
 
-QFileInfo ImageCache::imagePath(const QUrl &image)
+static QString variantSuffix(const QSize &size)
+{
+    return QStringLiteral("@%1x%2").arg(size.width()).arg(size.height());
+}
+
+QString ImageCache::cacheKey(const QUrl &image)
 {
     QUrlQuery query(image);
 
     auto name = query.queryItemValue(QStringLiteral("name"));
     if (name.isEmpty()) {
-        name = QStringLiteral("/paths") + image.toLocalFile();
+        return QStringLiteral("/paths") + image.toLocalFile();
     } else {
-        name = QStringLiteral("/names/") + name;
+        return QStringLiteral("/names/") + name;
     }
+}
 
-    return QFileInfo(imageCacheRoot() + name);
+QFileInfo ImageCache::imagePath(const QUrl &image, const QSize &size)
+{
+    return variantFile(cacheKey(image), size);
 }
 
-bool ImageCache::needsUpdate(const QUrl &image, const QFileInfo &cachePath, const QSize &imageSize, const QSize &requestedSize, QSize &finalSize)
+QFileInfo ImageCache::variantFile(const QString &key, const QSize &size)
 {
-    if (!cachePath.exists())
-        return true;
+    return QFileInfo(imageCacheRoot() + key + variantSuffix(size));
+}
 
-    QFileInfo imageInfo(image.toLocalFile());
-    if (imageInfo.lastModified() > cachePath.lastModified())
-        return true;
+// The smallest variant that can be scaled down to size keeping its aspect
+// ratio, or an invalid size if there is none
+QSize ImageCache::nearestLargerSize(const QVector<ImageCacheIndex::Variant> &variants, const QSize &size)
+{
+    QSize bestSize;
+    Q_FOREACH(const ImageCacheIndex::Variant &variant, variants) {
+        const QSize &variantSize = variant.size;
+        if (variantSize.width() <= size.width() || variantSize.height() <= size.height())
+            continue;
 
-    QSize cacheSize(QImageReader(cachePath.filePath()).size());
-    finalSize = calculateSize(imageSize, requestedSize);
-    if (finalSize.isValid() && cacheSize != finalSize)
-        return true;
+        // Allow for the rounding of the sizes, anything else is a different crop
+        const qint64 aspectError = qAbs(qint64(variantSize.width()) * size.height() - qint64(variantSize.height()) * size.width());
+        if (aspectError > qMax(variantSize.width(), variantSize.height()))
+            continue;
 
-    return false;
+        if (!bestSize.isValid() || qint64(variantSize.width()) * variantSize.height() < qint64(bestSize.width()) * bestSize.height()) {
+            bestSize = variantSize;
+        }
+    }
+    return bestSize;
 }
 
 QSize ImageCache::calculateSize(const QSize &imageSize, const QSize &requestedSize)
@@ -82,30 +157,147 @@ QSize ImageCache::calculateSize(const QSize &imageSize, const QSize &requestedSi
     return finalSize;
 }
 
-QImage ImageCache::loadAndCacheImage(QImageReader &reader, const QFileInfo &cachePath, const QSize &finalSize)
+QImage ImageCache::loadAndCacheImage(QImageReader &reader, const QFileInfo &cachePath, const QSize &finalSize, QByteArray *format) const
 {
     reader.setQuality(100);
-    reader.setScaledSize(finalSize);
-    auto format = reader.format(); // can't get this after reading
+    *format = reader.format(); // can't get this after reading
 
-    QImage loadedImage(reader.read());
+    QImage loadedImage(ImageScaler::read(reader, finalSize));
     if (loadedImage.isNull()) {
         qWarning() << "ImageCache could not read image" << reader.fileName() << ":" << reader.errorString();
         return QImage();
     }
 
-    cachePath.dir().mkpath(QStringLiteral("."));
-    loadedImage.save(cachePath.filePath(), format, 100);
+    cacheImage(loadedImage, cachePath, format);
 
     return loadedImage;
 }
 
+void ImageCache::cacheImage(const QImage &image, const QFileInfo &cachePath, QByteArray *format) const
+{
+    cachePath.dir().mkpath(QStringLiteral("."));
+
+    if (m_rawFormat) {
+        *format = RawImage::formatName();
+        RawImage::write(image, cachePath.filePath());
+    } else {
+        // When scaled from a raw variant the format of the source is not known
+        if (format->isEmpty() || *format == RawImage::formatName()) {
+            *format = QByteArrayLiteral("png");
+        }
+        // Written aside and renamed into place, so readers never see part of it
+        QSaveFile file(cachePath.filePath());
+        if (file.open(QIODevice::WriteOnly)) {
+            QImageWriter writer(&file, *format);
+            writer.setQuality(100);
+            if (writer.write(image)) {
+                file.commit();
+            }
+        }
+    }
+}
+
+// Cached images can be in the raw format or the one of their source. The
+// index knows which, except for files from before there was an index.
+QImage ImageCache::readCachedImage(const QString &path, const QByteArray &indexedFormat, QByteArray *format)
+{
+    if (indexedFormat == RawImage::formatName()) {
+        *format = indexedFormat;
+        return RawImage::read(path);
+    } else if (!indexedFormat.isEmpty()) {
+        // Still looks at the content if it isn't in that format after all
+        QImageReader reader(path, indexedFormat);
+        *format = indexedFormat;
+        return reader.read();
+    }
+
+    QImage image = RawImage::read(path);
+    if (!image.isNull()) {
+        *format = RawImage::formatName();
+        return image;
+    }
+
+    QImageReader reader(path);
+    *format = reader.format();
+    return reader.read();
+}
+
 QImage ImageCache::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
     QUrl image(id);
-    QImageReader imageReader(image.toLocalFile());
-    QSize imageSize(imageReader.size());
-    QImage result;
+    const QString sourcePath = image.toLocalFile();
+    const QDateTime sourceModified = QFileInfo(sourcePath).lastModified();
+    const ImageMemoryCache::Key key{sourcePath, requestedSize, sourceModified};
+
+    QMutexLocker locker(&m_pendingMutex);
+
+    // Requests for an image that is already being loaded wait for it
+    // instead of decoding and writing the same file again
+    QSharedPointer<PendingImage> pending = m_pending.value(key);
+    if (pending) {
+        while (!pending->done) {
+            m_pendingDone.wait(&m_pendingMutex);
+        }
+        *size = pending->image.size();
+        return pending->image;
+    }
+
+    QImage result = m_memoryCache.find(key);
+    if (result.isNull()) {
+        pending = QSharedPointer<PendingImage>::create();
+        m_pending.insert(key, pending);
+        locker.unlock();
+
+        result = loadImage(image, sourceModified, requestedSize);
+        m_memoryCache.insert(key, result);
+
+        // Only now, so later requests either wait or find it in memory
+        locker.relock();
+        pending->image = result;
+        pending->done = true;
+        m_pending.remove(key);
+        m_pendingDone.wakeAll();
+    }
+
+    *size = result.size();
+    return result;
+}
+
+void ImageCache::prewarm(const QString &id, const QSize &requestedSize)
+{
+    // One at a time, and a request of the UI coming in meanwhile waits for
+    // it instead of loading the image again, so it is not idle priority
+    QtConcurrent::run(&m_prewarmPool, [this, id, requestedSize]() {
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+        if (m_stopping.load())
+            return;
+
+        QSize size;
+        requestImage(id, &size, requestedSize);
+    });
+}
+
+ImageMemoryCache::Stats ImageCache::memoryCacheStats() const
+{
+    return m_memoryCache.stats();
+}
+
+QImage ImageCache::loadImage(const QUrl &image, const QDateTime &sourceModified, const QSize &requestedSize)
+{
+    const QString sourcePath = image.toLocalFile();
+    const QString key = cacheKey(image);
+    QImageReader imageReader(sourcePath);
+
+    // An up to date index entry saves parsing the header of the source.
+    // What is not in the index is not in the cache directory either.
+    ImageCacheIndex::Entry entry;
+    const bool found = sourceModified.isValid() && m_index.find(key, &entry);
+    // Put in the index by the compaction, from before there was one
+    const bool migrated = found && entry.sourcePath.isEmpty();
+    const bool indexed = found && !migrated
+                         && entry.sourcePath == sourcePath
+                         && entry.sourceModified == sourceModified;
+    QSize imageSize(indexed ? entry.sourceSize : imageReader.size());
 
     // Early exit here, with no sourceSize, scaled-up sourceSize, or bad source image
     if ((requestedSize.width() <= 0 && requestedSize.height() <= 0) ||
@@ -113,23 +305,212 @@ QImage ImageCache::requestImage(const QString &id, QSize *size, const QSize &req
         requestedSize.height() >= imageSize.height() ||
         requestedSize.width() >= imageSize.width()) {
         // We're only interested in scaling down, not up.
-        result = imageReader.read();
-        *size = result.size();
-        return result;
+        return imageReader.read();
+    }
+
+    if (!indexed) {
+        QVector<ImageCacheIndex::Variant> variants;
+        if (migrated && entry.sourceModified >= sourceModified) {
+            variants = entry.variants;
+        }
+        entry = ImageCacheIndex::Entry{ sourcePath, sourceModified, imageSize, variants };
     }
 
-    auto cachePath = imagePath(image);
-    QSize finalSize;
+    const QSize finalSize = calculateSize(imageSize, requestedSize);
+    const QFileInfo cachePath = imagePath(image, finalSize);
 
-    if (needsUpdate(image, cachePath, imageSize, requestedSize, finalSize)) {
-        if (finalSize.isEmpty()) {
-            finalSize = calculateSize(imageSize, requestedSize);
+    if (const ImageCacheIndex::Variant *cached = entry.findVariant(finalSize)) {
+        QByteArray format;
+        const QImage cachedImage = readCachedImage(cachePath.filePath(), cached->format, &format);
+        if (!cachedImage.isNull()) {
+            // The format is recorded once it is known
+            if (indexed && format == cached->format) {
+                m_index.touch(key);
+            } else {
+                entry.setVariant({ finalSize, format, QFileInfo(cachePath.filePath()).size() });
+                addToIndex(key, entry);
+            }
+            return cachedImage;
         }
-        result = loadAndCacheImage(imageReader, cachePath, finalSize);
-    } else {
-        result = QImage(cachePath.filePath());
     }
 
-    *size = result.size();
+    QImage result;
+    QByteArray format;
+
+    // Scaling down a bigger variant is cheaper than decoding the original
+    const QSize variantSize = nearestLargerSize(entry.variants, finalSize);
+    if (variantSize.isValid()) {
+        const ImageCacheIndex::Variant larger = *entry.findVariant(variantSize);
+        const QImage variant = readCachedImage(imagePath(image, variantSize).filePath(), larger.format, &format);
+        if (!variant.isNull()) {
+            entry.setVariant({ variantSize, format, larger.bytes });
+            result = ImageScaler::scaled(variant, finalSize);
+            cacheImage(result, cachePath, &format);
+        }
+    }
+    if (result.isNull()) {
+        result = loadAndCacheImage(imageReader, cachePath, finalSize, &format);
+    }
+
+    if (!result.isNull()) {
+        entry.setVariant({ finalSize, format, QFileInfo(cachePath.filePath()).size() });
+        addToIndex(key, entry);
+    }
     return result;
 }
+
+void ImageCache::addToIndex(const QString &key, ImageCacheIndex::Entry entry)
+{
+    entry.lastAccess = QDateTime::currentDateTimeUtc();
+    m_index.insert(key, entry);
+
+    if (m_index.count() > m_maxDiskEntries || m_index.bytes() > m_maxDiskBytes) {
+        scheduleCompaction(false);
+    }
+}
+
+ImageCache::DiskStats ImageCache::diskCacheStats()
+{
+    DiskStats stats;
+    stats.bytes = m_index.bytes();
+    stats.count = m_index.count();
+    stats.maxBytes = m_maxDiskBytes;
+    stats.maxCount = m_maxDiskEntries;
+    stats.evictions = m_evictions.load();
+    stats.compactions = m_compactions.load();
+    return stats;
+}
+
+void ImageCache::setCompactionListener(QObject *listener)
+{
+    QMutexLocker locker(&m_listenerMutex);
+    m_compactionListener = listener;
+}
+
+void ImageCache::compact()
+{
+    scheduleCompaction(true);
+}
+
+void ImageCache::scheduleCompaction(bool sweep)
+{
+    if (sweep) {
+        m_sweepScheduled.store(1);
+    }
+
+    // Requests while one is queued are served by that one
+    if (!m_compactionScheduled.testAndSetOrdered(0, 1))
+        return;
+
+    QtConcurrent::run(&m_compactionPool, [this]() {
+        QThread::currentThread()->setPriority(QThread::IdlePriority);
+        m_compactionScheduled.store(0);
+        runCompaction(m_sweepScheduled.testAndSetOrdered(1, 0));
+
+        QMutexLocker locker(&m_listenerMutex);
+        if (m_compactionListener) {
+            QMetaObject::invokeMethod(m_compactionListener, "compactionFinished", Qt::QueuedConnection);
+        }
+    });
+}
+
+// Runs on the compaction thread
+void ImageCache::runCompaction(bool sweep)
+{
+    if (sweep) {
+        sweepCacheDirectory();
+    }
+
+    // Over the quota: the least recently used entries go first
+    const auto evicted = m_index.evict(evictionTarget(m_maxDiskBytes), int(evictionTarget(m_maxDiskEntries)));
+    const QString root = imageCacheRoot();
+    for (auto it = evicted.constBegin(); it != evicted.constEnd() && !m_stopping.load(); ++it) {
+        Q_FOREACH(const ImageCacheIndex::Variant &variant, it->second.variants) {
+            QFile::remove(variantFile(it->first, variant.size).filePath());
+        }
+
+        // And the directories that are empty now, up to /paths or /names
+        const QString top = root + it->first.left(it->first.indexOf(QLatin1Char('/'), 1));
+        QDir directory = QFileInfo(root + it->first).dir();
+        while (directory.path().length() > top.length() && QDir().rmdir(directory.path())) {
+            directory.cdUp();
+        }
+    }
+    m_evictions.fetchAndAddOrdered(evicted.count());
+
+    m_compactions.fetchAndAddOrdered(1);
+}
+
+// Runs on the compaction thread
+void ImageCache::sweepCacheDirectory()
+{
+    const QDateTime started = QDateTime::currentDateTimeUtc();
+
+    // Files the index doesn't know about: cached before there was an index,
+    // from an older index, of failed writes, or evicted while they were
+    // being written
+    const QString root = imageCacheRoot();
+    const QDateTime orphanedBefore = started.addSecs(-kOrphanGraceSecs);
+    QStringList directories;
+    QHash<QString, ImageCacheIndex::Entry> migrated;
+    Q_FOREACH(const QString &top, QStringList() << QStringLiteral("/paths") << QStringLiteral("/names")) {
+        QDirIterator it(root + top, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext() && !m_stopping.load()) {
+            const QString path = it.next();
+            const QFileInfo info = it.fileInfo();
+            if (info.isDir()) {
+                directories << path;
+                continue;
+            }
+
+            const QString relativePath = path.mid(root.length());
+            const int at = relativePath.lastIndexOf(QLatin1Char('@'));
+            const QStringList dimensions = relativePath.mid(at + 1).split(QLatin1Char('x'));
+            bool widthOk = false, heightOk = false;
+            if (at > 0 && dimensions.count() == 2) {
+                const QString key = relativePath.left(at);
+                const QSize size(dimensions[0].toInt(&widthOk), dimensions[1].toInt(&heightOk));
+                if (widthOk && heightOk && m_index.contains(key, size))
+                    continue;
+
+                // The variants of a key the index doesn't have are taken in,
+                // the source is only known once it is requested. They are up
+                // to date if the source is older than the oldest of them.
+                ImageCacheIndex::Entry indexed;
+                if (widthOk && heightOk && (migrated.contains(key) || !m_index.find(key, &indexed))) {
+                    const QDateTime modified = info.lastModified().toUTC();
+                    ImageCacheIndex::Entry &entry = migrated[key];
+                    entry.variants.append({ size, QByteArray(), info.size() });
+                    if (!entry.sourceModified.isValid() || modified < entry.sourceModified) {
+                        entry.sourceModified = modified;
+                    }
+                    if (!entry.lastAccess.isValid() || modified > entry.lastAccess) {
+                        entry.lastAccess = modified;
+                    }
+                    continue;
+                }
+            }
+
+            if (info.lastModified() < orphanedBefore) {
+                QFile::remove(path);
+            }
+        }
+    }
+
+    // Unless the key was cached meanwhile
+    for (auto it = migrated.constBegin(); it != migrated.constEnd() && !m_stopping.load(); ++it) {
+        ImageCacheIndex::Entry indexed;
+        if (!m_index.find(it.key(), &indexed)) {
+            m_index.insert(it.key(), it.value());
+        }
+    }
+
+    // Deepest first, only empty ones can be removed
+    std::sort(directories.begin(), directories.end(), [](const QString &a, const QString &b) {
+        return a.length() > b.length();
+    });
+    Q_FOREACH(const QString &directory, directories) {
+        QDir().rmdir(directory);
+    }
+}
@@ -17,9 +17,17 @@
 #pragma once
 
 #include <QFileInfo>
+#include <QHash>
 #include <QImageReader>
+#include <QMutex>
 #include <QQuickImageProvider>
+#include <QSharedPointer>
 #include <QSize>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "ImageCacheIndex.h"
+#include "ImageMemoryCache.h"
 
 /**
  * This class accepts an id formulated like a URL. So you'd use something like:
@@ -33,21 +41,104 @@
  * ?name=NAME
  *   - This will use NAME as the cache lookup key instead of the provided URL.
  *
- * We don't do any cleaning of old cached files yet.  So you may want to always
- * provide a name to avoid leaving lots of files around.
+ * Every size an image is requested at is cached as its own variant, named
+ * after the lookup key plus "@WIDTHxHEIGHT". A size that is not cached yet
+ * is scaled down from the nearest larger variant, if there is one, instead
+ * of decoding the original again. Scaling down is done by ImageScaler.
+ *
+ * The cache directory is kept within a quota of bytes and of entries, by
+ * default 100 MB and 5000 entries, which UNITY8_IMAGECACHE_MAX_MB and
+ * UNITY8_IMAGECACHE_MAX_ENTRIES in the environment override. When it goes
+ * over, the least recently used entries are removed on a background thread
+ * of idle priority, down to 90% of the quota so that the next images don't
+ * go over it again. This compaction also runs on startup, when it first
+ * goes through the cache directory: files cached before there was an index
+ * are put in it and other files the index doesn't know about are removed.
+ * Anything else not in the index is not looked for on disk.
+ *
+ * Cached images are written in the format of their source, or in the raw
+ * format of RawImage, which needs no decoding, when UNITY8_IMAGECACHE_FORMAT
+ * is set to "raw" in the environment.
+ *
+ * What is cached is recorded in an index file in the cache directory, so an
+ * up to date image is found without looking at the file system.
+ *
+ * Decoded images are also kept in memory, up to a fixed budget, so images
+ * requested again are not read from disk. Requests for an image that is
+ * being loaded by another thread wait for that load and share its result.
  */
 
 class ImageCache: public QQuickImageProvider
 {
 public:
+    struct DiskStats {
+        qint64 bytes = 0;
+        int count = 0;
+        qint64 maxBytes = 0;
+        int maxCount = 0;
+        int evictions = 0;
+        int compactions = 0;
+    };
+
     ImageCache();
+    ~ImageCache();
 
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
 
+    // Loads the image on a background thread, as requestImage() would, so
+    // the request for it finds it in memory
+    void prewarm(const QString &id, const QSize &requestedSize);
+
+    ImageMemoryCache::Stats memoryCacheStats() const;
+    DiskStats diskCacheStats();
+
+    // Schedules a compaction of the cache directory, which also removes
+    // the files the index doesn't know about
+    void compact();
+    // listener's compactionFinished() slot is invoked after each compaction
+    void setCompactionListener(QObject *listener);
+
 private:
+    struct PendingImage {
+        bool done = false;
+        QImage image;
+    };
+
+    QImage loadImage(const QUrl &image, const QDateTime &sourceModified, const QSize &requestedSize);
+
     static QString imageCacheRoot();
-    static QFileInfo imagePath(const QUrl &image);
-    static bool needsUpdate(const QUrl &image, const QFileInfo &cachePath, const QSize &imageSize, const QSize &requestedSize, QSize &finalSize);
+    static QString cacheKey(const QUrl &image);
+    static QFileInfo imagePath(const QUrl &image, const QSize &size);
+    static QFileInfo variantFile(const QString &key, const QSize &size);
+    static QSize nearestLargerSize(const QVector<ImageCacheIndex::Variant> &variants, const QSize &size);
     static QSize calculateSize(const QSize &imageSize, const QSize &requestedSize);
-    static QImage loadAndCacheImage(QImageReader &reader, const QFileInfo &cachePath, const QSize &finalSize);
+    static QImage readCachedImage(const QString &path, const QByteArray &indexedFormat, QByteArray *format);
+    QImage loadAndCacheImage(QImageReader &reader, const QFileInfo &cachePath, const QSize &finalSize, QByteArray *format) const;
+    void cacheImage(const QImage &image, const QFileInfo &cachePath, QByteArray *format) const;
+    void addToIndex(const QString &key, ImageCacheIndex::Entry entry);
+    void scheduleCompaction(bool sweep);
+    void runCompaction(bool sweep);
+    void sweepCacheDirectory();
+
+    ImageMemoryCache m_memoryCache;
+    ImageCacheIndex m_index;
+    bool m_rawFormat;
+
+    QMutex m_pendingMutex;
+    QWaitCondition m_pendingDone;
+    QHash<ImageMemoryCache::Key, QSharedPointer<PendingImage>> m_pending;
+
+    const qint64 m_maxDiskBytes;
+    const int m_maxDiskEntries;
+    QAtomicInt m_compactionScheduled;
+    QAtomicInt m_sweepScheduled;
+    QAtomicInt m_stopping;
+    QAtomicInt m_evictions;
+    QAtomicInt m_compactions;
+    QMutex m_listenerMutex;
+    QObject *m_compactionListener;
+
+    // Last, so they are done before anything their jobs use goes away
+    QThreadPool m_compactionPool;
+    QThreadPool m_prewarmPool;
 };
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImageCacheIndex.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+
+static const quint32 kIndexMagic = 0x55494349; // "UICI"
+// Bump when the layout of the file changes, older files are then ignored
+static const quint32 kIndexVersion = 2;
+// Minimum time between writes of the index file
+static const qint64 kSaveIntervalMs = 5000;
+
+QDataStream &operator<<(QDataStream &stream, const ImageCacheIndex::Variant &variant)
+{
+    return stream << variant.size << variant.format << variant.bytes;
+}
+
+QDataStream &operator>>(QDataStream &stream, ImageCacheIndex::Variant &variant)
+{
+    return stream >> variant.size >> variant.format >> variant.bytes;
+}
+
+QDataStream &operator<<(QDataStream &stream, const ImageCacheIndex::Entry &entry)
+{
+    return stream << entry.sourcePath << entry.sourceModified << entry.sourceSize << entry.variants << entry.lastAccess;
+}
+
+QDataStream &operator>>(QDataStream &stream, ImageCacheIndex::Entry &entry)
+{
+    return stream >> entry.sourcePath >> entry.sourceModified >> entry.sourceSize >> entry.variants >> entry.lastAccess;
+}
+
+qint64 ImageCacheIndex::Entry::bytes() const
+{
+    qint64 total = 0;
+    Q_FOREACH(const Variant &variant, variants) {
+        total += variant.bytes;
+    }
+    return total;
+}
+
+bool ImageCacheIndex::Entry::hasVariant(const QSize &size) const
+{
+    return findVariant(size) != nullptr;
+}
+
+const ImageCacheIndex::Variant *ImageCacheIndex::Entry::findVariant(const QSize &size) const
+{
+    for (int i = 0; i < variants.count(); ++i) {
+        if (variants[i].size == size)
+            return &variants[i];
+    }
+    return nullptr;
+}
+
+void ImageCacheIndex::Entry::setVariant(const Variant &variant)
+{
+    for (int i = 0; i < variants.count(); ++i) {
+        if (variants[i].size == variant.size) {
+            variants[i] = variant;
+            return;
+        }
+    }
+    variants.append(variant);
+}
+
+ImageCacheIndex::ImageCacheIndex(const QString &filePath)
+  : m_filePath(filePath)
+  , m_loaded(false)
+  , m_dirty(false)
+{
+}
+
+ImageCacheIndex::~ImageCacheIndex()
+{
+    // Keep the changes and uses recorded since the last write
+    if (m_dirty) {
+        save();
+    }
+}
+
+bool ImageCacheIndex::find(const QString &key, Entry *entry)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd())
+        return false;
+
+    *entry = it.value();
+    return true;
+}
+
+void ImageCacheIndex::insert(const QString &key, const Entry &entry)
+{
+    bool saveNow;
+    {
+        QMutexLocker locker(&m_mutex);
+        load();
+        auto it = m_entries.insert(key, entry);
+        if (!it->lastAccess.isValid()) {
+            it->lastAccess = QDateTime::currentDateTimeUtc();
+        }
+        m_dirty = true;
+        saveNow = isSaveDue();
+    }
+    if (saveNow) {
+        save();
+    }
+}
+
+void ImageCacheIndex::remove(const QString &key)
+{
+    bool saveNow;
+    {
+        QMutexLocker locker(&m_mutex);
+        load();
+        if (m_entries.remove(key) == 0)
+            return;
+        m_dirty = true;
+        saveNow = isSaveDue();
+    }
+    if (saveNow) {
+        save();
+    }
+}
+
+void ImageCacheIndex::touch(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->lastAccess = QDateTime::currentDateTimeUtc();
+        m_dirty = true;
+    }
+}
+
+int ImageCacheIndex::count()
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+    return m_entries.count();
+}
+
+qint64 ImageCacheIndex::bytes()
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    qint64 total = 0;
+    Q_FOREACH(const Entry &entry, m_entries) {
+        total += entry.bytes();
+    }
+    return total;
+}
+
+bool ImageCacheIndex::contains(const QString &key, const QSize &size)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    auto it = m_entries.constFind(key);
+    return it != m_entries.constEnd() && it->hasVariant(size);
+}
+
+QVector<QPair<QString, ImageCacheIndex::Entry>> ImageCacheIndex::evict(qint64 maxBytes, int maxEntries)
+{
+    QVector<QPair<QString, Entry>> evicted;
+    {
+        QMutexLocker locker(&m_mutex);
+        load();
+
+        QVector<QPair<QString, Entry>> entries;
+        entries.reserve(m_entries.count());
+        qint64 totalBytes = 0;
+        for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+            entries.append(qMakePair(it.key(), it.value()));
+            totalBytes += it->bytes();
+        }
+
+        std::sort(entries.begin(), entries.end(),
+                  [](const QPair<QString, Entry> &a, const QPair<QString, Entry> &b) {
+                      return a.second.lastAccess < b.second.lastAccess;
+                  });
+
+        int count = entries.count();
+        for (int i = 0; i < entries.count() && (totalBytes > maxBytes || count > maxEntries); ++i) {
+            m_entries.remove(entries[i].first);
+            totalBytes -= entries[i].second.bytes();
+            --count;
+            evicted.append(entries[i]);
+        }
+
+        if (evicted.isEmpty() && !m_dirty)
+            return evicted;
+    }
+    save();
+    return evicted;
+}
+
+QString ImageCacheIndex::filePath() const
+{
+    return m_filePath;
+}
+
+// Called with m_mutex locked
+void ImageCacheIndex::load()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic, version;
+    stream >> magic >> version;
+    if (magic != kIndexMagic || version != kIndexVersion)
+        return;
+
+    QHash<QString, Entry> entries;
+    stream >> entries;
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "ImageCache ignoring broken index" << m_filePath;
+        return;
+    }
+    m_entries = entries;
+}
+
+// Called with m_mutex locked
+bool ImageCacheIndex::isSaveDue() const
+{
+    return !m_lastSave.isValid() || m_lastSave.hasExpired(kSaveIntervalMs);
+}
+
+void ImageCacheIndex::save()
+{
+    QMutexLocker saveLocker(&m_saveMutex);
+
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_6);
+        stream << kIndexMagic << kIndexVersion << m_entries;
+        m_dirty = false;
+        m_lastSave.start();
+    }
+
+    QFileInfo(m_filePath).dir().mkpath(QStringLiteral("."));
+    // QSaveFile writes to a temporary file and renames it over the index
+    // so readers never see a partial index
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "ImageCache could not write index" << m_filePath << ":" << file.errorString();
+    }
+}
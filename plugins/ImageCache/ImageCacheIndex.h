@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+/**
+ * What is in the image cache directory, so that checking whether a cached
+ * image is valid is a hash lookup instead of file system calls.
+ *
+ * Entries are keyed by the cache lookup key of the source ("/paths/..." or
+ * "/names/...") and record the source path, modification time and size plus
+ * the cached size variants, the format they were written in and their size
+ * on disk. Every entry also records when it was last used, which decides
+ * what goes first when the cache is over its quota. Entries of files cached
+ * before there was an index have no source path, and the time the oldest
+ * of their variants was written as the source modification time.
+ *
+ * The index is loaded from its file on first use and written back, with a
+ * rename over the old file, when it changes, at most once every few seconds
+ * so that filling the cache doesn't rewrite the whole index for each image.
+ * Changes in between, and recorded uses, are written with the next change
+ * after that, by the next evict() and when the index is destroyed. It is
+ * only a hint: a missing or broken index file means an empty index.
+ *
+ * All methods are thread-safe.
+ */
+
+class ImageCacheIndex
+{
+public:
+    struct Variant {
+        QSize size;
+        QByteArray format;
+        qint64 bytes;
+    };
+
+    struct Entry {
+        QString sourcePath;
+        QDateTime sourceModified;
+        QSize sourceSize;
+        QVector<Variant> variants;
+        QDateTime lastAccess;
+
+        qint64 bytes() const;
+        bool hasVariant(const QSize &size) const;
+        // nullptr if there is none of that size
+        const Variant *findVariant(const QSize &size) const;
+        // Replaces the variant of the same size, if any
+        void setVariant(const Variant &variant);
+    };
+
+    explicit ImageCacheIndex(const QString &filePath);
+    ~ImageCacheIndex();
+
+    bool find(const QString &key, Entry *entry);
+    void insert(const QString &key, const Entry &entry);
+    void remove(const QString &key);
+    // Records that the entry was used now
+    void touch(const QString &key);
+
+    int count();
+    qint64 bytes();
+    bool contains(const QString &key, const QSize &size);
+
+    // Removes the least recently used entries until there are at most
+    // maxEntries and they take at most maxBytes, returns what was removed
+    QVector<QPair<QString, Entry>> evict(qint64 maxBytes, int maxEntries);
+
+    QString filePath() const;
+
+private:
+    void load();
+    bool isSaveDue() const;
+    void save();
+
+    const QString m_filePath;
+    QMutex m_mutex;
+    // Keeps the writes of the file in the order of the changes
+    QMutex m_saveMutex;
+    bool m_loaded;
+    bool m_dirty;
+    // Since the file was last written
+    QElapsedTimer m_lastSave;
+    QHash<QString, Entry> m_entries;
+};
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImageCachePrewarmer.h"
+#include "ImageCache.h"
+
+ImageCachePrewarmer::ImageCachePrewarmer(ImageCache *imageCache, QObject *parent)
+  : QObject(parent)
+  , m_imageCache(imageCache)
+{
+}
+
+void ImageCachePrewarmer::prewarm(const QUrl &source, const QSize &sourceSize)
+{
+    if (source.scheme() != QLatin1String("image") || source.host() != QLatin1String("unity8imagecache"))
+        return;
+
+    // The id the engine gives the image provider for source
+    m_imageCache->prewarm(source.toString(QUrl::RemoveScheme | QUrl::RemoveAuthority).mid(1), sourceSize);
+}
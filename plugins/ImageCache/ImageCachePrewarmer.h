@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QSize>
+#include <QUrl>
+
+class ImageCache;
+
+/**
+ * Loads images into the image cache ahead of the items that show them,
+ * available to QML as the ImageCachePrewarmer singleton.
+ *
+ * ImageCachePrewarmer.prewarm("image://unity8imagecache/file:///...", Qt.size(0, 1920))
+ *
+ * takes the source and the sourceSize the Image will be given. The image
+ * is loaded on a background thread, one at a time, and the Image finds it
+ * in memory or waits for the load already under way.
+ */
+
+class ImageCachePrewarmer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageCachePrewarmer(ImageCache *imageCache, QObject *parent = nullptr);
+
+    // Sources not from the image cache are ignored
+    Q_INVOKABLE void prewarm(const QUrl &source, const QSize &sourceSize);
+
+private:
+    ImageCache *m_imageCache;
+};
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImageCacheStats.h"
+
+#include <QDBusConnection>
+
+class ImageCacheStatsInterface : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.canonical.Unity.ImageCache")
+
+public:
+    explicit ImageCacheStatsInterface(ImageCacheStats *parent);
+
+    Q_SCRIPTABLE QVariantMap GetStats();
+    Q_SCRIPTABLE void Compact();
+};
+
+ImageCacheStatsInterface::ImageCacheStatsInterface(ImageCacheStats *parent)
+  : QObject(parent)
+{
+}
+
+QVariantMap ImageCacheStatsInterface::GetStats()
+{
+    ImageCacheStats *stats = static_cast<ImageCacheStats *>(parent());
+    stats->refresh();
+    return stats->toMap();
+}
+
+void ImageCacheStatsInterface::Compact()
+{
+    static_cast<ImageCacheStats *>(parent())->compact();
+}
+
+ImageCacheStats::ImageCacheStats(ImageCache *imageCache, QObject *parent)
+  : QObject(parent)
+  , m_imageCache(imageCache)
+{
+    m_imageCache->setCompactionListener(this);
+    refresh();
+
+    // Fails when there is no session bus, as in the tests, the stats are
+    // still there for QML
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/com/canonical/Unity/ImageCache"),
+                                                 new ImageCacheStatsInterface(this),
+                                                 QDBusConnection::ExportScriptableContents);
+}
+
+ImageCacheStats::~ImageCacheStats()
+{
+    m_imageCache->setCompactionListener(nullptr);
+}
+
+qreal ImageCacheStats::memoryHits() const
+{
+    return m_memoryStats.hits;
+}
+
+qreal ImageCacheStats::memoryMisses() const
+{
+    return m_memoryStats.misses;
+}
+
+int ImageCacheStats::memoryCount() const
+{
+    return m_memoryStats.count;
+}
+
+qreal ImageCacheStats::memoryBytes() const
+{
+    return m_memoryStats.bytes;
+}
+
+int ImageCacheStats::diskCount() const
+{
+    return m_diskStats.count;
+}
+
+qreal ImageCacheStats::diskBytes() const
+{
+    return m_diskStats.bytes;
+}
+
+int ImageCacheStats::diskMaxCount() const
+{
+    return m_diskStats.maxCount;
+}
+
+qreal ImageCacheStats::diskMaxBytes() const
+{
+    return m_diskStats.maxBytes;
+}
+
+int ImageCacheStats::evictions() const
+{
+    return m_diskStats.evictions;
+}
+
+int ImageCacheStats::compactions() const
+{
+    return m_diskStats.compactions;
+}
+
+QVariantMap ImageCacheStats::toMap() const
+{
+    QVariantMap map;
+    map.insert(QStringLiteral("memoryHits"), m_memoryStats.hits);
+    map.insert(QStringLiteral("memoryMisses"), m_memoryStats.misses);
+    map.insert(QStringLiteral("memoryCount"), m_memoryStats.count);
+    map.insert(QStringLiteral("memoryBytes"), m_memoryStats.bytes);
+    map.insert(QStringLiteral("diskCount"), m_diskStats.count);
+    map.insert(QStringLiteral("diskBytes"), m_diskStats.bytes);
+    map.insert(QStringLiteral("diskMaxCount"), m_diskStats.maxCount);
+    map.insert(QStringLiteral("diskMaxBytes"), m_diskStats.maxBytes);
+    map.insert(QStringLiteral("evictions"), m_diskStats.evictions);
+    map.insert(QStringLiteral("compactions"), m_diskStats.compactions);
+    return map;
+}
+
+void ImageCacheStats::refresh()
+{
+    m_memoryStats = m_imageCache->memoryCacheStats();
+    m_diskStats = m_imageCache->diskCacheStats();
+    Q_EMIT changed();
+}
+
+void ImageCacheStats::compact()
+{
+    m_imageCache->compact();
+}
+
+void ImageCacheStats::compactionFinished()
+{
+    refresh();
+}
+
+#include "ImageCacheStats.moc"
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QVariantMap>
+
+#include "ImageCache.h"
+
+/**
+ * The counters of the image cache, for QML as the ImageCacheStats singleton
+ * and on the session bus at /com/canonical/Unity/ImageCache.
+ *
+ * The values are a snapshot, taken on creation, by refresh() and after
+ * every compaction of the disk cache.
+ */
+
+class ImageCacheStats : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(qreal memoryHits READ memoryHits NOTIFY changed)
+    Q_PROPERTY(qreal memoryMisses READ memoryMisses NOTIFY changed)
+    Q_PROPERTY(int memoryCount READ memoryCount NOTIFY changed)
+    Q_PROPERTY(qreal memoryBytes READ memoryBytes NOTIFY changed)
+    Q_PROPERTY(int diskCount READ diskCount NOTIFY changed)
+    Q_PROPERTY(qreal diskBytes READ diskBytes NOTIFY changed)
+    Q_PROPERTY(int diskMaxCount READ diskMaxCount NOTIFY changed)
+    Q_PROPERTY(qreal diskMaxBytes READ diskMaxBytes NOTIFY changed)
+    Q_PROPERTY(int evictions READ evictions NOTIFY changed)
+    Q_PROPERTY(int compactions READ compactions NOTIFY changed)
+
+public:
+    explicit ImageCacheStats(ImageCache *imageCache, QObject *parent = nullptr);
+    ~ImageCacheStats();
+
+    // Byte counts and hit counts are qreal, QML has no 64 bit integers
+    qreal memoryHits() const;
+    qreal memoryMisses() const;
+    int memoryCount() const;
+    qreal memoryBytes() const;
+    int diskCount() const;
+    qreal diskBytes() const;
+    int diskMaxCount() const;
+    qreal diskMaxBytes() const;
+    int evictions() const;
+    int compactions() const;
+
+    QVariantMap toMap() const;
+
+public Q_SLOTS:
+    void refresh();
+    // Asynchronous, the values change when it is done
+    void compact();
+
+Q_SIGNALS:
+    void changed();
+
+private Q_SLOTS:
+    void compactionFinished();
+
+private:
+    ImageCache *m_imageCache;
+    ImageMemoryCache::Stats m_memoryStats;
+    ImageCache::DiskStats m_diskStats;
+};
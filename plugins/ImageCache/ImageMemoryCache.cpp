@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImageMemoryCache.h"
+
+#include <limits>
+
+ImageMemoryCache::ImageMemoryCache(qint64 maxBytes)
+  : m_images(qMax<qint64>(0, qMin<qint64>(maxBytes, std::numeric_limits<int>::max())))
+{
+    m_stats.maxBytes = m_images.maxCost();
+}
+
+QImage ImageMemoryCache::find(const Key &key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // object() also moves the entry to the front of the LRU
+    const QImage *image = m_images.object(key);
+    if (!image) {
+        ++m_stats.misses;
+        return QImage();
+    }
+
+    ++m_stats.hits;
+    return *image;
+}
+
+void ImageMemoryCache::insert(const Key &key, const QImage &image)
+{
+    if (image.isNull())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    const int countBefore = m_images.count() - (m_images.contains(key) ? 1 : 0);
+    // Images bigger than the whole budget are not kept, QCache deletes them
+    if (m_images.insert(key, new QImage(image), image.byteCount())) {
+        m_stats.evictions += countBefore + 1 - m_images.count();
+    }
+}
+
+ImageMemoryCache::Stats ImageMemoryCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    Stats stats = m_stats;
+    stats.count = m_images.count();
+    stats.bytes = m_images.totalCost();
+    return stats;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+/**
+ * In-memory LRU of decoded images, in front of the disk cache.
+ *
+ * Entries are keyed by the source path, the requested size and the
+ * modification time of the source, so an updated source is a miss and its
+ * old entries just age out. The cache holds at most maxBytes of image data,
+ * least recently used images are evicted first.
+ *
+ * It is used from the image loading threads, all methods are thread-safe.
+ */
+
+class ImageMemoryCache
+{
+public:
+    struct Key {
+        QString path;
+        QSize size;
+        QDateTime lastModified;
+
+        bool operator==(const Key &other) const {
+            return path == other.path && size == other.size && lastModified == other.lastModified;
+        }
+
+        friend uint qHash(const Key &key, uint seed = 0) {
+            seed = qHash(key.lastModified, seed);
+            seed = qHash(key.size.width(), seed);
+            seed = qHash(key.size.height(), seed);
+            return qHash(key.path, seed);
+        }
+    };
+
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+        int count = 0;
+        qint64 bytes = 0;
+        qint64 maxBytes = 0;
+    };
+
+    explicit ImageMemoryCache(qint64 maxBytes);
+
+    // Returns a null image on a miss
+    QImage find(const Key &key);
+    void insert(const Key &key, const QImage &image);
+
+    Stats stats() const;
+
+private:
+    mutable QMutex m_mutex;
+    QCache<Key, QImage> m_images;
+    Stats m_stats;
+};
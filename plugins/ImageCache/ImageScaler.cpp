@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImageScaler.h"
+
+#include <QVector>
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGESCALER_NEON
+#endif
+
+/*
+ * The area average is done in two passes. Every source row is first
+ * reduced horizontally to the destination width, as 8.8 fixed point
+ * channels, and then the reduced rows are summed up with their vertical
+ * weights.
+ *
+ * Weights are in 1/32768 of a destination pixel and the ones of a
+ * destination pixel add up to exactly 32768. As the image shrinks no
+ * source pixel covers a whole destination pixel, so every weight fits in
+ * a signed 16 bit integer, and a destination channel sums to at most
+ * 255 << 23, which fits in 32 bits.
+ */
+
+namespace {
+
+const int kWeightBits = 15;
+
+struct Span {
+    int first;
+    int count;
+    int weightOffset;
+};
+
+// Which source pixels make up each destination pixel, and by how much
+void computeSpans(int sourceLength, int length, QVector<Span> *spans, QVector<quint16> *weights)
+{
+    // Where the edge of source pixel i falls, in destination pixels
+    auto edge = [=](int i) { return (qint64(i) * length << kWeightBits) / sourceLength; };
+
+    spans->resize(length);
+    weights->clear();
+    weights->reserve(sourceLength + length);
+    for (int x = 0; x < length; ++x) {
+        const qint64 start = qint64(x) << kWeightBits;
+        const qint64 end = qint64(x + 1) << kWeightBits;
+
+        Span &span = (*spans)[x];
+        span.first = qint64(x) * sourceLength / length;
+        span.count = 0;
+        span.weightOffset = weights->count();
+        for (int i = span.first; i < sourceLength; ++i) {
+            const qint64 weight = qMin(edge(i + 1), end) - qMax(edge(i), start);
+            if (weight <= 0) {
+                if (span.count > 0)
+                    break;
+                ++span.first;
+                continue;
+            }
+            weights->append(quint16(weight));
+            ++span.count;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+
+// The weights of two pixels, repeated for the pairs of channels madd takes
+inline __m128i weightPair(quint16 first, quint16 second)
+{
+    return _mm_set1_epi32(int(quint32(second) << 16 | first));
+}
+
+// The channels of the two pixels in the low 8 bytes of pixels, as 16 bit
+// lanes with the same channel of both next to each other
+inline __m128i interleave(__m128i pixels, __m128i zero)
+{
+    return _mm_unpacklo_epi8(_mm_unpacklo_epi8(pixels, _mm_srli_epi64(pixels, 32)), zero);
+}
+
+void reduceRow(const uchar *source, const Span *spans, const quint16 *weights, int width, quint16 *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    for (int x = 0; x < width; ++x) {
+        const uchar *pixels = source + spans[x].first * 4;
+        const quint16 *w = weights + spans[x].weightOffset;
+        const int count = spans[x].count;
+
+        __m128i sum = zero;
+        int i = 0;
+        // Four pixels at a time, reordered as 0 2 1 3 so the low and high
+        // halves interleave to the pairs 0 1 and 2 3
+        for (; i + 3 < count; i += 4) {
+            __m128i quad = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i * 4));
+            quad = _mm_shuffle_epi32(quad, _MM_SHUFFLE(3, 1, 2, 0));
+            quad = _mm_unpacklo_epi8(quad, _mm_srli_si128(quad, 8));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(quad, zero), weightPair(w[i], w[i + 1])));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(quad, zero), weightPair(w[i + 2], w[i + 3])));
+        }
+        for (; i + 1 < count; i += 2) {
+            const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(pixels + i * 4));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(interleave(pair, zero), weightPair(w[i], w[i + 1])));
+        }
+        if (i < count) {
+            int pixel;
+            memcpy(&pixel, pixels + i * 4, 4);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(interleave(_mm_cvtsi32_si128(pixel), zero), weightPair(w[i], 0)));
+        }
+
+        // Round to 8.8 and keep the low half of each lane
+        sum = _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << (kWeightBits - 9))), kWeightBits - 8);
+        sum = _mm_shufflelo_epi16(sum, _MM_SHUFFLE(3, 1, 2, 0));
+        sum = _mm_shufflehi_epi16(sum, _MM_SHUFFLE(3, 1, 2, 0));
+        sum = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + x * 4), sum);
+    }
+}
+
+void accumulateRow(quint32 *sums, const quint16 *row, quint16 weight, int count)
+{
+    const __m128i w = _mm_set1_epi16(weight);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // The 8.8 values don't fit madd, so 32 bit products from both halves
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        const __m128i productLow = _mm_mullo_epi16(values, w);
+        const __m128i productHigh = _mm_mulhi_epu16(values, w);
+        __m128i *sum = reinterpret_cast<__m128i *>(sums + i);
+        _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum), _mm_unpacklo_epi16(productLow, productHigh)));
+        _mm_storeu_si128(sum + 1, _mm_add_epi32(_mm_loadu_si128(sum + 1), _mm_unpackhi_epi16(productLow, productHigh)));
+    }
+    for (; i < count; ++i) {
+        sums[i] += quint32(row[i]) * weight;
+    }
+}
+
+#elif defined(IMAGESCALER_NEON)
+
+void reduceRow(const uchar *source, const Span *spans, const quint16 *weights, int width, quint16 *out)
+{
+    for (int x = 0; x < width; ++x) {
+        const uchar *pixels = source + spans[x].first * 4;
+        const quint16 *w = weights + spans[x].weightOffset;
+        const int count = spans[x].count;
+
+        uint32x4_t sum = vdupq_n_u32(0);
+        int i = 0;
+        // Two pixels at a time
+        for (; i + 1 < count; i += 2) {
+            const uint16x8_t pair = vmovl_u8(vld1_u8(pixels + i * 4));
+            sum = vmlal_n_u16(sum, vget_low_u16(pair), w[i]);
+            sum = vmlal_n_u16(sum, vget_high_u16(pair), w[i + 1]);
+        }
+        if (i < count) {
+            quint32 pixel;
+            memcpy(&pixel, pixels + i * 4, 4);
+            sum = vmlal_n_u16(sum, vget_low_u16(vmovl_u8(vcreate_u8(pixel))), w[i]);
+        }
+
+        // Round to 8.8
+        vst1_u16(out + x * 4, vrshrn_n_u32(sum, kWeightBits - 8));
+    }
+}
+
+void accumulateRow(quint32 *sums, const quint16 *row, quint16 weight, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t values = vld1q_u16(row + i);
+        vst1q_u32(sums + i, vmlal_n_u16(vld1q_u32(sums + i), vget_low_u16(values), weight));
+        vst1q_u32(sums + i + 4, vmlal_n_u16(vld1q_u32(sums + i + 4), vget_high_u16(values), weight));
+    }
+    for (; i < count; ++i) {
+        sums[i] += quint32(row[i]) * weight;
+    }
+}
+
+#else
+
+void reduceRow(const uchar *source, const Span *spans, const quint16 *weights, int width, quint16 *out)
+{
+    for (int x = 0; x < width; ++x) {
+        const uchar *pixels = source + spans[x].first * 4;
+        const quint16 *w = weights + spans[x].weightOffset;
+
+        quint32 sum[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < spans[x].count; ++i) {
+            for (int c = 0; c < 4; ++c) {
+                sum[c] += quint32(pixels[i * 4 + c]) * w[i];
+            }
+        }
+
+        // Round to 8.8
+        for (int c = 0; c < 4; ++c) {
+            out[x * 4 + c] = (sum[c] + (1 << (kWeightBits - 9))) >> (kWeightBits - 8);
+        }
+    }
+}
+
+void accumulateRow(quint32 *sums, const quint16 *row, quint16 weight, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        sums[i] += quint32(row[i]) * weight;
+    }
+}
+
+#endif
+
+// Both images are 32 bits per pixel and the destination is smaller on both axes
+void areaAverage(const QImage &source, QImage *destination)
+{
+    const int width = destination->width();
+    const int height = destination->height();
+    const int channels = width * 4;
+
+    QVector<Span> columns, rows;
+    QVector<quint16> columnWeights, rowWeights;
+    computeSpans(source.width(), width, &columns, &columnWeights);
+    computeSpans(source.height(), height, &rows, &rowWeights);
+
+    QVector<quint16> reduced(channels);
+    QVector<quint32> sums(channels);
+    int reducedRow = -1;
+
+    for (int y = 0; y < height; ++y) {
+        sums.fill(0);
+
+        const Span &span = rows[y];
+        for (int i = 0; i < span.count; ++i) {
+            const int sourceRow = span.first + i;
+            // The row on the edge of two destination rows is used by both
+            if (sourceRow != reducedRow) {
+                reduceRow(source.constScanLine(sourceRow), columns.constData(), columnWeights.constData(),
+                          width, reduced.data());
+                reducedRow = sourceRow;
+            }
+            accumulateRow(sums.data(), reduced.constData(), rowWeights[span.weightOffset + i], channels);
+        }
+
+        uchar *line = destination->scanLine(y);
+        for (int i = 0; i < channels; ++i) {
+            line[i] = (sums[i] + (1 << (kWeightBits + 7))) >> (kWeightBits + 8);
+        }
+    }
+}
+
+} // namespace
+
+QImage ImageScaler::scaled(const QImage &image, const QSize &size)
+{
+    if (image.isNull() || image.size() == size)
+        return image;
+
+    // Wider sources could have weights that don't fit
+    if (size.width() <= 0 || size.height() <= 0
+            || size.width() >= image.width() || size.height() >= image.height()
+            || image.width() > (1 << kWeightBits) || image.height() > (1 << kWeightBits)) {
+        return image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    // Averaging premultiplied pixels weighs the colors by their alpha
+    const QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                          : QImage::Format_RGB32;
+    const QImage source = image.convertToFormat(format);
+    QImage result(size, format);
+    if (source.isNull() || result.isNull())
+        return QImage();
+
+    areaAverage(source, &result);
+    return result;
+}
+
+QImage ImageScaler::read(QImageReader &reader, const QSize &size)
+{
+    const QSize sourceSize = reader.size();
+
+    const QByteArray format = reader.format();
+    if (format == "svg" || format == "svgz") {
+        // Rendered at the requested size, there is nothing to scale
+        reader.setScaledSize(size);
+        return reader.read();
+    }
+
+    // Other handlers, like PNG, implement ScaledSize as a full decode and
+    // a QImage::scaled(), so only the JPEG one is worth asking
+    if (format == "jpeg" && reader.supportsOption(QImageIOHandler::ScaledSize) && sourceSize.isValid()) {
+        // The largest reduction libjpeg can do that is still at least size.
+        // Qt picks the reduction from the integer ratio of the sizes, so
+        // these round down.
+        int denominator = 8;
+        while (denominator > 1 && (sourceSize.width() / denominator < size.width()
+                                   || sourceSize.height() / denominator < size.height())) {
+            denominator /= 2;
+        }
+        if (denominator > 1) {
+            reader.setScaledSize(QSize(sourceSize.width() / denominator, sourceSize.height() / denominator));
+        }
+    }
+
+    const QImage image = reader.read();
+    if (image.isNull())
+        return image;
+
+    return scaled(image, size);
+}
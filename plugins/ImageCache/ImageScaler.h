@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QImageReader>
+#include <QSize>
+
+/**
+ * Downscaling for the image cache.
+ *
+ * Images are shrunk by averaging the area of the source each destination
+ * pixel covers, in fixed point and with SSE2 or NEON where the build has
+ * them. That is as smooth as Qt::SmoothTransformation and a lot faster on
+ * big reductions. Anything that is not a reduction on both axes is left to
+ * QImage::scaled().
+ *
+ * Reading goes through the same path, except that JPEG files are first
+ * decoded at 1/2, 1/4 or 1/8 of their size, which libjpeg does while
+ * decoding, and SVG, which renders at any size, is read at the requested
+ * size directly. Everything else, PNG included, is decoded at full size
+ * and then shrunk here.
+ */
+
+class ImageScaler
+{
+public:
+    static QImage scaled(const QImage &image, const QSize &size);
+
+    // Returns a null image if the image of reader can't be read
+    static QImage read(QImageReader &reader, const QSize &size);
+};
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RawImage.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QScopedPointer>
+
+#include <string.h>
+
+namespace {
+
+const char kMagic[8] = { 'U', '8', 'R', 'A', 'W', 'I', 'M', 'G' };
+const quint32 kVersion = 1;
+
+// 32 bytes so the pixels after it stay aligned in the mapping
+struct RawImageHeader {
+    char magic[8];
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    quint32 reserved[2];
+};
+
+void deleteFile(void *file)
+{
+    // Also unmaps the pixels
+    delete static_cast<QFile *>(file);
+}
+
+} // namespace
+
+QByteArray RawImage::formatName()
+{
+    return QByteArrayLiteral("raw");
+}
+
+bool RawImage::write(const QImage &image, const QString &path)
+{
+    const QImage pixels = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (pixels.isNull())
+        return false;
+
+    RawImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.width = pixels.width();
+    header.height = pixels.height();
+    header.bytesPerLine = pixels.bytesPerLine();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(pixels.constBits()), pixels.byteCount());
+    return file.commit();
+}
+
+QImage RawImage::read(const QString &path)
+{
+    QScopedPointer<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly))
+        return QImage();
+
+    RawImageHeader header;
+    if (file->read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)
+            || memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+            || header.version != kVersion
+            || header.width <= 0 || header.height <= 0
+            || header.bytesPerLine < header.width * 4
+            || file->size() != qint64(sizeof(header)) + qint64(header.bytesPerLine) * header.height) {
+        return QImage();
+    }
+
+    const uchar *data = file->map(0, file->size());
+    if (!data)
+        return QImage();
+
+    return QImage(data + sizeof(header), header.width, header.height, header.bytesPerLine,
+                  QImage::Format_ARGB32_Premultiplied, deleteFile, file.take());
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+/**
+ * Uncompressed image files for the image cache.
+ *
+ * The file is a small header followed by the pixels in
+ * QImage::Format_ARGB32_Premultiplied, in the byte order of the machine
+ * that wrote it. Reading one maps the file and wraps the mapping in a
+ * QImage, so there is nothing to decode and the pages are only read in
+ * when the image is used.
+ *
+ * Files are only ever replaced through a rename, never rewritten in place,
+ * so a mapping always stays valid.
+ */
+
+class RawImage
+{
+public:
+    // The name used for the format in the cache index
+    static QByteArray formatName();
+
+    static bool write(const QImage &image, const QString &path);
+
+    // Returns a null image if path is not a raw image file
+    static QImage read(const QString &path);
+};
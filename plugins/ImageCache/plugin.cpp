@@ -17,16 +17,30 @@
 #include <QQmlEngine>
 
 #include "ImageCache.h"
+#include "ImageCachePrewarmer.h"
+#include "ImageCacheStats.h"
 #include "plugin.h"
 
 #include <QtQml>
 
+static QObject *imageCacheStatsProvider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(scriptEngine)
+    return engine->findChild<ImageCacheStats *>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+static QObject *imageCachePrewarmerProvider(QQmlEngine *engine, QJSEngine *scriptEngine)
+{
+    Q_UNUSED(scriptEngine)
+    return engine->findChild<ImageCachePrewarmer *>(QString(), Qt::FindDirectChildrenOnly);
+}
+
 void ImageCachePlugin::registerTypes(const char *uri)
 {
     Q_ASSERT(uri == QLatin1String("ImageCache"));
 
-    qmlRegisterTypeNotAvailable(uri, 0, 1, "__ImageCacheIgnoreMe",
-                                QStringLiteral("Ignore this: QML plugins must contain at least one type"));
+    qmlRegisterSingletonType<ImageCacheStats>(uri, 0, 1, "ImageCacheStats", imageCacheStatsProvider);
+    qmlRegisterSingletonType<ImageCachePrewarmer>(uri, 0, 1, "ImageCachePrewarmer", imageCachePrewarmerProvider);
 }
 
 void ImageCachePlugin::initializeEngine(QQmlEngine* engine, const char* uri)
@@ -35,5 +49,12 @@ void ImageCachePlugin::initializeEngine(QQmlEngine* engine, const char* uri)
 
     QQmlExtensionPlugin::initializeEngine(engine, uri);
 
-    engine->addImageProvider("unity8imagecache", new ImageCache);
+    ImageCache *imageCache = new ImageCache;
+    engine->addImageProvider("unity8imagecache", imageCache);
+
+    // Owned by the engine, so they go before the image provider does
+    ImageCacheStats *stats = new ImageCacheStats(imageCache, engine);
+    QQmlEngine::setObjectOwnership(stats, QQmlEngine::CppOwnership);
+    ImageCachePrewarmer *prewarmer = new ImageCachePrewarmer(imageCache, engine);
+    QQmlEngine::setObjectOwnership(prewarmer, QQmlEngine::CppOwnership);
 }
@@ -63,17 +63,10 @@ void AxisVelocityCalculator::updateIdleTime()
 
 void AxisVelocityCalculator::processMovement(qreal movement)
 {
-    if (m_samplesRead == -1) {
-        m_samplesRead = m_samplesWrite;
-    } else if (m_samplesRead == m_samplesWrite) {
-        /* the oldest value is going to be overwritten.
-           so now the oldest will be the next one. */
-        m_samplesRead = (m_samplesRead + 1) % MAX_SAMPLES;
-    }
-
-    m_samples[m_samplesWrite].mov = movement;
-    m_samples[m_samplesWrite].time = m_timeSource->msecsSinceReference();
-    m_samplesWrite = (m_samplesWrite + 1) % MAX_SAMPLES;
+    Sample sample;
+    sample.mov = movement;
+    sample.time = m_timeSource->msecsSinceReference();
+    m_samples.append(sample);
 }
 
 qreal AxisVelocityCalculator::calculate()
@@ -83,30 +76,22 @@ qreal AxisVelocityCalculator::calculate()
     }
     updateIdleTime(); // consider the time elapsed since the last update and now
 
-    int lastIndex;
-    if (m_samplesWrite == 0) {
-        lastIndex = MAX_SAMPLES - 1;
-    } else {
-        lastIndex = m_samplesWrite - 1;
-    }
-
-    qint64 currTime = m_samples[lastIndex].time;
+    qint64 currTime = m_samples.last().time;
 
     qreal totalTime = 0;
     qreal totalDistance = 0;
 
-    int sampleIndex = (m_samplesRead + 1) % MAX_SAMPLES;
-    qint64 previousTime = m_samples[m_samplesRead].time;
-    while (sampleIndex != m_samplesWrite) {
+    qint64 previousTime = m_samples.at(0).time;
+    for (int i = 1; i < m_samples.count(); ++i) {
+        const Sample &sample = m_samples.at(i);
         // Skip this sample if it's too old
-        if (currTime - m_samples[sampleIndex].time <= AGE_OLDEST_SAMPLE) {
-            int deltaTime = m_samples[sampleIndex].time - previousTime;
-            totalDistance += m_samples[sampleIndex].mov;
+        if (currTime - sample.time <= AGE_OLDEST_SAMPLE) {
+            int deltaTime = sample.time - previousTime;
+            totalDistance += sample.mov;
             totalTime += deltaTime;
         }
 
-        previousTime = m_samples[sampleIndex].time;
-        sampleIndex = (sampleIndex + 1) % MAX_SAMPLES;
+        previousTime = sample.time;
     }
 
     return totalDistance / totalTime;
@@ -114,26 +99,12 @@ qreal AxisVelocityCalculator::calculate()
 
 void AxisVelocityCalculator::reset()
 {
-    m_samplesRead = -1;
-    m_samplesWrite = 0;
+    m_samples.clear();
 }
 
 int AxisVelocityCalculator::numSamples() const
 {
-    if (m_samplesRead == -1) {
-        return 0;
-    } else {
-        if (m_samplesWrite == 0) {
-            /* consider only what's to the right of m_samplesRead (including himself) */
-            return MAX_SAMPLES - m_samplesRead;
-        } else if (m_samplesWrite == m_samplesRead) {
-            return MAX_SAMPLES; /* buffer is full */
-        } else if (m_samplesWrite < m_samplesRead) {
-            return (MAX_SAMPLES - m_samplesRead) + m_samplesWrite;
-        } else {
-            return m_samplesWrite - m_samplesRead;
-        }
-    }
+    return m_samples.count();
 }
 
 void AxisVelocityCalculator::setTimeSource(const SharedTimeSource &timeSource)
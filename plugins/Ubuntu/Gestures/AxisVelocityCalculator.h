@@ -22,6 +22,7 @@
 #define VELOCITY_CALCULATOR_H
 
 #include "UbuntuGesturesQmlGlobal.h"
+#include "SampleRingBuffer.h"
 #include <stdint.h>
 #include <QtCore/QObject>
 #include <UbuntuGestures/private/timesource_p.h>
@@ -133,10 +134,7 @@ private:
             qint64 time; /* time, in milliseconds */
     };
 
-    /* a circular buffer of samples */
-    Sample m_samples[MAX_SAMPLES];
-    int m_samplesRead; /* index of the oldest sample available. -1 if buffer is empty */
-    int m_samplesWrite; /* index where the next sample will be written */
+    SampleRingBuffer<Sample, MAX_SAMPLES> m_samples;
 
     UG_PREPEND_NAMESPACE(SharedTimeSource) m_timeSource;
 
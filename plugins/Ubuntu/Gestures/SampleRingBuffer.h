@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLE_RING_BUFFER_H
+#define SAMPLE_RING_BUFFER_H
+
+/*
+  A fixed size circular buffer of input samples
+
+  Once full, each new sample overwrites the oldest one. Samples are indexed
+  from the oldest (0) to the most recent (count() - 1).
+ */
+template<typename Sample, int Size>
+class SampleRingBuffer
+{
+public:
+    void append(const Sample &sample)
+    {
+        m_samples[(m_first + m_count) % Size] = sample;
+        if (m_count < Size) {
+            ++m_count;
+        } else {
+            // the oldest sample was overwritten, so now the oldest is the next one
+            m_first = (m_first + 1) % Size;
+        }
+    }
+
+    const Sample &at(int index) const { return m_samples[(m_first + index) % Size]; }
+    const Sample &last() const { return at(m_count - 1); }
+
+    int count() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    void clear()
+    {
+        m_first = 0;
+        m_count = 0;
+    }
+
+private:
+    Sample m_samples[Size];
+    int m_first{0}; /* index of the oldest sample */
+    int m_count{0};
+};
+
+#endif // SAMPLE_RING_BUFFER_H
@@ -34,6 +34,7 @@ UG_USE_NAMESPACE
 
 TouchGate::TouchGate(QQuickItem *parent)
     : QQuickItem(parent)
+    , m_mergeStoredEvents(true)
 {
     connect(this, &QQuickItem::enabledChanged,
             this, &TouchGate::onEnabledChanged);
@@ -152,9 +153,35 @@ void TouchGate::storeTouchEvent(QTouchDevice *device,
             QWindow *window,
             ulong timestamp)
 {
-    ugDebug("Storing" << touchPoints);
     TouchEvent event(device, modifiers, touchPoints, window, timestamp);
-    m_storedEvents.append(std::move(event));
+
+    if (!m_storedEvents.isEmpty() && canMergeIntoLastStoredEvent(event)) {
+        ugDebug("Merging" << touchPoints << "into the last stored event");
+        m_storedEvents.last().merge(event);
+    } else {
+        ugDebug("Storing" << touchPoints);
+        m_storedEvents.append(std::move(event));
+    }
+}
+
+bool TouchGate::canMergeIntoLastStoredEvent(const TouchEvent &event) const
+{
+    const TouchEvent &lastEvent = m_storedEvents.last();
+
+    if (!m_mergeStoredEvents || !event.isUpdate()
+            || event.device != lastEvent.device
+            || event.window != lastEvent.window
+            || event.modifiers != lastEvent.modifiers) {
+        return false;
+    }
+
+    if (lastEvent.isUpdate()) {
+        return true;
+    }
+
+    // Merging into a press would make the target see it happening where the touch point
+    // later moved to, so only do it to keep the number of stored events in check.
+    return m_storedEvents.count() >= MAX_STORED_EVENTS && !lastEvent.endsTouchesOf(event);
 }
 
 void TouchGate::removeTouchFromStoredEvents(int touchId)
@@ -288,3 +315,57 @@ bool TouchGate::TouchEvent::removeTouch(int touchId)
 
     return removed;
 }
+
+bool TouchGate::TouchEvent::isUpdate() const
+{
+    for (int i = 0; i < touchPoints.count(); ++i) {
+        const Qt::TouchPointState state = touchPoints[i].state();
+        if (state != Qt::TouchPointMoved && state != Qt::TouchPointStationary) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TouchGate::TouchEvent::endsTouchesOf(const TouchEvent &other) const
+{
+    for (int i = 0; i < touchPoints.count(); ++i) {
+        if (touchPoints[i].state() != Qt::TouchPointReleased) {
+            continue;
+        }
+        for (int j = 0; j < other.touchPoints.count(); ++j) {
+            if (other.touchPoints[j].id() == touchPoints[i].id()) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void TouchGate::TouchEvent::merge(const TouchEvent &update)
+{
+    for (int i = 0; i < update.touchPoints.count(); ++i) {
+        const QTouchEvent::TouchPoint &touchPoint = update.touchPoints[i];
+
+        int j = 0;
+        while (j < touchPoints.count() && touchPoints[j].id() != touchPoint.id()) {
+            ++j;
+        }
+
+        if (j == touchPoints.count()) {
+            touchPoints.append(touchPoint);
+        } else {
+            // A touch point that was pressed or moved since the last dispatched event
+            // is still pressed or moved, even if it stood still in the later one.
+            const Qt::TouchPointState state = touchPoints[j].state();
+            touchPoints[j] = touchPoint;
+            if (touchPoint.state() == Qt::TouchPointStationary || state == Qt::TouchPointPressed) {
+                touchPoints[j].setState(state);
+            }
+        }
+    }
+
+    timestamp = update.timestamp;
+}
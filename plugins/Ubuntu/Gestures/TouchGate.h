@@ -35,6 +35,10 @@ UG_FORWARD_DECLARE_CLASS(TouchOwnershipEvent)
   Blocked touch events won't be discarded. Instead they will be buffered until ownership
   is granted. If ownership is given to another item, the event buffer is cleared.
 
+  Consecutive buffered events that only move touch points are merged into one, so a long
+  wait for ownership doesn't end up in a burst of stale movements being replayed at once.
+  The target still gets every press and release, and ends up with the same touch positions.
+
   A TouchGate is useful as a mediator for items that do not understand, or gracefully handle,
   touch canceling. By having a TouchGate in front of them you guarantee that only owned touches (i.e.,
   touches that won't be canceled later) reaches them.
@@ -76,6 +80,15 @@ private:
 
         bool removeTouch(int touchId);
 
+        // Whether its touch points are all either moving or stationary
+        bool isUpdate() const;
+
+        // Whether it releases any of the touch points in the given event
+        bool endsTouchesOf(const TouchEvent &other) const;
+
+        // Takes in the touch points of a later update event, as if both had been a single one
+        void merge(const TouchEvent &update);
+
         QTouchDevice *device;
         Qt::KeyboardModifiers modifiers;
         QList<QTouchEvent::TouchPoint> touchPoints;
@@ -90,6 +103,7 @@ private:
             const QList<QTouchEvent::TouchPoint> &touchPoints,
             QWindow *window,
             ulong timestamp);
+    bool canMergeIntoLastStoredEvent(const TouchEvent &event) const;
     void removeTouchFromStoredEvents(int touchId);
     void dispatchFullyOwnedEvents();
     bool eventIsFullyOwned(const TouchEvent &event) const;
@@ -104,6 +118,13 @@ private:
 
     QList<TouchEvent> m_storedEvents;
 
+    // Update events are merged into whatever event came before them (press or release included)
+    // once this many are stored. Presses and releases are always stored on their own.
+    static const int MAX_STORED_EVENTS = 64;
+
+    // For measuring replays with and without it
+    bool m_mergeStoredEvents;
+
     enum {
         OwnershipUndefined,
         OwnershipRequested,
@@ -120,6 +141,7 @@ private:
     TouchDispatcher m_dispatcher;
 
     friend class tst_TouchGate;
+    friend class TouchGateBenchmark;
 };
 
 #endif // UBUNTU_TOUCH_GATE_H
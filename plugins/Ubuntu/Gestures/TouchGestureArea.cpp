@@ -136,10 +136,15 @@ TouchGestureArea::TouchGestureArea(QQuickItem* parent)
     , m_maximumTouchPoints(INT_MAX)
     , m_recognitionPeriod(50)
     , m_releaseRejectPeriod(100)
+    , m_coalesceUpdates(false)
 {
     setRecognitionTimer(new Timer(this));
     m_recognitionTimer->setInterval(m_recognitionPeriod);
     m_recognitionTimer->setSingleShot(true);
+
+    for (int i = 0; i < PREALLOCATED_TOUCH_POINTS; ++i) {
+        m_touchPointPool.append(new GestureTouchPoint);
+    }
 }
 
 TouchGestureArea::~TouchGestureArea()
@@ -149,6 +154,8 @@ TouchGestureArea::~TouchGestureArea()
     m_liveTouchPoints.clear();
     qDeleteAll(m_cachedTouchPoints);
     m_cachedTouchPoints.clear();
+    qDeleteAll(m_touchPointPool);
+    m_touchPointPool.clear();
 }
 
 bool TouchGestureArea::event(QEvent *event)
@@ -473,8 +480,7 @@ void TouchGestureArea::updateTouchPoints(QTouchEvent *touchEvent)
 
             if (updateable) {
                 if (m_cachedTouchPoints.contains(touchId)) {
-                    GestureTouchPoint* cachedPoint = m_cachedTouchPoints.take(touchId);
-                    cachedPoint->deleteLater();
+                    m_retiredTouchPoints.append(m_cachedTouchPoints.take(touchId));
                 }
             }
             ended = true;
@@ -488,7 +494,9 @@ void TouchGestureArea::updateTouchPoints(QTouchEvent *touchEvent)
                     if (m_cachedTouchPoints.contains(touchId)) {
                         m_cachedTouchPoints[touchId]->setPos(touchPoint.pos());
                     } else {
-                        m_cachedTouchPoints[touchId] = new GestureTouchPoint(*gtp);
+                        GestureTouchPoint* cachedPoint = acquireTouchPoint();
+                        *cachedPoint = *gtp;
+                        m_cachedTouchPoints[touchId] = cachedPoint;
                     }
                 }
                 added = true;
@@ -514,7 +522,8 @@ void TouchGestureArea::updateTouchPoints(QTouchEvent *touchEvent)
                     gtp->setDragging(true);
                 }
 
-                if (updateable) {
+                // When coalescing, cached touch points catch up in flushPendingUpdates()
+                if (updateable && !isCoalescingUpdates()) {
                     if (m_cachedTouchPoints.contains(touchId)) {
                         m_cachedTouchPoints[touchId]->setPos(touchPoint.pos());
                         if (overDragThreshold) {
@@ -538,6 +547,10 @@ void TouchGestureArea::updateTouchPoints(QTouchEvent *touchEvent)
             }
         }
 
+        if (ended || added) {
+            // Movement that came first is reported first
+            flushPendingUpdates();
+        }
         if (ended) {
             if (m_liveTouchPoints.isEmpty()) {
                 if (!dragging()) Q_EMIT clicked();
@@ -550,6 +563,17 @@ void TouchGestureArea::updateTouchPoints(QTouchEvent *touchEvent)
             tgaDebug("Pressed " << touchesString(m_pressedTouchPoints));
             Q_EMIT pressed(m_pressedTouchPoints);
         }
+        if (moved && isCoalescingUpdates()) {
+            if (m_pendingUpdatedTouchPoints.isEmpty()) {
+                window()->update();
+            }
+            Q_FOREACH(QObject *touchPoint, m_movedTouchPoints) {
+                if (!m_pendingUpdatedTouchPoints.contains(touchPoint)) {
+                    m_pendingUpdatedTouchPoints.append(touchPoint);
+                }
+            }
+            moved = false;
+        }
         if (moved) {
             tgaDebug("Updated " << touchesString(m_movedTouchPoints));
             Q_EMIT updated(m_movedTouchPoints);
@@ -560,12 +584,42 @@ void TouchGestureArea::updateTouchPoints(QTouchEvent *touchEvent)
     }
 }
 
+void TouchGestureArea::flushPendingUpdates()
+{
+    if (m_pendingUpdatedTouchPoints.isEmpty()) {
+        return;
+    }
+
+    QList<QObject*> touchPoints;
+    touchPoints.swap(m_pendingUpdatedTouchPoints);
+
+    Q_FOREACH(QObject *object, touchPoints) {
+        GestureTouchPoint* touchPoint = static_cast<GestureTouchPoint*>(object);
+        GestureTouchPoint* cachedPoint = m_cachedTouchPoints.value(touchPoint->id(), nullptr);
+        if (cachedPoint) {
+            cachedPoint->setPos(QPointF(touchPoint->x(), touchPoint->y()));
+            if (touchPoint->dragging()) {
+                cachedPoint->setDragging(true);
+            }
+        }
+    }
+
+    tgaDebug("Coalesced Update " << touchesString(touchPoints));
+    Q_EMIT updated(touchPoints);
+    Q_EMIT touchPointsUpdated();
+}
+
 void TouchGestureArea::clearTouchLists()
 {
     Q_FOREACH (QObject *gtp, m_releasedTouchPoints) {
-        delete gtp;
+        m_pendingUpdatedTouchPoints.removeAll(gtp);
+        recycleTouchPoint(static_cast<GestureTouchPoint*>(gtp));
     }
     m_releasedTouchPoints.clear();
+    Q_FOREACH (GestureTouchPoint *gtp, m_retiredTouchPoints) {
+        recycleTouchPoint(gtp);
+    }
+    m_retiredTouchPoints.clear();
     m_pressedTouchPoints.clear();
     m_movedTouchPoints.clear();
 }
@@ -705,6 +759,22 @@ void TouchGestureArea::setReleaseRejectPeriod(int value)
     }
 }
 
+bool TouchGestureArea::coalesceUpdates() const
+{
+    return m_coalesceUpdates;
+}
+
+void TouchGestureArea::setCoalesceUpdates(bool value)
+{
+    if (value != m_coalesceUpdates) {
+        m_coalesceUpdates = value;
+        if (!value) {
+            flushPendingUpdates();
+        }
+        Q_EMIT coalesceUpdatesChanged(value);
+    }
+}
+
 void TouchGestureArea::rejectGesture()
 {
     tgaDebug("rejectGesture");
@@ -731,6 +801,7 @@ void TouchGestureArea::rejectGesture()
 void TouchGestureArea::resyncCachedTouchPoints()
 {
     clearTouchLists();
+    flushPendingUpdates();
 
     bool added = false;
     bool ended = false;
@@ -758,7 +829,9 @@ void TouchGestureArea::resyncCachedTouchPoints()
                 moved = true;
             }
         } else {
-            m_cachedTouchPoints.insert(touchPoint->id(), new GestureTouchPoint(*touchPoint));
+            GestureTouchPoint* cachedPoint = acquireTouchPoint();
+            *cachedPoint = *touchPoint;
+            m_cachedTouchPoints.insert(touchPoint->id(), cachedPoint);
             m_pressedTouchPoints.append(touchPoint);
             added = true;
         }
@@ -797,19 +870,44 @@ GestureTouchPoint *TouchGestureArea::touchPoint_at(QQmlListProperty<GestureTouch
 
 GestureTouchPoint* TouchGestureArea::addTouchPoint(QTouchEvent::TouchPoint const* tp)
 {
-    GestureTouchPoint* gtp = new GestureTouchPoint();
+    GestureTouchPoint* gtp = acquireTouchPoint();
     gtp->setId(tp->id());
     gtp->setPressed(true);
     gtp->setPos(tp->pos());
+    gtp->setDragging(false);
     m_liveTouchPoints.insert(tp->id(), gtp);
     return gtp;
 }
 
+GestureTouchPoint* TouchGestureArea::acquireTouchPoint()
+{
+    if (m_touchPointPool.isEmpty()) {
+        return new GestureTouchPoint;
+    }
+    return m_touchPointPool.takeLast();
+}
+
+void TouchGestureArea::recycleTouchPoint(GestureTouchPoint *touchPoint)
+{
+    m_touchPointPool.append(touchPoint);
+}
+
+bool TouchGestureArea::isCoalescingUpdates() const
+{
+    // Without a window there are no frames to wait for
+    return m_coalesceUpdates && window();
+}
+
 void TouchGestureArea::itemChange(ItemChange change, const ItemChangeData &value)
 {
     if (change == QQuickItem::ItemSceneChange) {
+        disconnect(m_afterAnimatingConnection);
+        flushPendingUpdates();
+
         if (value.window != nullptr) {
             value.window->installEventFilter(TouchRegistry::instance());
+            m_afterAnimatingConnection = connect(value.window, &QQuickWindow::afterAnimating,
+                                                 this, &TouchGestureArea::flushPendingUpdates);
         }
     }
 }
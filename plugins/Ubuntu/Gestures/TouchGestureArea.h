@@ -47,8 +47,12 @@ public:
 
     GestureTouchPoint(const GestureTouchPoint& other)
     : QObject(nullptr)
+    , m_id(other.m_id)
+    , m_pressed(other.m_pressed)
+    , m_x(other.m_x)
+    , m_y(other.m_y)
+    , m_dragging(other.m_dragging)
     {
-        operator=(other);
     }
 
     int id() const { return m_id; }
@@ -66,13 +70,14 @@ public:
     bool dragging() const { return m_dragging; }
     void setDragging(bool dragging);
 
+    // Through the setters, pooled points are reused while QML may still hold them
     GestureTouchPoint& operator=(const GestureTouchPoint& rhs) {
         if (&rhs == this) return *this;
-        m_id = rhs.m_id;
-        m_pressed = rhs.m_pressed;
-        m_x = rhs.m_x;
-        m_y = rhs.m_y;
-        m_dragging = rhs.m_dragging;
+        setId(rhs.m_id);
+        setPressed(rhs.m_pressed);
+        setX(rhs.m_x);
+        setY(rhs.m_y);
+        setDragging(rhs.m_dragging);
         return *this;
     }
 
@@ -127,6 +132,10 @@ class UBUNTUGESTURESQML_EXPORT TouchGestureArea : public QQuickItem
     // Time(ms) the component will allow a recognised gesture to intermitently release a touch point before rejecting the gesture.
     // This is so we will not immediately reject a gesture if there are fleeting touch point releases while dragging.
     Q_PROPERTY(int releaseRejectPeriod READ releaseRejectPeriod WRITE setReleaseRejectPeriod NOTIFY releaseRejectPeriodChanged)
+    // Whether movements are reported at most once per frame, right before the window renders it, instead of as
+    // they come. Touchscreens often report faster than the display refreshes. Presses and releases are still
+    // reported right away, after any movement waiting to be reported.
+    Q_PROPERTY(bool coalesceUpdates READ coalesceUpdates WRITE setCoalesceUpdates NOTIFY coalesceUpdatesChanged)
 
 public:
     // Describes the state of the touch gesture area.
@@ -160,6 +169,9 @@ public:
     int releaseRejectPeriod() const;
     void setReleaseRejectPeriod(int value);
 
+    bool coalesceUpdates() const;
+    void setCoalesceUpdates(bool value);
+
 Q_SIGNALS:
     void statusChanged(int status);
 
@@ -169,6 +181,7 @@ Q_SIGNALS:
     void maximumTouchPointsChanged(int value);
     void recognitionPeriodChanged(int value);
     void releaseRejectPeriodChanged(int value);
+    void coalesceUpdatesChanged(bool value);
 
     void pressed(const QList<QObject*>& points);
     void released(const QList<QObject*>& points);
@@ -180,6 +193,7 @@ protected:
 
 private Q_SLOTS:
     void rejectGesture();
+    void flushPendingUpdates();
 
 private:
     void touchEvent(QTouchEvent *event) override;
@@ -199,6 +213,9 @@ private:
     void updateTouchPoints(QTouchEvent *event);
 
     GestureTouchPoint* addTouchPoint(const QTouchEvent::TouchPoint *tp);
+    GestureTouchPoint* acquireTouchPoint();
+    void recycleTouchPoint(GestureTouchPoint *touchPoint);
+    bool isCoalescingUpdates() const;
     void clearTouchLists();
     void setDragging(bool dragging);
     void setInternalStatus(uint status);
@@ -222,6 +239,18 @@ private:
     int m_maximumTouchPoints;
     int m_recognitionPeriod;
     int m_releaseRejectPeriod;
+
+    // Touch points are reused rather than allocated for every new touch
+    static const int PREALLOCATED_TOUCH_POINTS = 10;
+    QList<GestureTouchPoint*> m_touchPointPool;
+    // Cached touch points of released touches, recycled along with m_releasedTouchPoints
+    QList<GestureTouchPoint*> m_retiredTouchPoints;
+
+    bool m_coalesceUpdates;
+    QList<QObject*> m_pendingUpdatedTouchPoints;
+    QMetaObject::Connection m_afterAnimatingConnection;
+
+    friend class tst_TouchGestureArea;
 };
 
 QML_DECLARE_TYPE(GestureTouchPoint)
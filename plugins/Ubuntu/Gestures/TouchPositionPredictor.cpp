@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TouchPositionPredictor.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+
+UG_USE_NAMESPACE
+
+namespace {
+
+int frameDuration()
+{
+    QScreen *screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 0) {
+        return qRound(1000 / screen->refreshRate());
+    } else {
+        return 16;
+    }
+}
+
+} // namespace {
+
+TouchPositionPredictor::TouchPositionPredictor(QObject *parent)
+    : TouchPositionPredictor(SharedTimeSource(new RealTimeSource), parent)
+{
+}
+
+TouchPositionPredictor::TouchPositionPredictor(const SharedTimeSource &timeSource,
+                                               QObject *parent)
+    : QObject(parent)
+    , m_timeSource(timeSource)
+    , m_idleTimer(nullptr)
+    , m_predictionTime(frameDuration())
+    , m_enabled(true)
+{
+    setIdleTimer(new Timer(this));
+}
+
+TouchPositionPredictor::~TouchPositionPredictor()
+{
+}
+
+QPointF TouchPositionPredictor::trackedPosition() const
+{
+    return m_trackedPosition;
+}
+
+void TouchPositionPredictor::setTrackedPosition(const QPointF &value)
+{
+    const bool changed = value != m_trackedPosition;
+    m_trackedPosition = value;
+
+    if (m_enabled) {
+        addSample(value);
+        m_idleTimer->start();
+    }
+
+    if (changed) {
+        Q_EMIT trackedPositionChanged(value);
+    }
+
+    updatePrediction();
+}
+
+QPointF TouchPositionPredictor::predictedPosition() const
+{
+    return m_predictedPosition;
+}
+
+void TouchPositionPredictor::setPredictedPosition(const QPointF &value)
+{
+    if (value != m_predictedPosition) {
+        m_predictedPosition = value;
+        Q_EMIT predictedPositionChanged(value);
+    }
+}
+
+int TouchPositionPredictor::predictionTime() const
+{
+    return m_predictionTime;
+}
+
+void TouchPositionPredictor::setPredictionTime(int value)
+{
+    if (value != m_predictionTime) {
+        m_predictionTime = value;
+        Q_EMIT predictionTimeChanged(value);
+        updatePrediction();
+    }
+}
+
+bool TouchPositionPredictor::enabled() const
+{
+    return m_enabled;
+}
+
+void TouchPositionPredictor::setEnabled(bool value)
+{
+    if (value != m_enabled) {
+        m_enabled = value;
+        reset();
+        Q_EMIT enabledChanged(value);
+    }
+}
+
+void TouchPositionPredictor::reset()
+{
+    m_samples.clear();
+    m_idleTimer->stop();
+    updatePrediction();
+}
+
+int TouchPositionPredictor::numSamples() const
+{
+    return m_samples.count();
+}
+
+void TouchPositionPredictor::updateIdleTime()
+{
+    addSample(m_trackedPosition);
+    updatePrediction();
+
+    // Keep going until the movement that came before is too old to matter
+    if (m_predictedPosition != m_trackedPosition) {
+        m_idleTimer->start();
+    }
+}
+
+void TouchPositionPredictor::addSample(const QPointF &position)
+{
+    Sample sample;
+    sample.pos = position;
+    sample.time = m_timeSource->msecsSinceReference();
+    m_samples.append(sample);
+}
+
+void TouchPositionPredictor::updatePrediction()
+{
+    if (!m_enabled || m_samples.count() < MIN_SAMPLES_NEEDED) {
+        setPredictedPosition(m_trackedPosition);
+        return;
+    }
+
+    const qint64 currTime = m_samples.last().time;
+
+    // Skip samples that are too old
+    int first = m_samples.count() - 1;
+    while (first > 0 && currTime - m_samples.at(first - 1).time <= AGE_OLDEST_SAMPLE) {
+        --first;
+    }
+
+    const int count = m_samples.count() - first;
+    if (count < MIN_SAMPLES_NEEDED) {
+        setPredictedPosition(m_trackedPosition);
+        return;
+    }
+
+    // Least squares fit of position = velocity * time + offset, on each axis.
+    // Times are taken relative to the last sample to keep them small.
+    qreal meanTime = 0;
+    QPointF meanPos;
+    for (int i = first; i < m_samples.count(); ++i) {
+        meanTime += m_samples.at(i).time - currTime;
+        meanPos += m_samples.at(i).pos;
+    }
+    meanTime /= count;
+    meanPos /= count;
+
+    qreal timeVariance = 0;
+    QPointF covariance;
+    for (int i = first; i < m_samples.count(); ++i) {
+        const qreal deltaTime = (m_samples.at(i).time - currTime) - meanTime;
+        timeVariance += deltaTime * deltaTime;
+        covariance += deltaTime * (m_samples.at(i).pos - meanPos);
+    }
+
+    if (qFuzzyIsNull(timeVariance)) {
+        // all samples came at once, nothing to fit
+        setPredictedPosition(m_trackedPosition);
+        return;
+    }
+
+    // Extrapolating from the last position rather than from the fitted line
+    // keeps the prediction from lagging behind it, and makes it exact
+    // when the finger stands still.
+    const QPointF velocity = covariance / timeVariance;
+    setPredictedPosition(m_trackedPosition + velocity * m_predictionTime);
+}
+
+void TouchPositionPredictor::setTimeSource(const SharedTimeSource &timeSource)
+{
+    m_timeSource = timeSource;
+
+    if (numSamples() > 0) {
+        qWarning("TouchPositionPredictor: changing time source while there are samples present.");
+        // Any existent samples are based on the old time source and are, therefore, incompatible
+        // with this new one.
+        reset();
+    }
+}
+
+void TouchPositionPredictor::setIdleTimer(AbstractTimer *timer)
+{
+    bool timerWasRunning = false;
+
+    // can be null when called from the constructor
+    if (m_idleTimer) {
+        timerWasRunning = m_idleTimer->isRunning();
+        if (m_idleTimer->parent() == this) {
+            delete m_idleTimer;
+        }
+    }
+
+    m_idleTimer = timer;
+    timer->setInterval(IDLE_TIME);
+    timer->setSingleShot(true);
+    connect(timer, SIGNAL(timeout()),
+            this, SLOT(updateIdleTime()));
+    if (timerWasRunning) {
+        m_idleTimer->start();
+    }
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOUCH_POSITION_PREDICTOR_H
+#define TOUCH_POSITION_PREDICTOR_H
+
+#include "UbuntuGesturesQmlGlobal.h"
+#include "SampleRingBuffer.h"
+#include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <UbuntuGestures/private/timer_p.h>
+#include <UbuntuGestures/private/timesource_p.h>
+
+/*
+  Predicts where a finger will be by the time a frame is presented
+
+  Content that follows the finger position as reported by the touchscreen
+  is always one or two frames behind it. The predictor fits a straight line
+  through the recent positions of the finger (least squares, so that jitter
+  doesn't throw it off) and extrapolates it predictionTime milliseconds
+  ahead of the last one.
+
+  When the finger stops moving touchscreens stop reporting it, so after a
+  short while without updates the predictor assumes it's standing still and
+  predictedPosition settles back on trackedPosition.
+
+  While disabled, predictedPosition is simply trackedPosition.
+
+  Usage example:
+
+    TouchPositionPredictor {
+        id: predictor
+        enabled: myMouseArea.pressed
+        trackedPosition: Qt.point(myMouseArea.mouseX, myMouseArea.mouseY)
+    }
+
+    Rectangle {
+        x: predictor.predictedPosition.x
+        y: predictor.predictedPosition.y
+    }
+ */
+class UBUNTUGESTURESQML_EXPORT TouchPositionPredictor : public QObject
+{
+    Q_OBJECT
+
+    /*
+        Position of the finger, as reported by the touchscreen
+     */
+    Q_PROPERTY(QPointF trackedPosition READ trackedPosition WRITE setTrackedPosition
+               NOTIFY trackedPositionChanged)
+
+    /*
+        Where the finger is expected to be predictionTime milliseconds after
+        trackedPosition was last updated
+     */
+    Q_PROPERTY(QPointF predictedPosition READ predictedPosition NOTIFY predictedPositionChanged)
+
+    /*
+        How far ahead to predict, in milliseconds. Defaults to one frame of
+        the primary screen.
+     */
+    Q_PROPERTY(int predictionTime READ predictionTime WRITE setPredictionTime
+               NOTIFY predictionTimeChanged)
+
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+public:
+
+    /*
+      Regular, simple, constructor
+     */
+    TouchPositionPredictor(QObject *parent = 0);
+
+    /*
+      Constructor that takes a TimeSource
+     */
+    TouchPositionPredictor(const UG_PREPEND_NAMESPACE(SharedTimeSource) &timeSource, QObject *parent = 0);
+
+    virtual ~TouchPositionPredictor();
+
+    QPointF trackedPosition() const;
+    void setTrackedPosition(const QPointF &value);
+
+    QPointF predictedPosition() const;
+
+    int predictionTime() const;
+    void setPredictionTime(int value);
+
+    bool enabled() const;
+    void setEnabled(bool value);
+
+    /*
+      Forgets all movement tracked so far
+    */
+    Q_INVOKABLE void reset();
+
+    int numSamples() const;
+
+    /*
+        Replaces the TimeSource with the given one. Useful for testing purposes.
+     */
+    void setTimeSource(const UG_PREPEND_NAMESPACE(SharedTimeSource) &timeSource);
+
+    /*
+        Replaces the timer that tells when the finger stopped moving.
+        Useful for testing purposes.
+     */
+    void setIdleTimer(UG_PREPEND_NAMESPACE(AbstractTimer) *timer);
+
+    /*
+        The minimum amount of samples needed for a prediction.
+     */
+    static const int MIN_SAMPLES_NEEDED = 3;
+
+    /*
+      Maximum number of position samples stored
+    */
+    static const int MAX_SAMPLES = 20;
+
+    /*
+      Age of the oldest sample considered in the fitting, in milliseconds,
+      compared to the most recent one.
+
+      Older samples would smooth out more jitter but make the prediction
+      slower to follow changes in direction or speed.
+    */
+    static const int AGE_OLDEST_SAMPLE = 40;
+
+    /*
+      For how long, in milliseconds, trackedPosition can remain unchanged
+      before the finger is considered to be standing still.
+    */
+    static const int IDLE_TIME = 25;
+
+Q_SIGNALS:
+    void trackedPositionChanged(const QPointF &value);
+    void predictedPositionChanged(const QPointF &value);
+    void predictionTimeChanged(int value);
+    void enabledChanged(bool value);
+
+private Q_SLOTS:
+    /*
+        Inform that trackedPosition remained motionless since the time it was
+        last changed.
+     */
+    void updateIdleTime();
+
+private:
+    void addSample(const QPointF &position);
+    void updatePrediction();
+    void setPredictedPosition(const QPointF &value);
+
+    class Sample
+    {
+        public:
+            QPointF pos;
+            qint64 time; /* time, in milliseconds */
+    };
+
+    SampleRingBuffer<Sample, MAX_SAMPLES> m_samples;
+
+    UG_PREPEND_NAMESPACE(SharedTimeSource) m_timeSource;
+    UG_PREPEND_NAMESPACE(AbstractTimer) *m_idleTimer;
+
+    QPointF m_trackedPosition;
+    QPointF m_predictedPosition;
+    int m_predictionTime;
+    bool m_enabled;
+};
+
+#endif // TOUCH_POSITION_PREDICTOR_H
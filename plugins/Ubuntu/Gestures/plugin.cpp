@@ -21,6 +21,7 @@
 #include "PressedOutsideNotifier.h"
 #include "TouchGate.h"
 #include "TouchGestureArea.h"
+#include "TouchPositionPredictor.h"
 
 #include <qqml.h>
 
@@ -38,5 +39,6 @@ void UbuntuGesturesQmlPlugin::registerTypes(const char *uri)
     qmlRegisterType<PressedOutsideNotifier>(uri, 0, 1, "PressedOutsideNotifier");
     qmlRegisterType<TouchGate>(uri, 0, 1, "TouchGate");
     qmlRegisterType<TouchGestureArea>(uri, 0, 1, "TouchGestureArea");
+    qmlRegisterType<TouchPositionPredictor>(uri, 0, 1, "TouchPositionPredictor");
     qmlRegisterUncreatableType<GestureTouchPoint>(uri, 0, 1, "GestureTouchPoint", "Cannot create GestureTouchPoints");
 }
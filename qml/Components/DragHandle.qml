@@ -147,6 +147,27 @@ SwipeArea {
             return diff;
         }
 
+        function followDrag(distance) {
+            if (!Direction.isPositive(dragArea.direction))
+                distance = -distance;
+
+            if (dragArea.stretch &&
+                   ((!Direction.isPositive(dragArea.direction) && !d.dragParent.shown)
+                     ||
+                    (Direction.isPositive(dragArea.direction) && d.dragParent.shown))
+               )
+            {
+                // This happens when you have a stretching showable being shown from the right or
+                // top edge (and consequently being hidden when dragged towards the right/top edge)
+                // In those situations, dimension expansion/retraction happens in the opposite
+                // sign of the axis direction
+                distance = -distance;
+            }
+
+            var toAdd = d.limitMovement(distance);
+            dragParent[d.targetProp] = d.startValue + toAdd;
+        }
+
         function onFinishedRecognizedGesture() {
             if (dragEvaluator.shouldAutoComplete()) {
                 completeDrag();
@@ -183,26 +204,24 @@ SwipeArea {
         direction: dragArea.direction
     }
 
-    onDistanceChanged: {
-        if (dragging) {
-            if (!Direction.isPositive(direction))
-                distance = -distance;
-
-            if (dragArea.stretch &&
-                   ((!Direction.isPositive(direction) && !d.dragParent.shown)
-                     ||
-                    (Direction.isPositive(direction) && d.dragParent.shown))
-               )
-            {
-                // This happens when you have a stretching showable being shown from the right or
-                // top edge (and consequently being hidden when dragged towards the right/top edge)
-                // In those situations, dimension expansion/retraction happens in the opposite
-                // sign of the axis direction
-                distance = -distance;
+    // Whether the parent should follow where the finger is predicted to be when the frame gets
+    // on screen, instead of where it was last reported to be, so that it doesn't trail behind it.
+    property bool predictTouch: false
+
+    TouchPositionPredictor {
+        id: touchPredictor
+        enabled: dragArea.predictTouch && dragArea.dragging
+        trackedPosition: Qt.point(dragArea.distance, 0)
+        onPredictedPositionChanged: {
+            if (enabled) {
+                d.followDrag(predictedPosition.x);
             }
+        }
+    }
 
-            var toAdd = d.limitMovement(distance);
-            parent[d.targetProp] = d.startValue + toAdd;
+    onDistanceChanged: {
+        if (dragging && !touchPredictor.enabled) {
+            d.followDrag(distance);
         }
     }
 
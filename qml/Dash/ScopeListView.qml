@@ -25,4 +25,5 @@ ListViewWithPageHeader {
     // 1073741823 is s^30 -1. A quite big number so that you have "infinite" cache, but not so
     // big so that if you add if with itself you're outside the 2^31 int range
     cacheBuffer: 1073741823
+    trackItemHeights: true
 }
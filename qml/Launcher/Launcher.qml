@@ -33,6 +33,7 @@ FocusScope {
     property Item blurSource: null
     property int topPanelHeight: 0
     property bool drawerEnabled: true
+    property bool predictTouch: false // have the panel follow where the finger is about to be when dragged out
     property alias privateMode: panel.privateMode
 
     property int panelWidth: units.gu(10)
@@ -538,13 +539,36 @@ FocusScope {
             return toRight ? "right" : toLeft ? "left" : "unknown";
         }
 
+        TouchPositionPredictor {
+            id: touchPredictor
+            enabled: root.predictTouch && dragArea.dragging
+            trackedPosition: Qt.point(dragArea.distance, 0)
+            onPredictedPositionChanged: {
+                if (enabled) {
+                    dragArea.followDrag(predictedPosition.x);
+                }
+            }
+        }
+
         onDistanceChanged: {
+            // Where the finger really is, a prediction that overshoots must not
+            // decide where the drag was going
+            if (root.drawerEnabled && dragging && launcher.state != "drawer") {
+                lastDragPoints.push(distance)
+            }
+
+            if (!touchPredictor.enabled) {
+                followDrag(distance);
+            }
+        }
+
+        // Only moves the panel and the drawer, distance can be a predicted one
+        function followDrag(distance) {
             if (dragging && launcher.state != "visible" && launcher.state != "drawer") {
                 panel.x = -panel.width + Math.min(Math.max(0, distance), panel.width);
             }
 
             if (root.drawerEnabled && dragging && launcher.state != "drawer") {
-                lastDragPoints.push(distance)
                 var drawerHintDistance = panel.width + units.gu(1)
                 if (distance < drawerHintDistance) {
                     drawer.anchors.rightMargin = -Math.min(Math.max(0, distance), drawer.width);
@@ -152,6 +152,14 @@ StyledItem {
         // only need to bother caching one at a time.
         readonly property url cachedBackground: background.toString().indexOf("file:///") === 0 ? "image://unity8imagecache/" + background + "?name=wallpaper" : background
 
+        // Have it loading before the greeter and the notifications ask for
+        // it, at the size Wallpaper shows it at
+        function prewarm() {
+            ImageCachePrewarmer.prewarm(cachedBackground, Qt.size(0, Math.max(Screen.width, Screen.height)));
+        }
+        onCachedBackgroundChanged: prewarm()
+        Component.onCompleted: prewarm()
+
         GSettings {
             id: backgroundSettings
             schema.id: "org.gnome.desktop.background"
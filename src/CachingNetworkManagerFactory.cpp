@@ -18,11 +18,24 @@
 #include "CachingNetworkManagerFactory.h"
 
 #include <QNetworkDiskCache>
-#include <QNetworkAccessManager>
 #include <QStandardPaths>
 
+namespace {
+
+const int kDefaultCacheSizeMB = 50;
+const int kDefaultMaximumActiveRequests = 6;
+
+int environmentValue(const char *name, int defaultValue)
+{
+    bool ok;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+} // namespace
+
 CachingNetworkAccessManager::CachingNetworkAccessManager(QObject *parent)
-    : QNetworkAccessManager(parent)
+    : QueuedNetworkAccessManager(parent)
 {
     m_networkingStatus = new connectivityqt::Connectivity(QDBusConnection::sessionBus(), this);
 }
@@ -33,21 +46,27 @@ QNetworkReply* CachingNetworkAccessManager::createRequest(Operation op, const QN
         qDebug() << "Not connected to the internet. Request for" << request.url().toString() << "will be served only from the cache.";
         QNetworkRequest req(request);
         req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysCache);
-        return QNetworkAccessManager::createRequest(op, req, outgoingData);
+        return QueuedNetworkAccessManager::createRequest(op, req, outgoingData);
     }
 
-    return QNetworkAccessManager::createRequest(op, request, outgoingData);
+    return QueuedNetworkAccessManager::createRequest(op, request, outgoingData);
 }
 
 CachingNetworkManagerFactory::CachingNetworkManagerFactory()
+    : m_maximumCacheSize(environmentValue("UNITY8_NETWORK_CACHE_MAX_MB", kDefaultCacheSizeMB) * qint64(1024 * 1024))
+    , m_maximumActiveRequests(environmentValue("UNITY8_NETWORK_MAX_REQUESTS", kDefaultMaximumActiveRequests))
+    , m_staleWhileRevalidate(qgetenv("UNITY8_NETWORK_STALE_WHILE_REVALIDATE") != "0")
 {
 }
 
 QNetworkAccessManager *CachingNetworkManagerFactory::create(QObject *parent) {
-    QNetworkAccessManager *manager = new CachingNetworkAccessManager(parent);
+    CachingNetworkAccessManager *manager = new CachingNetworkAccessManager(parent);
+    manager->setMaximumActiveRequests(m_maximumActiveRequests);
+    manager->setStaleWhileRevalidate(m_staleWhileRevalidate);
 
     QNetworkDiskCache* cache = new QNetworkDiskCache(manager);
     cache->setCacheDirectory(QStringLiteral("%1/network").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+    cache->setMaximumCacheSize(m_maximumCacheSize);
 
     manager->setCache(cache);
     return manager;
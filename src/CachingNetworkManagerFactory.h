@@ -19,11 +19,12 @@
 #define CACHINGNETWORKMANAGERFACTORY_H
 
 #include <QQmlNetworkAccessManagerFactory>
-#include <QNetworkAccessManager>
 
 #include <connectivityqt/connectivity.h>
 
-class CachingNetworkAccessManager : public QNetworkAccessManager
+#include "QueuedNetworkAccessManager.h"
+
+class CachingNetworkAccessManager : public QueuedNetworkAccessManager
 {
 Q_OBJECT
 public:
@@ -36,12 +37,23 @@ private:
     connectivityqt::Connectivity* m_networkingStatus;
 };
 
+/*
+ * The disk cache size, in MB, and how many requests each manager sends at
+ * once can be tuned with UNITY8_NETWORK_CACHE_MAX_MB and
+ * UNITY8_NETWORK_MAX_REQUESTS. Expired cached responses are shown while
+ * they are revalidated unless UNITY8_NETWORK_STALE_WHILE_REVALIDATE is 0.
+ */
 class CachingNetworkManagerFactory : public QQmlNetworkAccessManagerFactory
 {
 public:
     CachingNetworkManagerFactory();
 
     QNetworkAccessManager *create(QObject *parent) override;
+
+private:
+    qint64 m_maximumCacheSize;
+    int m_maximumActiveRequests;
+    bool m_staleWhileRevalidate;
 };
 
 #endif // CACHINGNETWORKMANAGERFACTORY_H
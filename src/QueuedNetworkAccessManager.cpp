@@ -0,0 +1,507 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "QueuedNetworkAccessManager.h"
+
+#include <QAbstractNetworkCache>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QNetworkReply>
+
+namespace {
+
+QMutex urlPrioritiesMutex;
+QHash<QUrl, QNetworkRequest::Priority> urlPriorities;
+// How many setUrlVisible(url, true) calls are not undone yet
+QHash<QUrl, int> urlVisibleCounts;
+
+// Whether the cached response asked not to be used once expired without asking the server
+bool forbidsStale(const QNetworkCacheMetaData &metaData)
+{
+    Q_FOREACH(const QNetworkCacheMetaData::RawHeader &header, metaData.rawHeaders()) {
+        const QByteArray name = header.first.toLower();
+        if (name == "pragma" && header.second.toLower().contains("no-cache")) {
+            return true;
+        }
+        if (name != "cache-control") {
+            continue;
+        }
+        Q_FOREACH(const QByteArray &directive, header.second.split(',')) {
+            const QByteArray directiveName = directive.split('=').first().trimmed().toLower();
+            if (directiveName == "must-revalidate" || directiveName == "proxy-revalidate"
+                    || directiveName == "no-cache" || directiveName == "no-store") {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Attributes the upstream reply sets that callers may look at
+const QNetworkRequest::Attribute replyAttributes[] = {
+    QNetworkRequest::HttpStatusCodeAttribute,
+    QNetworkRequest::HttpReasonPhraseAttribute,
+    QNetworkRequest::RedirectionTargetAttribute,
+    QNetworkRequest::ConnectionEncryptedAttribute,
+    QNetworkRequest::SourceIsFromCacheAttribute,
+    QNetworkRequest::HttpPipeliningWasUsedAttribute,
+    QNetworkRequest::SpdyWasUsedAttribute,
+};
+
+} // namespace
+
+/*
+ * What a caller of QueuedNetworkAccessManager gets back, fed by the
+ * QueuedNetworkJob it shares with the other callers asking for the same url.
+ */
+class QueuedNetworkReply : public QNetworkReply
+{
+Q_OBJECT
+public:
+    QueuedNetworkReply(QueuedNetworkJob *job, const QNetworkRequest &request, QObject *parent);
+    ~QueuedNetworkReply();
+
+    void abort() override;
+    void close() override;
+    qint64 bytesAvailable() const override;
+    bool isSequential() const override { return true; }
+
+    void copyMetaData(QNetworkReply *upstream);
+    void appendData(const QByteArray &data);
+    void finish(NetworkError code, const QString &errorString);
+    void detach();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    QueuedNetworkJob *m_job;
+    QByteArray m_buffer;
+    int m_offset;
+
+    friend class QueuedNetworkAccessManager;
+};
+
+/*
+ * One request to the network, queued or on the wire, and the replies
+ * waiting for it.
+ */
+class QueuedNetworkJob : public QObject
+{
+Q_OBJECT
+public:
+    QueuedNetworkJob(QueuedNetworkAccessManager *manager, const QueuedNetworkAccessManager::JobKey &key, const QNetworkRequest &request)
+        : QObject(manager)
+        , manager(manager)
+        , key(key)
+        , request(request)
+        , upstream(nullptr)
+    {
+    }
+
+    void addReply(QueuedNetworkReply *reply)
+    {
+        replies << reply;
+        if (upstream && !upstream->rawHeaderPairs().isEmpty()) {
+            reply->copyMetaData(upstream);
+        }
+        if (!received.isEmpty()) {
+            reply->appendData(received);
+        }
+    }
+
+    void removeReply(QueuedNetworkReply *reply)
+    {
+        replies.removeOne(reply);
+        if (replies.isEmpty()) {
+            manager->cancel(this);
+        }
+    }
+
+    void start(QNetworkReply *reply)
+    {
+        upstream = reply;
+        connect(upstream, &QNetworkReply::metaDataChanged, this, &QueuedNetworkJob::onMetaDataChanged);
+        connect(upstream, &QIODevice::readyRead, this, &QueuedNetworkJob::onReadyRead);
+        connect(upstream, &QNetworkReply::downloadProgress, this, &QueuedNetworkJob::onDownloadProgress);
+        connect(upstream, &QNetworkReply::finished, this, &QueuedNetworkJob::onFinished);
+    }
+
+    QueuedNetworkAccessManager *manager;
+    const QueuedNetworkAccessManager::JobKey key;
+    QNetworkRequest request;
+    QNetworkReply *upstream;
+    QList<QueuedNetworkReply*> replies;
+    // Everything read so far, for replies that join late
+    QByteArray received;
+
+private Q_SLOTS:
+    void onMetaDataChanged()
+    {
+        Q_FOREACH(QueuedNetworkReply *reply, replies) {
+            reply->copyMetaData(upstream);
+        }
+    }
+
+    void onReadyRead()
+    {
+        const QByteArray data = upstream->readAll();
+        if (data.isEmpty()) {
+            return;
+        }
+        received += data;
+        Q_FOREACH(QueuedNetworkReply *reply, replies) {
+            reply->appendData(data);
+        }
+    }
+
+    void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+    {
+        Q_FOREACH(QueuedNetworkReply *reply, replies) {
+            Q_EMIT reply->downloadProgress(bytesReceived, bytesTotal);
+        }
+    }
+
+    void onFinished()
+    {
+        onReadyRead();
+        const QList<QueuedNetworkReply*> finishedReplies = replies;
+        replies.clear();
+        Q_FOREACH(QueuedNetworkReply *reply, finishedReplies) {
+            reply->copyMetaData(upstream);
+            reply->finish(upstream->error(), upstream->errorString());
+        }
+        manager->jobFinished(this);
+    }
+};
+
+QueuedNetworkReply::QueuedNetworkReply(QueuedNetworkJob *job, const QNetworkRequest &request, QObject *parent)
+    : QNetworkReply(parent)
+    , m_job(job)
+    , m_offset(0)
+{
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(QNetworkAccessManager::GetOperation);
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+QueuedNetworkReply::~QueuedNetworkReply()
+{
+    detach();
+}
+
+void QueuedNetworkReply::abort()
+{
+    if (isFinished()) {
+        return;
+    }
+    detach();
+    finish(OperationCanceledError, tr("Operation canceled"));
+}
+
+void QueuedNetworkReply::close()
+{
+    abort();
+    QNetworkReply::close();
+}
+
+qint64 QueuedNetworkReply::bytesAvailable() const
+{
+    return m_buffer.size() - m_offset + QNetworkReply::bytesAvailable();
+}
+
+void QueuedNetworkReply::copyMetaData(QNetworkReply *upstream)
+{
+    Q_FOREACH(const RawHeaderPair &header, upstream->rawHeaderPairs()) {
+        setRawHeader(header.first, header.second);
+    }
+    for (QNetworkRequest::Attribute attribute : replyAttributes) {
+        setAttribute(attribute, upstream->attribute(attribute));
+    }
+    Q_EMIT metaDataChanged();
+}
+
+void QueuedNetworkReply::appendData(const QByteArray &data)
+{
+    if (m_offset == m_buffer.size()) {
+        m_buffer.clear();
+        m_offset = 0;
+    }
+    m_buffer += data;
+    Q_EMIT readyRead();
+}
+
+void QueuedNetworkReply::finish(NetworkError code, const QString &errorString)
+{
+    m_job = nullptr;
+    if (code != NoError) {
+        setError(code, errorString);
+    }
+    setFinished(true);
+    if (code != NoError) {
+        Q_EMIT error(code);
+    }
+    Q_EMIT finished();
+}
+
+void QueuedNetworkReply::detach()
+{
+    if (m_job) {
+        QueuedNetworkJob *job = m_job;
+        m_job = nullptr;
+        job->removeReply(this);
+    }
+}
+
+qint64 QueuedNetworkReply::readData(char *data, qint64 maxSize)
+{
+    const qint64 available = m_buffer.size() - m_offset;
+    if (available == 0) {
+        return isFinished() ? -1 : 0;
+    }
+    const qint64 size = qMin(available, maxSize);
+    memcpy(data, m_buffer.constData() + m_offset, size);
+    m_offset += size;
+    return size;
+}
+
+QueuedNetworkAccessManager::QueuedNetworkAccessManager(QObject *parent)
+    : QNetworkAccessManager(parent)
+    , m_maximumActiveRequests(6)
+    , m_activeRequests(0)
+    , m_staleWhileRevalidate(false)
+{
+}
+
+QueuedNetworkAccessManager::~QueuedNetworkAccessManager()
+{
+    // The replies outlive us as our children for a bit, make sure they
+    // don't call back
+    Q_FOREACH(QueuedNetworkJob *job, m_jobs) {
+        Q_FOREACH(QueuedNetworkReply *reply, job->replies) {
+            reply->m_job = nullptr;
+        }
+        if (job->upstream) {
+            job->upstream->disconnect(job);
+        }
+        delete job;
+    }
+}
+
+int QueuedNetworkAccessManager::maximumActiveRequests() const
+{
+    return m_maximumActiveRequests;
+}
+
+void QueuedNetworkAccessManager::setMaximumActiveRequests(int maximum)
+{
+    m_maximumActiveRequests = qMax(1, maximum);
+    dispatch();
+}
+
+int QueuedNetworkAccessManager::activeRequests() const
+{
+    return m_activeRequests;
+}
+
+int QueuedNetworkAccessManager::queuedRequests() const
+{
+    return m_queue.count();
+}
+
+bool QueuedNetworkAccessManager::staleWhileRevalidate() const
+{
+    return m_staleWhileRevalidate;
+}
+
+void QueuedNetworkAccessManager::setStaleWhileRevalidate(bool staleWhileRevalidate)
+{
+    m_staleWhileRevalidate = staleWhileRevalidate;
+}
+
+void QueuedNetworkAccessManager::setUrlPriority(const QUrl &url, QNetworkRequest::Priority priority)
+{
+    QMutexLocker lock(&urlPrioritiesMutex);
+    urlPriorities.insert(url, priority);
+}
+
+void QueuedNetworkAccessManager::clearUrlPriority(const QUrl &url)
+{
+    QMutexLocker lock(&urlPrioritiesMutex);
+    urlPriorities.remove(url);
+}
+
+void QueuedNetworkAccessManager::setUrlVisible(const QUrl &url, bool visible)
+{
+    QMutexLocker lock(&urlPrioritiesMutex);
+
+    // Several items can show the same url, it is visible while any of them is
+    if (visible) {
+        if (++urlVisibleCounts[url] == 1) {
+            urlPriorities.insert(url, QNetworkRequest::HighPriority);
+        }
+    } else {
+        auto it = urlVisibleCounts.find(url);
+        if (it != urlVisibleCounts.end() && --it.value() == 0) {
+            urlVisibleCounts.erase(it);
+            urlPriorities.remove(url);
+        }
+    }
+}
+
+QNetworkRequest::Priority QueuedNetworkAccessManager::effectivePriority(const QNetworkRequest &request)
+{
+    QMutexLocker lock(&urlPrioritiesMutex);
+    return urlPriorities.value(request.url(), request.priority());
+}
+
+QNetworkReply* QueuedNetworkAccessManager::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData)
+{
+    if (op != GetOperation || outgoingData) {
+        return QNetworkAccessManager::createRequest(op, request, outgoingData);
+    }
+
+    if (m_staleWhileRevalidate && request.attribute(QNetworkRequest::CacheLoadControlAttribute).isNull() && isStale(request.url())) {
+        // Reading the cache is cheap, no need to queue it
+        QNetworkRequest cachedRequest(request);
+        cachedRequest.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+        QNetworkReply *reply = QNetworkAccessManager::createRequest(op, cachedRequest, nullptr);
+        revalidate(request);
+        return reply;
+    }
+
+    return enqueue(request);
+}
+
+QNetworkReply* QueuedNetworkAccessManager::enqueue(const QNetworkRequest &request)
+{
+    // Requests that want different things from the cache can't be shared
+    const JobKey key(request.url(), request.attribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork).toInt());
+    QueuedNetworkJob *job = m_jobs.value(key);
+    if (!job) {
+        job = new QueuedNetworkJob(this, key, request);
+        m_jobs.insert(key, job);
+        m_queue << job;
+    } else if (request.priority() < job->request.priority()) {
+        // Lower values are more important
+        job->request.setPriority(request.priority());
+    }
+
+    QueuedNetworkReply *reply = new QueuedNetworkReply(job, request, this);
+    job->addReply(reply);
+
+    dispatch();
+
+    return reply;
+}
+
+bool QueuedNetworkAccessManager::isStale(const QUrl &url) const
+{
+    if (!cache()) {
+        return false;
+    }
+
+    const QNetworkCacheMetaData metaData = cache()->metaData(url);
+    if (!metaData.isValid() || forbidsStale(metaData)) {
+        return false;
+    }
+
+    // Without an expiration date QNetworkAccessManager would guess one
+    // from the last modification, just ask the network instead
+    return !metaData.expirationDate().isValid() || metaData.expirationDate() <= QDateTime::currentDateTimeUtc();
+}
+
+void QueuedNetworkAccessManager::revalidate(const QNetworkRequest &request)
+{
+    if (m_revalidating.contains(request.url())) {
+        return;
+    }
+    m_revalidating.insert(request.url());
+
+    // The network layer turns this into a conditional request on the
+    // cached ETag and Last-Modified, and updates the cache with the answer
+    QNetworkRequest revalidation(request);
+    revalidation.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
+    revalidation.setPriority(QNetworkRequest::LowPriority);
+
+    QNetworkReply *reply = enqueue(revalidation);
+    connect(reply, &QNetworkReply::finished, this, [this, reply] {
+        const QUrl url = reply->request().url();
+        m_revalidating.remove(url);
+        // A 304 is answered from the cache
+        if (reply->error() == QNetworkReply::NoError && !reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool()) {
+            Q_EMIT updated(url);
+        }
+        reply->deleteLater();
+    });
+}
+
+void QueuedNetworkAccessManager::dispatch()
+{
+    while (m_activeRequests < m_maximumActiveRequests && !m_queue.isEmpty()) {
+        int next = 0;
+        QNetworkRequest::Priority nextPriority = effectivePriority(m_queue.first()->request);
+        for (int i = 1; i < m_queue.count() && nextPriority != QNetworkRequest::HighPriority; ++i) {
+            const QNetworkRequest::Priority priority = effectivePriority(m_queue[i]->request);
+            if (priority < nextPriority) {
+                next = i;
+                nextPriority = priority;
+            }
+        }
+        start(m_queue.takeAt(next));
+    }
+}
+
+void QueuedNetworkAccessManager::start(QueuedNetworkJob *job)
+{
+    ++m_activeRequests;
+    job->start(QNetworkAccessManager::createRequest(GetOperation, job->request, nullptr));
+}
+
+void QueuedNetworkAccessManager::cancel(QueuedNetworkJob *job)
+{
+    if (m_jobs.value(job->key) == job) {
+        m_jobs.remove(job->key);
+    }
+
+    if (job->upstream) {
+        job->upstream->disconnect(job);
+        job->upstream->abort();
+        jobFinished(job);
+    } else {
+        m_queue.removeOne(job);
+        job->deleteLater();
+    }
+}
+
+void QueuedNetworkAccessManager::jobFinished(QueuedNetworkJob *job)
+{
+    if (m_jobs.value(job->key) == job) {
+        m_jobs.remove(job->key);
+    }
+    --m_activeRequests;
+
+    job->upstream->disconnect(job);
+    job->upstream->deleteLater();
+    job->deleteLater();
+
+    dispatch();
+}
+
+#include "QueuedNetworkAccessManager.moc"
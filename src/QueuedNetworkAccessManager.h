@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef QUEUEDNETWORKACCESSMANAGER_H
+#define QUEUEDNETWORKACCESSMANAGER_H
+
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QPair>
+#include <QSet>
+
+class QueuedNetworkJob;
+
+/*
+ * A QNetworkAccessManager that queues GET requests instead of sending them
+ * all at once.
+ *
+ * At most maximumActiveRequests() requests are on the wire, the rest wait
+ * in a queue that is served by priority and, for the same priority, in the
+ * order they were made. The priority of a request is the one set with
+ * setUrlPriority() for its url, if any, or QNetworkRequest::priority().
+ * Priorities are looked up when a request leaves the queue, so a url can
+ * be moved ahead (e.g. when its delegate becomes visible) while it waits.
+ * Plugins that only see the engine's QNetworkAccessManager can do so with
+ * the setUrlVisible() invokable, which keeps the url ahead until every item
+ * that showed it is hidden again.
+ *
+ * Concurrent GETs for the same url share a single request, each caller
+ * still gets its own reply. Aborting a reply only cancels the shared
+ * request once no other reply is waiting for it.
+ *
+ * Other operations, and requests with a body, are sent right away.
+ *
+ * With staleWhileRevalidate set, a GET for a url whose cached copy has
+ * expired is answered from the cache() right away. A low priority
+ * conditional request then refreshes the cache behind it, and updated()
+ * is emitted if the network had something newer. Nothing in the shell
+ * listens to updated() yet, the new copy is shown the next time the url
+ * is loaded. Responses that were sent with must-revalidate, no-cache or
+ * no-store, and requests that set their own CacheLoadControlAttribute,
+ * are left alone.
+ */
+class QueuedNetworkAccessManager : public QNetworkAccessManager
+{
+Q_OBJECT
+public:
+    QueuedNetworkAccessManager(QObject *parent = 0);
+    ~QueuedNetworkAccessManager();
+
+    int maximumActiveRequests() const;
+    void setMaximumActiveRequests(int maximum);
+
+    int activeRequests() const;
+    int queuedRequests() const;
+
+    bool staleWhileRevalidate() const;
+    void setStaleWhileRevalidate(bool staleWhileRevalidate);
+
+    // Process wide, can be called from any thread
+    static void setUrlPriority(const QUrl &url, QNetworkRequest::Priority priority);
+    static void clearUrlPriority(const QUrl &url);
+
+    // HighPriority while visible, the request's own priority otherwise.
+    // Counted, every call with visible true needs its call with false.
+    Q_INVOKABLE void setUrlVisible(const QUrl &url, bool visible);
+
+Q_SIGNALS:
+    void updated(const QUrl &url);
+
+protected:
+    QNetworkReply* createRequest(Operation op, const QNetworkRequest &req, QIODevice *outgoingData = 0) override;
+
+private:
+    typedef QPair<QUrl, int> JobKey;
+
+    static QNetworkRequest::Priority effectivePriority(const QNetworkRequest &request);
+
+    QNetworkReply* enqueue(const QNetworkRequest &request);
+    bool isStale(const QUrl &url) const;
+    void revalidate(const QNetworkRequest &request);
+    void dispatch();
+    void start(QueuedNetworkJob *job);
+    void cancel(QueuedNetworkJob *job);
+    void jobFinished(QueuedNetworkJob *job);
+
+    QHash<JobKey, QueuedNetworkJob*> m_jobs;
+    QList<QueuedNetworkJob*> m_queue;
+    int m_maximumActiveRequests;
+    int m_activeRequests;
+    bool m_staleWhileRevalidate;
+    QSet<QUrl> m_revalidating;
+
+    friend class QueuedNetworkJob;
+    friend class QueuedNetworkReply;
+};
+
+#endif // QUEUEDNETWORKACCESSMANAGER_H
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include "CursorAtlas.h"
+#include "CursorImageProvider.h"
+
+class CursorAtlasTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // A cursor with frameCount frames of frameWidth x frameHeight in a row,
+    // each frame filled with its own color
+    CursorImage *cursorImage(int frameWidth, int frameHeight, int frameCount = 1)
+    {
+        CursorImage *image = new CursorImage;
+        image->qimage = QImage(frameWidth * frameCount, frameHeight, QImage::Format_ARGB32);
+        for (int i = 0; i < frameCount; ++i) {
+            const QRgb color = qRgba(images.count() * 20 % 256, i * 30 % 256, frameWidth % 256, 255);
+            for (int y = 0; y < frameHeight; ++y) {
+                for (int x = 0; x < frameWidth; ++x) {
+                    image->qimage.setPixel(i * frameWidth + x, y, color);
+                }
+            }
+        }
+        image->hotspot = QPoint(frameWidth / 2, frameHeight / 3);
+        image->frameWidth = frameWidth;
+        image->frameHeight = frameHeight;
+        image->frameCount = frameCount;
+        images << image;
+        return image;
+    }
+
+    static QRect framesRect(const CursorAtlas::Cursor &cursor)
+    {
+        return QRect(cursor.position, QSize(cursor.frameWidth * cursor.frameCount, cursor.frameHeight));
+    }
+
+    static int generation(const QUrl &source)
+    {
+        return source.toString().section('/', -1).toInt();
+    }
+
+private Q_SLOTS:
+
+    void cleanup()
+    {
+        qDeleteAll(images);
+        images.clear();
+    }
+
+    void testShelfPacking()
+    {
+        QList<QPair<QString, const CursorImage*> > cursors;
+        cursors << qMakePair(QStringLiteral("left_ptr"), (const CursorImage*) cursorImage(24, 24));
+        cursors << qMakePair(QStringLiteral("ibeam"), (const CursorImage*) cursorImage(8, 24));
+        cursors << qMakePair(QStringLiteral("hand"), (const CursorImage*) cursorImage(20, 22));
+        cursors << qMakePair(QStringLiteral("size_all"), (const CursorImage*) cursorImage(30, 30));
+        cursors << qMakePair(QStringLiteral("cross"), (const CursorImage*) cursorImage(17, 17));
+        cursors << qMakePair(QStringLiteral("up_arrow"), (const CursorImage*) cursorImage(12, 26));
+        // Animated, wider than all the others together are tall
+        cursors << qMakePair(QStringLiteral("watch"), (const CursorImage*) cursorImage(24, 24, 20));
+        cursors << qMakePair(QStringLiteral("left_ptr_watch"), (const CursorImage*) cursorImage(24, 24, 6));
+
+        CursorAtlas atlas(QStringLiteral("theme"), 24, 7, cursors);
+        QCOMPARE(atlas.cursorNames().count(), cursors.count());
+        QCOMPARE(atlas.source(), QUrl("image://cursor/atlas/theme/24/7"));
+
+        const QRect atlasRect = atlas.image().rect();
+        for (int i = 0; i < cursors.count(); ++i) {
+            const CursorImage *source = cursors[i].second;
+            const CursorAtlas::Cursor cursor = atlas.cursor(cursors[i].first);
+            QCOMPARE(cursor.hotspot, source->hotspot);
+            QCOMPARE(cursor.frameCount, source->frameCount);
+
+            // The whole row of frames fits, even the animation wider than the rest
+            const QRect rect = framesRect(cursor);
+            QVERIFY2(atlasRect.contains(rect), qPrintable(cursors[i].first));
+            QCOMPARE(atlas.image().copy(rect), source->qimage);
+
+            for (int j = i + 1; j < cursors.count(); ++j) {
+                const QRect other = framesRect(atlas.cursor(cursors[j].first));
+                QVERIFY2(!rect.intersects(other), qPrintable(cursors[i].first + " overlaps " + cursors[j].first));
+            }
+        }
+    }
+
+    void testFallbacksShareFrames()
+    {
+        const CursorImage *leftPtr = cursorImage(24, 24);
+        const CursorImage *hand = cursorImage(20, 22);
+
+        QList<QPair<QString, const CursorImage*> > cursors;
+        cursors << qMakePair(QStringLiteral("left_ptr"), leftPtr);
+        cursors << qMakePair(QStringLiteral("hand"), hand);
+        // Not in the theme, resolved to what left_ptr is
+        cursors << qMakePair(QStringLiteral("watch"), leftPtr);
+        cursors << qMakePair(QStringLiteral("whats_this"), leftPtr);
+
+        CursorAtlas atlas(QStringLiteral("theme"), 24, 1, cursors);
+        QCOMPARE(atlas.cursorNames().count(), 4);
+        QCOMPARE(atlas.cursor("watch").position, atlas.cursor("left_ptr").position);
+        QCOMPARE(atlas.cursor("whats_this").position, atlas.cursor("left_ptr").position);
+        QVERIFY(atlas.cursor("hand").position != atlas.cursor("left_ptr").position);
+
+        // Only two sprites were packed
+        CursorAtlas twoCursors(QStringLiteral("theme"), 24, 2, cursors.mid(0, 2));
+        QCOMPARE(atlas.image().size(), twoCursors.image().size());
+    }
+
+    void testNullImagesSkipped()
+    {
+        QList<QPair<QString, const CursorImage*> > cursors;
+        cursors << qMakePair(QStringLiteral("left_ptr"), (const CursorImage*) cursorImage(24, 24));
+        cursors << qMakePair(QStringLiteral("empty"), (const CursorImage*) cursorImage(0, 0));
+        cursors << qMakePair(QStringLiteral("missing"), (const CursorImage*) nullptr);
+
+        CursorAtlas atlas(QStringLiteral("theme"), 24, 1, cursors);
+        QVERIFY(atlas.contains("left_ptr"));
+        QVERIFY(!atlas.contains("empty"));
+        QVERIFY(!atlas.contains("missing"));
+    }
+
+    void testUnknownNameBumpsGeneration()
+    {
+        CursorImageProvider provider;
+        QSignalSpy readySpy(&provider, &CursorImageProvider::atlasReady);
+        CursorAtlas::Cursor cursor;
+        QUrl source;
+
+        QVERIFY(!provider.fetchCursor("unity8-test-theme", "left_ptr", 32, &cursor, &source));
+        QTRY_COMPARE(readySpy.count(), 1);
+        QVERIFY(provider.fetchCursor("unity8-test-theme", "left_ptr", 32, &cursor, &source));
+        const QUrl firstSource = source;
+
+        // Names that are always packed don't need a new atlas
+        QVERIFY(provider.fetchCursor("unity8-test-theme", "hand", 32, &cursor, &source));
+        QCOMPARE(source, firstSource);
+
+        QVERIFY(!provider.fetchCursor("unity8-test-theme", "unity8-made-up-name", 32, &cursor, &source));
+        QTRY_COMPARE(readySpy.count(), 2);
+        QCOMPARE(readySpy.last().at(0).toString(), QStringLiteral("unity8-test-theme"));
+        QCOMPARE(readySpy.last().at(1).toInt(), 32);
+        QVERIFY(provider.fetchCursor("unity8-test-theme", "unity8-made-up-name", 32, &cursor, &source));
+        QVERIFY(generation(source) > generation(firstSource));
+
+        // The older cursors come out of the new atlas too
+        QVERIFY(provider.fetchCursor("unity8-test-theme", "left_ptr", 32, &cursor, &source));
+        QVERIFY(generation(source) > generation(firstSource));
+    }
+
+private:
+    QList<CursorImage*> images;
+};
+
+QTEST_MAIN(CursorAtlasTest)
+
+#include "cursoratlastest.moc"
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "CursorImageProvider.h"
+
+// Same as in CursorImageProvider.cpp
+static const qint64 kMaxAtlasBytes = 4 * 1024 * 1024;
+
+class CursorImageProviderTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Waits for the atlas to load if needed
+    void fetch(int cursorHeight, const QString &cursorName = QStringLiteral("left_ptr"),
+               CursorAtlas::Cursor *cursor = nullptr, QUrl *source = nullptr)
+    {
+        CursorAtlas::Cursor fetchedCursor;
+        QUrl fetchedSource;
+        QTRY_VERIFY(provider->fetchCursor(theme, cursorName, cursorHeight, &fetchedCursor, &fetchedSource));
+        if (cursor) *cursor = fetchedCursor;
+        if (source) *source = fetchedSource;
+    }
+
+    QImage requestImage(const QUrl &source)
+    {
+        QSize size;
+        return provider->requestImage(source.toString().mid(QStringLiteral("image://cursor/").length()), &size, QSize());
+    }
+
+    // Loads atlases, keeping the one at height 32 in use, until the oldest one is evicted
+    void fillUntilEviction()
+    {
+        fetch(32);
+        for (int cursorHeight = 300; provider->m_evictedAtlases.isEmpty() && cursorHeight < 2000; cursorHeight += 50) {
+            fetch(cursorHeight);
+            fetch(32);
+        }
+        QVERIFY(!provider->m_evictedAtlases.isEmpty());
+    }
+
+    qint64 atlasBytes() const
+    {
+        qint64 byteCount = 0;
+        Q_FOREACH(const CursorAtlas *atlas, provider->m_atlases) {
+            byteCount += atlas->byteCount();
+        }
+        return byteCount;
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        // No themes, every cursor is the built-in one at the requested height
+        QVERIFY(cursorDir.isValid());
+        qputenv("XCURSOR_PATH", cursorDir.path().toLocal8Bit());
+    }
+
+    void init()
+    {
+        provider = new CursorImageProvider();
+    }
+
+    void cleanup()
+    {
+        delete provider;
+        provider = nullptr;
+    }
+
+    void testFetchLoadsInTheBackground()
+    {
+        QSignalSpy readySpy(provider, &CursorImageProvider::atlasReady);
+        CursorAtlas::Cursor cursor;
+        QUrl source;
+
+        QVERIFY(!provider->fetchCursor(theme, "left_ptr", 32, &cursor, &source));
+        QVERIFY(provider->m_loadingAtlases.contains(CursorImageProvider::atlasKey(theme, 32)));
+
+        // Asking again while it loads doesn't start another load
+        QVERIFY(!provider->fetchCursor(theme, "hand", 32, &cursor, &source));
+        QCOMPARE(provider->m_pendingLoads.count(), 1);
+
+        QTRY_COMPARE(readySpy.count(), 1);
+        QCOMPARE(readySpy.first().at(0).toString(), theme);
+        QCOMPARE(readySpy.first().at(1).toInt(), 32);
+        QVERIFY(provider->m_loadingAtlases.isEmpty());
+
+        QVERIFY(provider->fetchCursor(theme, "left_ptr", 32, &cursor, &source));
+        QCOMPARE(cursor.frameHeight, 32);
+        const QImage atlasImage = requestImage(source);
+        QVERIFY(!atlasImage.isNull());
+        QVERIFY(atlasImage.rect().contains(QRect(cursor.position, QSize(cursor.frameWidth * cursor.frameCount, cursor.frameHeight))));
+        QCOMPARE(readySpy.count(), 1);
+    }
+
+    void testLeastRecentlyUsedEvicted()
+    {
+        fillUntilEviction();
+
+        QVERIFY(provider->m_atlases.contains(CursorImageProvider::atlasKey(theme, 32)));
+        QVERIFY(provider->m_evictedAtlases.contains(CursorImageProvider::atlasKey(theme, 300)));
+        QVERIFY(!provider->m_atlases.contains(CursorImageProvider::atlasKey(theme, 300)));
+        QVERIFY(atlasBytes() <= kMaxAtlasBytes);
+        QCOMPARE(provider->m_atlasesByUse.count(), provider->m_atlases.count());
+        QCOMPARE(provider->m_atlasesByUse.last(), CursorImageProvider::atlasKey(theme, 32));
+    }
+
+    void testEvictedAtlasRebuiltAsItWas()
+    {
+        // Not one of the names every atlas has
+        CursorAtlas::Cursor cursor;
+        QUrl source;
+        fetch(300, "unity8-made-up-name", &cursor, &source);
+        const QImage image = requestImage(source);
+
+        fillUntilEviction();
+        QVERIFY(!provider->m_atlases.contains(CursorImageProvider::atlasKey(theme, 300)));
+
+        // Still shown by a cursor, which asks for it again
+        QSignalSpy readySpy(provider, &CursorImageProvider::atlasReady);
+        QCOMPARE(requestImage(source), image);
+        QVERIFY(provider->m_atlases.contains(CursorImageProvider::atlasKey(theme, 300)));
+
+        // Same source and frames, nobody needs to be told
+        CursorAtlas::Cursor rebuiltCursor;
+        QUrl rebuiltSource;
+        QVERIFY(provider->fetchCursor(theme, "unity8-made-up-name", 300, &rebuiltCursor, &rebuiltSource));
+        QCOMPARE(rebuiltSource, source);
+        QCOMPARE(rebuiltCursor.position, cursor.position);
+        QCOMPARE(readySpy.count(), 0);
+    }
+
+    void testUnknownAtlasBuiltOnRequest()
+    {
+        QSignalSpy readySpy(provider, &CursorImageProvider::atlasReady);
+
+        QSize size;
+        const QImage image = provider->requestImage(QStringLiteral("atlas/%1/48/1").arg(theme), &size, QSize());
+        QVERIFY(!image.isNull());
+        QCOMPARE(size, image.size());
+
+        // Whoever asked needs the cursors of this new atlas
+        QTRY_COMPARE(readySpy.count(), 1);
+        CursorAtlas::Cursor cursor;
+        QUrl source;
+        QVERIFY(provider->fetchCursor(theme, "left_ptr", 48, &cursor, &source));
+    }
+
+private:
+    const QString theme{QStringLiteral("unity8-test-theme")};
+    QTemporaryDir cursorDir;
+    CursorImageProvider *provider = nullptr;
+};
+
+QTEST_MAIN(CursorImageProviderTest)
+
+#include "cursorimageprovidertest.moc"
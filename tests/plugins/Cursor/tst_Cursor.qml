@@ -45,7 +45,9 @@ Rectangle {
 
             x: -imageInfo.hotspot.x
             y: -imageInfo.hotspot.y
-            source: "image://cursor/" + root.themeName + "/" + root.cursorName + "/" + root.cursorHeight
+            source: imageInfo.imageSource
+            frameX: imageInfo.frameX
+            frameY: imageInfo.frameY
 
             interpolate: false
 
@@ -145,6 +147,7 @@ Rectangle {
             Text { text: "frameHeight: " + imageInfo.frameHeight }
             Text { text: "frameCount: " + imageInfo.frameCount }
             Text { text: "frameDuration: " + imageInfo.frameDuration }
+            Text { text: "frameX: " + imageInfo.frameX + " frameY: " + imageInfo.frameY }
             Text { text: "currentFrame: " + animatedSprite.currentFrame }
         }
     }
@@ -15,15 +15,26 @@
  */
 
 #include <QDir>
+#include <QJsonDocument>
+#include <QQmlComponent>
+#include <QQmlContext>
 #include <QQmlEngine>
+#include <QQmlExpression>
+#include <QQmlProperty>
 #include <QQuickItem>
 #include <QQuickView>
+#include <QStandardPaths>
 #include <QtTestGui>
 #include <QDebug>
 #include <QTemporaryFile>
 
+#include <utime.h>
+
 #include <paths.h>
 
+#include "cardcreator.h"
+#include "cardcreatorcache.h"
+
 class CardCreatorTest : public QObject
 {
     Q_OBJECT
@@ -32,15 +43,19 @@ private Q_SLOTS:
 
     void initTestCase()
     {
+        // Keep the cards cached on disk away from the real cache
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
+    void cleanupTestCase()
+    {
+        QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/unity8/cards").removeRecursively();
     }
 
     void init()
     {
         view = new QQuickView();
-        if (isRunningInstalled())
-            view->setSource(QUrl::fromLocalFile(testLibDir() + "/" TEST_DIR "/cardcreatortest.qml"));
-        else
-            view->setSource(QUrl::fromLocalFile(testDataDir() + "/" TEST_DIR "/cardcreatortest.qml"));
+        view->setSource(QUrl::fromLocalFile(testDataDir() + "/" TEST_DIR "/cardcreatortest.qml"));
         view->show();
         QTest::qWaitForWindowExposed(view);
     }
@@ -117,6 +132,137 @@ private Q_SLOTS:
         }
     }
 
+    void testCardContext()
+    {
+        // The template and components of the 1.tst fixture
+        QFile testFile(testDataDir() + "/" TEST_DIR "/cardcreator/1.tst");
+        QVERIFY(testFile.open(QIODevice::ReadOnly));
+        const QStringList lines = QString::fromUtf8(testFile.readAll()).split("\n");
+        const QVariantMap cardTemplate = QJsonDocument::fromJson(lines[0].mid(QString("template: ").length()).toUtf8()).toVariant().toMap();
+        const QVariantMap components = QJsonDocument::fromJson(lines[1].mid(QString("components: ").length()).toUtf8()).toVariant().toMap();
+
+        CardCreator creator(view->engine());
+        QQmlComponent *component = creator.createCardComponent(cardTemplate, components, false, "flat");
+        QVERIFY(component);
+
+        // There's no creation context, the views create the cards in their own
+        // context and they reach the units of Ubuntu.Components through it
+        QCOMPARE(component->creationContext(), (QQmlContext*) nullptr);
+        QQmlContext viewContext(view->engine()->rootContext());
+        QObject *object = component->beginCreate(&viewContext);
+        QVERIFY(object);
+        object->setProperty("cardData", QVariantMap({ { "title", "Title" }, { "art", "" } }));
+        component->completeCreate();
+        QScopedPointer<QObject> card(object);
+
+        QCOMPARE(QQmlEngine::contextForObject(card.data())->parentContext(), &viewContext);
+        QObject *titleLabel = card->findChild<QObject*>("titleLabel");
+        QVERIFY(titleLabel);
+        const qreal gridUnit = QQmlExpression(view->engine()->rootContext(), nullptr, "units.gu(1)").evaluate().toReal();
+        QVERIFY(gridUnit > 0);
+        QCOMPARE(QQmlProperty::read(titleLabel, "anchors.topMargin").toReal(), gridUnit);
+    }
+
+    void testDiskCache()
+    {
+        const QVariantMap cardTemplate = { { "card-layout", "horizontal" } };
+        const QVariantMap components = { { "title", QVariantMap({ { "field", "title" } }) } };
+
+        CardCreator creator(view->engine());
+        QQmlComponent *component = creator.createCardComponent(cardTemplate, components, false, "flat");
+        QVERIFY(component);
+        QVERIFY(component->url().isLocalFile());
+
+        QFile cachedCard(component->url().toLocalFile());
+        QVERIFY(cachedCard.open(QIODevice::ReadWrite));
+        QVERIFY(QString::fromUtf8(cachedCard.readAll()).endsWith(creator.cardString(cardTemplate, components, false, "flat")));
+
+        // On the next start the cached card is used instead of generating it again
+        cachedCard.resize(0);
+        cachedCard.write("import QtQuick 2.4\nItem { objectName: \"cachedCard\" }\n");
+        cachedCard.close();
+
+        QQmlEngine engine;
+        CardCreator nextStartCreator(&engine);
+        component = nextStartCreator.createCardComponent(cardTemplate, components, false, "flat");
+        QVERIFY(component);
+        QScopedPointer<QObject> card(component->create());
+        QVERIFY(card);
+        QCOMPARE(card->objectName(), QString("cachedCard"));
+
+        // A different input is a different card
+        component = nextStartCreator.createCardComponent(cardTemplate, components, true, "flat");
+        QVERIFY(component);
+        QVERIFY(component->url() != QUrl::fromLocalFile(cachedCard.fileName()));
+    }
+
+    void testDiskCacheCleanup()
+    {
+        const QVariantMap components = { { "title", QVariantMap({ { "field", "title" } }) } };
+
+        CardCreator creator(view->engine());
+        QQmlComponent *component = creator.createCardComponent(QVariantMap(), components, false, "flat");
+        QVERIFY(component);
+        const QFileInfo usedCard(component->url().toLocalFile());
+        QDir cacheDir = usedCard.dir();
+        QVERIFY(cacheDir.dirName().startsWith(QString(CARDCREATOR_SOURCE_HASH).left(12)));
+
+        // Left by a different version of the generator
+        QDir cacheRoot(cacheDir);
+        QVERIFY(cacheRoot.cdUp());
+        QVERIFY(cacheRoot.mkpath("0123456789ab-qt5.0.0"));
+
+        // Older than the card just used, and the ones other tests made, the oldest first
+        const int recentCards = cacheDir.entryList(QStringList() << "*.qml", QDir::Files).count();
+        for (int i = 0; i < CardCreator::maxCachedCards + 10; ++i) {
+            const QString path = cacheDir.filePath(QString("old%1.qml").arg(i));
+            QFile oldCard(path);
+            QVERIFY(oldCard.open(QIODevice::WriteOnly));
+            oldCard.close();
+            const time_t time = QDateTime::currentDateTime().addDays(-1).addSecs(i).toTime_t();
+            const utimbuf times = { time, time };
+            QCOMPARE(utime(QFile::encodeName(path).constData(), &times), 0);
+        }
+
+        CardCreator nextStartCreator(view->engine());
+        QVERIFY(!cacheRoot.exists("0123456789ab-qt5.0.0"));
+        QCOMPARE(cacheDir.entryList(QStringList() << "*.qml", QDir::Files).count(), CardCreator::maxCachedCards);
+        QVERIFY(cacheDir.exists(usedCard.fileName()));
+        for (int i = 0; i < recentCards + 10; ++i) {
+            QVERIFY(!cacheDir.exists(QString("old%1.qml").arg(i)));
+        }
+        QVERIFY(cacheDir.exists(QString("old%1.qml").arg(recentCards + 10)));
+    }
+
+    void testCardCreatorCache()
+    {
+        CardCreatorCache cache(view->engine());
+        const QVariantMap components = { { "title", QVariantMap({ { "field", "title" } }) }, { "art", QVariantMap({ { "field", "art" }, { "aspect-ratio", 1 } }) } };
+
+        QVERIFY(!cache.getCardComponent(QVariant(), components, false, "flat", "grid"));
+        QCOMPARE(cache.misses(), 0);
+
+        QQmlComponent *component = cache.getCardComponent(QVariantMap(), components, false, "flat", "grid");
+        QVERIFY(component);
+        QCOMPARE(cache.hits(), 0);
+        QCOMPARE(cache.misses(), 1);
+
+        // Equal but separately built maps, with a number that is a double this time, are a hit
+        QVariantMap equalComponents;
+        equalComponents.insert("art", QVariantMap({ { "aspect-ratio", 1.0 }, { "field", "art" } }));
+        equalComponents.insert("title", QVariantMap({ { "field", "title" } }));
+        QCOMPARE(cache.getCardComponent(QVariantMap(), equalComponents, false, "flat", "grid"), component);
+        QCOMPARE(cache.hits(), 1);
+        QCOMPARE(cache.misses(), 1);
+
+        QVERIFY(cache.getCardComponent(QVariantMap(), components, true, "flat", "grid") != component);
+        QVERIFY(cache.getCardComponent(QVariantMap(), components, false, "inset", "grid") != component);
+        QVERIFY(cache.getCardComponent(QVariantMap(), components, false, "flat", "journal") != component);
+        QVERIFY(cache.getCardComponent(QVariantMap({ { "card-layout", "horizontal" } }), components, false, "flat", "grid") != component);
+        QCOMPARE(cache.hits(), 1);
+        QCOMPARE(cache.misses(), 5);
+    }
+
 private:
     QQuickView *view;
 };
@@ -15,7 +15,7 @@
  */
 
 import QtQuick 2.4
-import "../../../plugins/Dash/CardCreator.js" as CardCreator
+import Dash 0.1
 
 Item {
     id: root
@@ -24,6 +24,6 @@ Item {
     }
 
     function createCardComponent(template, components, isCardCreator, artShapeStyle) {
-        return CardCreator.createCardComponent(root, JSON.parse(template), JSON.parse(components), isCardCreator, artShapeStyle) !== null;
+        return CardCreator.createCardComponent(JSON.parse(template), JSON.parse(components), isCardCreator, artShapeStyle) !== null;
     }
 }
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTest>
+
+#include "dashviewlayouts.h"
+
+class DashViewLayoutsTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testVerticalJournalColumnCount()
+    {
+        const VerticalJournalLayout layout(150, 10, 10);
+        QCOMPARE(layout.columnCount(0), 1);
+        QCOMPARE(layout.columnCount(309), 1);
+        QCOMPARE(layout.columnCount(310), 2);
+        QCOMPARE(layout.columnCount(470), 3);
+        QCOMPARE(layout.columnX(2), 320.);
+    }
+
+    void testVerticalJournal()
+    {
+        const VerticalJournalLayout layout(150, 10, 10);
+        const QVector<qreal> heights = { 50, 125, 100, 150, 125, 110 };
+        const QVector<QPointF> positions = layout.layout(heights, 470);
+
+        QCOMPARE(positions.count(), heights.count());
+        QCOMPARE(positions[0], QPointF(0, 0));
+        QCOMPARE(positions[1], QPointF(160, 0));
+        QCOMPARE(positions[2], QPointF(320, 0));
+        QCOMPARE(positions[3], QPointF(0, 60));
+        QCOMPARE(positions[4], QPointF(320, 110));
+        QCOMPARE(positions[5], QPointF(160, 135));
+    }
+
+    void testVerticalJournalPrepend()
+    {
+        const VerticalJournalLayout layout(150, 10, 10);
+        QCOMPARE(layout.columnToAppend({ 50, 20, 20 }), 1);
+        QCOMPARE(layout.appendY(20), 30.);
+        QCOMPARE(layout.prependY(60, 50), 0.);
+    }
+
+    void testHorizontalJournal()
+    {
+        const HorizontalJournalLayout layout(100, 5, 10);
+        const QVector<qreal> widths = { 100, 100, 100, 100 };
+        const QVector<QPointF> positions = layout.layout(widths, 310);
+
+        QCOMPARE(positions[0], QPointF(0, 0));
+        QCOMPARE(positions[1], QPointF(105, 0));
+        QCOMPARE(positions[2], QPointF(210, 0));
+        QCOMPARE(positions[3], QPointF(0, 110));
+
+        // Building back from the second row
+        QCOMPARE(layout.prependPosition(positions[3], 100, true, 210), positions[2]);
+        QCOMPARE(layout.prependPosition(positions[2], 100, false, 0), positions[1]);
+    }
+
+    void testHorizontalJournalExactFit()
+    {
+        const HorizontalJournalLayout layout(100, 5, 10);
+        bool startsRow;
+        QCOMPARE(layout.appendPosition(QPointF(0, 0), 100, 100, 205, &startsRow), QPointF(105, 0));
+        QVERIFY(!startsRow);
+        QCOMPARE(layout.appendPosition(QPointF(0, 0), 100, 100, 204, &startsRow), QPointF(0, 110));
+        QVERIFY(startsRow);
+    }
+
+    void testOrganicGrid()
+    {
+        const OrganicGridLayout layout(QSizeF(100, 100), QSizeF(210, 210), 10, 10);
+        QCOMPARE(layout.modulesPerRow(0), 1);
+        QCOMPARE(layout.modulesPerRow(869), 1);
+        QCOMPARE(layout.modulesPerRow(870), 2);
+
+        const QVector<QPointF> positions = layout.layout(7, 430);
+        QCOMPARE(positions[0], QPointF(0, 0));
+        QCOMPARE(positions[1], QPointF(110, 0));
+        QCOMPARE(positions[2], QPointF(0, 110));
+        QCOMPARE(positions[3], QPointF(220, 220));
+        QCOMPARE(positions[4], QPointF(220, 0));
+        QCOMPARE(positions[5], QPointF(330, 220));
+        QCOMPARE(positions[6], QPointF(0, 330));
+
+        QCOMPARE(layout.size(2), QSizeF(210, 210));
+        QCOMPARE(layout.size(5), QSizeF(100, 100));
+
+        QCOMPARE(layout.height(0, 1), 0.);
+        QCOMPARE(layout.height(2, 1), 110.);
+        QCOMPARE(layout.height(6, 1), 320.);
+        QCOMPARE(layout.height(7, 1), 430.);
+        QCOMPARE(layout.height(9, 1), 650.);
+    }
+};
+
+QTEST_GUILESS_MAIN(DashViewLayoutsTest)
+
+#include "dashviewlayoutstest.moc"
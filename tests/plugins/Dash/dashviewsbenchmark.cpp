@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmarks the Dash views with big synthetic models without showing them.
+ *
+ * The window is never exposed, polish and incubation are run by hand so
+ * they can be timed. Besides the QBENCHMARK wall time every data row
+ * records, per iteration, the delegates created, the time spent in polish
+ * and in incubation and the memory used. They are written as JSON to the
+ * file in $DASH_BENCHMARK_OUTPUT or to stdout when it is not set.
+ */
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQmlEngine>
+#include <QQmlIncubationController>
+#include <QQuickItem>
+#include <QQuickView>
+#include <QtTestGui>
+#include <private/qquickwindow_p.h>
+
+#include <paths.h>
+
+class BenchmarkModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    BenchmarkModel() : m_nextHeight(0) {}
+
+    int rowCount(const QModelIndex & /*parent*/ = QModelIndex()) const override
+    {
+        return m_heights.count();
+    }
+
+    QVariant data(const QModelIndex &index, int /*role*/) const override
+    {
+        return m_heights[index.row()];
+    }
+
+    QHash<int, QByteArray> roleNames() const override
+    {
+        QHash<int, QByteArray> roles;
+        roles.insert(Qt::DisplayRole, "modelHeight");
+        return roles;
+    }
+
+    void reset(int count)
+    {
+        beginResetModel();
+        m_heights.clear();
+        m_nextHeight = 0;
+        m_heights.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            m_heights << nextHeight();
+        }
+        endResetModel();
+    }
+
+    void insert(int index, int count)
+    {
+        beginInsertRows(QModelIndex(), index, index + count - 1);
+        for (int i = 0; i < count; ++i) {
+            m_heights.insert(index + i, nextHeight());
+        }
+        endInsertRows();
+    }
+
+    void remove(int index, int count)
+    {
+        beginRemoveRows(QModelIndex(), index, index + count - 1);
+        m_heights.remove(index, count);
+        endRemoveRows();
+    }
+
+private:
+    // Deterministic so all runs lay out the same items
+    int nextHeight()
+    {
+        return 50 + (m_nextHeight++ * 7919) % 200;
+    }
+
+    QVector<int> m_heights;
+    int m_nextHeight;
+};
+
+class DashViewsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    // In kB, -1 if not available
+    static qint64 memoryUsage(const char *field)
+    {
+        QFile status(QStringLiteral("/proc/self/status"));
+        if (status.open(QIODevice::ReadOnly)) {
+            Q_FOREACH(const QByteArray &line, status.readAll().split('\n')) {
+                if (line.startsWith(field)) {
+                    return line.mid(qstrlen(field)).trimmed().split(' ').first().toLongLong();
+                }
+            }
+        }
+        return -1;
+    }
+
+    bool isFlickable() const
+    {
+        return dashView->inherits("QQuickFlickable");
+    }
+
+    // Runs the polish and incubation the scene graph would run on each frame
+    // until the view settles
+    void settle()
+    {
+        QQuickWindowPrivate *wd = QQuickWindowPrivate::get(view);
+        QQmlIncubationController *incubationController = view->engine()->incubationController();
+        QElapsedTimer timer;
+        do {
+            QCoreApplication::processEvents();
+
+            timer.start();
+            wd->polishItems();
+            polishNsecs += timer.nsecsElapsed();
+
+            if (incubationController && incubationController->incubatingObjectCount() > 0) {
+                timer.start();
+                incubationController->incubateFor(16);
+                incubationNsecs += timer.nsecsElapsed();
+            }
+        } while (!wd->itemsToPolish.isEmpty() || (incubationController && incubationController->incubatingObjectCount() > 0));
+    }
+
+    void scrollTo(qreal y)
+    {
+        if (isFlickable()) {
+            dashView->setProperty("contentY", y);
+        } else {
+            dashView->setProperty("displayMarginBeginning", -y);
+            dashView->setProperty("displayMarginEnd", -(dashView->height() - y - view->height()));
+        }
+        settle();
+    }
+
+    qreal maxScroll() const
+    {
+        const qreal contentHeight = isFlickable() ? dashView->property("contentHeight").toReal() : dashView->height();
+        return qMax<qreal>(0, contentHeight - view->height());
+    }
+
+    void setupView(const QString &viewName, int itemCount)
+    {
+        dashView = view->rootObject()->findChild<QQuickItem*>(viewName);
+        QVERIFY(dashView);
+        model->reset(itemCount);
+        dashView->setProperty("model", QVariant::fromValue<QAbstractItemModel*>(model));
+        scrollTo(0);
+
+        view->rootObject()->setProperty("createdDelegates", 0);
+        polishNsecs = 0;
+        incubationNsecs = 0;
+        memoryBefore = memoryUsage("VmRSS:");
+    }
+
+    void recordResults(const char *scenario, int iterations)
+    {
+        QVERIFY(iterations > 0);
+
+        QJsonObject result;
+        result.insert(QStringLiteral("benchmark"), QString::fromLatin1(scenario));
+        result.insert(QStringLiteral("view"), QString::fromLatin1(QTest::currentDataTag()).section(QLatin1Char('-'), 0, 0));
+        result.insert(QStringLiteral("items"), model->rowCount());
+        result.insert(QStringLiteral("iterations"), iterations);
+        result.insert(QStringLiteral("delegatesCreated"), view->rootObject()->property("createdDelegates").toDouble() / iterations);
+        result.insert(QStringLiteral("polishMs"), polishNsecs / 1e6 / iterations);
+        result.insert(QStringLiteral("incubationMs"), incubationNsecs / 1e6 / iterations);
+        result.insert(QStringLiteral("rssKb"), memoryUsage("VmRSS:"));
+        result.insert(QStringLiteral("rssDeltaKb"), memoryUsage("VmRSS:") - memoryBefore);
+        result.insert(QStringLiteral("peakRssKb"), memoryUsage("VmHWM:"));
+        results << result;
+    }
+
+    void addViewData()
+    {
+        QTest::addColumn<QString>("viewName");
+        QTest::addColumn<int>("itemCount");
+
+        const QStringList views = { "ListViewWithPageHeader", "VerticalJournal", "HorizontalJournal", "OrganicGrid" };
+        const QList<int> itemCounts = { 1000, 10000, 50000 };
+        Q_FOREACH(const QString &viewName, views) {
+            Q_FOREACH(int itemCount, itemCounts) {
+                const QByteArray tag = QString("%1-%2").arg(viewName).arg(itemCount).toLatin1();
+                QTest::newRow(tag.constData()) << viewName << itemCount;
+            }
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        view = new QQuickView();
+        view->setResizeMode(QQuickView::SizeRootObjectToView);
+        view->setSource(QUrl::fromLocalFile(testDataDir() + "/" TEST_DIR "/dashviewsbenchmark.qml"));
+        QVERIFY(view->rootObject());
+        view->resize(470, 600);
+
+        model = new BenchmarkModel();
+    }
+
+    void cleanupTestCase()
+    {
+        delete view;
+        delete model;
+
+        const QByteArray json = QJsonDocument(results).toJson();
+        const QString outputPath = QString::fromLocal8Bit(qgetenv("DASH_BENCHMARK_OUTPUT"));
+        if (outputPath.isEmpty()) {
+            printf("%s", json.constData());
+        } else {
+            QFile output(outputPath);
+            QVERIFY(output.open(QIODevice::WriteOnly | QIODevice::Truncate));
+            output.write(json);
+        }
+    }
+
+    void cleanup()
+    {
+        if (dashView) {
+            dashView->setProperty("model", QVariant::fromValue<QAbstractItemModel*>(nullptr));
+            settle();
+            dashView = nullptr;
+        }
+    }
+
+    void benchmarkFlick_data()
+    {
+        addViewData();
+    }
+
+    void benchmarkFlick()
+    {
+        QFETCH(QString, viewName);
+        QFETCH(int, itemCount);
+
+        setupView(viewName, itemCount);
+
+        // Down 30 screens, or to the end, and back to the top, like a finger would
+        const qreal step = 50;
+        int iterations = 0;
+        QBENCHMARK {
+            const qreal bottom = qMin(maxScroll(), 30 * view->height());
+            qreal y = 0;
+            for (; y < bottom; y += step) {
+                scrollTo(y);
+            }
+            for (; y > 0; y -= step) {
+                scrollTo(y);
+            }
+            scrollTo(0);
+            ++iterations;
+        }
+
+        recordResults("flick", iterations);
+    }
+
+    void benchmarkReset_data()
+    {
+        addViewData();
+    }
+
+    void benchmarkReset()
+    {
+        QFETCH(QString, viewName);
+        QFETCH(int, itemCount);
+
+        setupView(viewName, itemCount);
+
+        int iterations = 0;
+        QBENCHMARK {
+            model->reset(itemCount);
+            settle();
+            ++iterations;
+        }
+
+        recordResults("reset", iterations);
+    }
+
+    void benchmarkInsertRemove_data()
+    {
+        addViewData();
+    }
+
+    void benchmarkInsertRemove()
+    {
+        QFETCH(QString, viewName);
+        QFETCH(int, itemCount);
+
+        setupView(viewName, itemCount);
+
+        // At the start of the model, where new results of a scope show up
+        int iterations = 0;
+        QBENCHMARK {
+            model->insert(0, 10);
+            settle();
+            model->remove(0, 10);
+            settle();
+            ++iterations;
+        }
+
+        recordResults("insertRemove", iterations);
+    }
+
+private:
+    QQuickView *view = nullptr;
+    BenchmarkModel *model = nullptr;
+    QQuickItem *dashView = nullptr;
+    qint64 polishNsecs = 0;
+    qint64 incubationNsecs = 0;
+    qint64 memoryBefore = 0;
+    QJsonArray results;
+};
+
+QTEST_MAIN(DashViewsBenchmark)
+
+#include "dashviewsbenchmark.moc"
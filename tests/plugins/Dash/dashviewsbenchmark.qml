@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import QtQuick 2.4
+import Dash 0.1
+
+Item {
+    id: root
+
+    // Incremented by every delegate of every view, the benchmark resets it
+    property int createdDelegates: 0
+
+    ListViewWithPageHeader {
+        objectName: "ListViewWithPageHeader"
+        anchors.fill: parent
+        cacheBuffer: height * 0.5
+
+        delegate: Rectangle {
+            width: parent.width
+            height: modelHeight
+            color: index % 2 == 0 ? "red" : "blue"
+            Component.onCompleted: root.createdDelegates++
+        }
+    }
+
+    // The dash views are as tall as their contents, like in the Dash,
+    // the benchmark scrolls them with the display margins
+    VerticalJournal {
+        objectName: "VerticalJournal"
+        width: parent.width
+        height: implicitHeight
+        columnWidth: 150
+        columnSpacing: 10
+        rowSpacing: 10
+        cacheBuffer: Math.max(0, (height + displayMarginEnd + displayMarginBeginning) / 2)
+
+        delegate: Rectangle {
+            width: 150
+            height: modelHeight
+            color: index % 2 == 0 ? "red" : "blue"
+            Component.onCompleted: root.createdDelegates++
+        }
+    }
+
+    HorizontalJournal {
+        objectName: "HorizontalJournal"
+        width: parent.width
+        height: implicitHeight
+        rowHeight: 150
+        columnSpacing: 10
+        rowSpacing: 10
+        cacheBuffer: Math.max(0, (height + displayMarginEnd + displayMarginBeginning) / 2)
+
+        delegate: Rectangle {
+            width: modelHeight
+            height: 150
+            color: index % 2 == 0 ? "red" : "blue"
+            Component.onCompleted: root.createdDelegates++
+        }
+    }
+
+    OrganicGrid {
+        objectName: "OrganicGrid"
+        width: parent.width
+        height: implicitHeight
+        columnSpacing: 10
+        rowSpacing: 10
+        smallDelegateSize: Qt.size(90, 90)
+        bigDelegateSize: Qt.size(180, 180)
+        cacheBuffer: Math.max(0, (height + displayMarginEnd + displayMarginBeginning) / 2)
+
+        delegate: Rectangle {
+            color: index % 2 == 0 ? "red" : "blue"
+            Component.onCompleted: root.createdDelegates++
+        }
+    }
+}
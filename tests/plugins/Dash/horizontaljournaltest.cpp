@@ -84,6 +84,15 @@ class HorizontalJournalTest : public QObject
     Q_OBJECT
 
 private:
+    qreal lastInRowPosition(int modelIndex) const
+    {
+        Q_FOREACH(const HorizontalJournal::RowBreak &rowBreak, hj->m_rowBreaks) {
+            if (rowBreak.lastIndex == modelIndex)
+                return rowBreak.lastX;
+        }
+        return -1;
+    }
+
     void verifyItem(const QQuickItem *item, int modelIndex, qreal x, qreal y, bool visible)
     {
         QTRY_COMPARE(item->x(), x);
@@ -110,11 +119,11 @@ private:
         verifyItem(hj->m_visibleItems[11], 11, 230, 320, true);
         verifyItem(hj->m_visibleItems[12], 12, 305, 320, true);
         verifyItem(hj->m_visibleItems[13], 13,   0, 480, false);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 4);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 5], 375.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 7], 210.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[12], 305.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[13],   0.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 4);
+        QTRY_COMPARE(lastInRowPosition(5), 375.);
+        QTRY_COMPARE(lastInRowPosition(7), 210.);
+        QTRY_COMPARE(lastInRowPosition(12), 305.);
+        QTRY_COMPARE(lastInRowPosition(13),   0.);
         QCOMPARE(hj->implicitHeight(), 900.);
     }
 
@@ -171,11 +180,11 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[14], 14, 300, 320, true);
         verifyItem(hj->m_visibleItems[15], 15,   0, 480, false);
         verifyItem(hj->m_visibleItems[16], 16, 140, 480, false);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 4);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 5], 375.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[11], 560.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[14], 300.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[16], 140.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 4);
+        QTRY_COMPARE(lastInRowPosition(5), 375.);
+        QTRY_COMPARE(lastInRowPosition(11), 560.);
+        QTRY_COMPARE(lastInRowPosition(14), 300.);
+        QTRY_COMPARE(lastInRowPosition(16), 140.);
         QCOMPARE(hj->implicitHeight(), 630. + 3. * 630. / 17.);
 
         view->resize(470, 400);
@@ -205,11 +214,11 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[11], 11, 233, 320, true);
         verifyItem(hj->m_visibleItems[12], 12, 309, 320, true);
         verifyItem(hj->m_visibleItems[13], 13,   0, 480, false);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 4);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 5], 380.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 7], 211.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[12], 309.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[13],   0.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 4);
+        QTRY_COMPARE(lastInRowPosition(5), 380.);
+        QTRY_COMPARE(lastInRowPosition(7), 211.);
+        QTRY_COMPARE(lastInRowPosition(12), 309.);
+        QTRY_COMPARE(lastInRowPosition(13),   0.);
         QCOMPARE(hj->implicitHeight(), 900.);
 
         hj->setColumnSpacing(10);
@@ -241,11 +250,11 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[11], 11, 230, 322, true);
         verifyItem(hj->m_visibleItems[12], 12, 305, 322, true);
         verifyItem(hj->m_visibleItems[13], 13,   0, 483, false);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 4);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 5], 375.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 7], 210.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[12], 305.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[13],   0.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 4);
+        QTRY_COMPARE(lastInRowPosition(5), 375.);
+        QTRY_COMPARE(lastInRowPosition(7), 210.);
+        QTRY_COMPARE(lastInRowPosition(12), 305.);
+        QTRY_COMPARE(lastInRowPosition(13),   0.);
         QCOMPARE(hj->implicitHeight(), 633. + 6. * 633. / 14.);
 
         hj->setRowSpacing(10);
@@ -269,9 +278,9 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[4], 10, 200, 320, true);
         verifyItem(hj->m_visibleItems[5], 11, 230, 320, true);
         verifyItem(hj->m_visibleItems[6], 12, 305, 320, true);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 5], 375.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 7], 210.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[12], 305.);
+        QTRY_COMPARE(lastInRowPosition(5), 375.);
+        QTRY_COMPARE(lastInRowPosition(7), 210.);
+        QTRY_COMPARE(lastInRowPosition(12), 305.);
 
         hj->setDisplayMarginBeginning(0);
         hj->setDisplayMarginEnd(0);
@@ -299,10 +308,10 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[10], 10, 200, 420, false);
         verifyItem(hj->m_visibleItems[11], 11, 230, 420, false);
         verifyItem(hj->m_visibleItems[12], 12, 305, 420, false);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 3);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 5], 375.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 7], 210.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[12], 305.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 3);
+        QTRY_COMPARE(lastInRowPosition(5), 375.);
+        QTRY_COMPARE(lastInRowPosition(7), 210.);
+        QTRY_COMPARE(lastInRowPosition(12), 305.);
         QCOMPARE(hj->implicitHeight(), 620. + 7. * 620. / 13.);
 
         hj->setRowHeight(150);
@@ -329,7 +338,7 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[ 3],  3, 305,   0, true);
         verifyItem(hj->m_visibleItems[ 4],  4, 340,   0, true);
         verifyItem(hj->m_visibleItems[ 5],  5, 400,   0, true);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 0);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 0);
         QCOMPARE(hj->implicitHeight(), 150.);
     }
 
@@ -347,7 +356,7 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[ 3],  3, 305,   0, true);
         verifyItem(hj->m_visibleItems[ 4],  4, 340,   0, true);
         verifyItem(hj->m_visibleItems[ 5],  5, 400,   0, true);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 0);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 0);
         QCOMPARE(hj->implicitHeight(), 150.);
     }
 
@@ -374,11 +383,11 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[11], 11, 230, 320, true);
         verifyItem(hj->m_visibleItems[12], 12, 305, 320, true);
         verifyItem(hj->m_visibleItems[13], 13,   0, 480, false);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 4);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 5], 375.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[ 7], 210.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[12], 305.);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[13],   0.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 4);
+        QTRY_COMPARE(lastInRowPosition(5), 375.);
+        QTRY_COMPARE(lastInRowPosition(7), 210.);
+        QTRY_COMPARE(lastInRowPosition(12), 305.);
+        QTRY_COMPARE(lastInRowPosition(13),   0.);
         QTRY_COMPARE(hj->implicitHeight(), 855.);
     }
 
@@ -400,7 +409,7 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[3],  3, 305,   0, true);
         verifyItem(hj->m_visibleItems[4],  4, 340,   0, true);
         verifyItem(hj->m_visibleItems[5],  5, 400,   0, true);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 0);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 0);
         QCOMPARE(hj->implicitHeight(), 150.);
 
         model2->addString("75");
@@ -414,8 +423,8 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[4],  4, 340,   0, true);
         verifyItem(hj->m_visibleItems[5],  5, 400,   0, true);
         verifyItem(hj->m_visibleItems[6],  6,   0,  160, true);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 1);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[5], 400.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 1);
+        QTRY_COMPARE(lastInRowPosition(5), 400.);
         QCOMPARE(hj->implicitHeight(), 310.);
 
         model2->addString("50");
@@ -432,8 +441,8 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[6],  6,   0,  160, true);
         verifyItem(hj->m_visibleItems[7],  7,  85,  160, true);
         verifyItem(hj->m_visibleItems[8],  8, 145,  160, true);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 1);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[5], 400.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 1);
+        QTRY_COMPARE(lastInRowPosition(5), 400.);
         QCOMPARE(hj->implicitHeight(), 310.);
 
         model2->removeLast();
@@ -448,8 +457,8 @@ private Q_SLOTS:
         verifyItem(hj->m_visibleItems[5],  5, 400,   0, true);
         verifyItem(hj->m_visibleItems[6],  6,   0,  160, true);
         verifyItem(hj->m_visibleItems[7],  7,  85,  160, true);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition.count(), 1);
-        QTRY_COMPARE(hj->m_lastInRowIndexPosition[5], 400.);
+        QTRY_COMPARE(hj->m_rowBreaks.count(), 1);
+        QTRY_COMPARE(lastInRowPosition(5), 400.);
         QCOMPARE(hj->implicitHeight(), 310.);
     }
 
@@ -2026,6 +2026,60 @@ private Q_SLOTS:
         QTRY_COMPARE(lvwph->m_minYExtent, 530.);
     }
 
+    void testTrackItemHeights()
+    {
+        lvwph->setTrackItemHeights(true);
+        changeContentY(520);
+        QTRY_COMPARE(lvwph->m_visibleItems.count(), 4);
+        QCOMPARE(lvwph->m_firstVisibleIndex, 1);
+        verifyItem(0, -320., 200., true);
+        // Unlike testDrag520PixelUp we remember that item 0 was 150 high
+        QCOMPARE(lvwph->m_heightIndex.height(0), 150.);
+        QCOMPARE(lvwph->m_minYExtent, 0.);
+
+        QMetaObject::invokeMethod(model, "insertItem", Q_ARG(QVariant, 0), Q_ARG(QVariant, 100));
+        QTRY_COMPARE(lvwph->m_heightIndex.count(), 7);
+        QVERIFY(!lvwph->m_heightIndex.isMeasured(0));
+        QCOMPARE(lvwph->m_heightIndex.height(1), 150.);
+
+        QMetaObject::invokeMethod(model, "removeItems", Q_ARG(QVariant, 0), Q_ARG(QVariant, 1));
+        QTRY_COMPARE(lvwph->m_heightIndex.count(), 6);
+        QCOMPARE(lvwph->m_heightIndex.height(0), 150.);
+    }
+
+    void testTrackItemHeightsGeometryChange()
+    {
+        lvwph->setTrackItemHeights(true);
+        QCOMPARE(lvwph->m_heightIndex.height(1), 200.);
+
+        model->setProperty(1, "size", 250);
+        QTRY_COMPARE(lvwph->m_heightIndex.height(1), 250.);
+    }
+
+    void testPositionAtIndex()
+    {
+        lvwph->setTrackItemHeights(true);
+        scrollToBottom();
+        scrollToTop();
+        QTRY_COMPARE(lvwph->m_firstVisibleIndex, 0);
+        QCOMPARE(lvwph->m_heightIndex.measuredCount(), 6);
+        QVERIFY(!lvwph->itemAtIndex(4));
+
+        lvwph->positionAtIndex(4);
+
+        // 50 of header plus 150, 200, 350 and 350 of the items before it
+        QCOMPARE(lvwph->contentY(), 1100.);
+        ListViewWithPageHeader::ListItem *item = lvwph->itemAtIndex(4);
+        QVERIFY(item);
+        QCOMPARE(item->y() + lvwph->m_clipItem->y(), 1100.);
+        QTRY_COMPARE(lvwph->m_minYExtent, 0.);
+        QTRY_COMPARE(lvwph->contentHeight(), 1800.);
+
+        lvwph->positionAtBeginning();
+
+        verifyInitialTopPosition();
+    }
+
 private:
     QQuickView *view;
     ListViewWithPageHeader *lvwph;
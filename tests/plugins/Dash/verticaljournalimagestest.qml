@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import QtQuick 2.4
+import Dash 0.1
+
+Item {
+    id: root
+
+    Component {
+        id: artDelegate
+
+        Item {
+            width: 150
+            height: modelHeight
+
+            Image {
+                anchors.fill: parent
+                source: "http://localhost/art" + index + ".png"
+            }
+        }
+    }
+
+    VerticalJournal {
+        id: vj
+        objectName: "vj"
+        anchors.fill: parent
+        columnWidth: 150
+        columnSpacing: 10
+        rowSpacing: 10
+        cacheBuffer: Math.max(0, (height + displayMarginEnd + displayMarginBeginning) / 2)
+        delegate: artDelegate
+    }
+
+    // Shows the same art, only gets a model when a test wants it to
+    VerticalJournal {
+        id: vj2
+        objectName: "vj2"
+        width: root.width
+        height: root.height
+        columnWidth: 150
+        columnSpacing: 10
+        rowSpacing: 10
+        cacheBuffer: Math.max(0, (height + displayMarginEnd + displayMarginBeginning) / 2)
+        delegate: artDelegate
+    }
+}
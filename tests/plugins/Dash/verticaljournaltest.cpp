@@ -23,6 +23,8 @@
 #include <QStringListModel>
 #include <QQmlContext>
 #include <QQmlEngine>
+#include <QQmlNetworkAccessManagerFactory>
+#include <QNetworkAccessManager>
 #include <private/qquickitem_p.h>
 
 #include "verticaljournal.h"
@@ -93,6 +95,39 @@ private:
     QStringList m_list;
 };
 
+// Stands in for the shell's QueuedNetworkAccessManager
+class VisibleUrlsNetworkAccessManager : public QNetworkAccessManager {
+    Q_OBJECT
+public:
+    VisibleUrlsNetworkAccessManager(QObject *parent) : QNetworkAccessManager(parent) {}
+
+    // Counted as QueuedNetworkAccessManager does, a hide without its show
+    // leaves a negative count behind
+    Q_INVOKABLE void setUrlVisible(const QUrl &url, bool visible)
+    {
+        int &count = visibleCounts[url];
+        count += visible ? 1 : -1;
+        if (count == 0) {
+            visibleCounts.remove(url);
+        }
+    }
+
+    QSet<QUrl> visibleUrls() const
+    {
+        return visibleCounts.keys().toSet();
+    }
+
+    QHash<QUrl, int> visibleCounts;
+};
+
+class VisibleUrlsNetworkAccessManagerFactory : public QQmlNetworkAccessManagerFactory {
+public:
+    QNetworkAccessManager *create(QObject *parent) override
+    {
+        return new VisibleUrlsNetworkAccessManager(parent);
+    }
+};
+
 class VerticalJournalTest : public QObject
 {
     Q_OBJECT
@@ -371,6 +406,67 @@ private Q_SLOTS:
         verifyItem(vj->m_columnVisibleItems[1][0],  1, 160,  0, true);
         verifyItem(vj->m_columnVisibleItems[2][0],  2, 320,  0, true);
         verifyItem(vj->m_columnVisibleItems[1][1],  3, 160, 60, true);
+
+        // 100, 50, 50 and 30 plus 10 of spacing each, in 3 columns
+        QCOMPARE(vj->averageHeightPerItem(), 270. / 4 / 3);
+    }
+
+    void testLayoutSeek()
+    {
+        checkInitialPositions();
+
+        QCOMPARE(vj->m_layout.count(), 18);
+        QCOMPARE(vj->m_layout[16].column, (quint16)0);
+        QCOMPARE(vj->m_layout[16].y, 570.f);
+        QCOMPARE(vj->m_layout[16].height, 400.f);
+        QCOMPARE(vj->m_columnLastIndex, QVector<qint32>({16, 17, 14}));
+
+        // 16 and 17 start at 570 but 14 and 15 still reach it
+        QCOMPARE(vj->seekModelIndex(600), 14);
+        QCOMPARE(vj->seekModelIndex(0), 0);
+        QCOMPARE(vj->seekModelIndex(-100), 0);
+    }
+
+    void testIncubationBudget()
+    {
+        vj->setIncubationBudget(1);
+        QCOMPARE(vj->incubationBudget(), 1);
+        view->rootObject()->setProperty("creationDelay", 3);
+
+        // While items are pending only the visible area may have been filled
+        bool bufferItemWhilePending = false;
+        auto connection = connect(vj, &AbstractDashView::pendingItemsChanged, this, [this, &bufferItemWhilePending] {
+            if (vj->pendingItems() == 0)
+                return;
+            Q_FOREACH(const auto &column, vj->m_columnVisibleItems) {
+                Q_FOREACH(const VerticalJournal::ViewItem &item, column) {
+                    if (item.y() >= vj->height() || item.y() + item.height() <= 0)
+                        bufferItemWhilePending = true;
+                }
+            }
+        });
+
+        // Resetting the model recreates all the items
+        model->setStringList(model->stringList());
+        vj->updatePolish();
+
+        // 3ms per delegate don't fit in a 1ms budget, the first polish only creates one
+        QVERIFY(vj->pendingItems() > 0);
+        int createdItems = 0;
+        Q_FOREACH(const auto &column, vj->m_columnVisibleItems) {
+            createdItems += column.count();
+        }
+        QCOMPARE(createdItems, 1);
+
+        // Spreading the creation over several frames gives the same result
+        checkInitialPositions();
+        QTRY_COMPARE(vj->pendingItems(), 0);
+        disconnect(connection);
+        QVERIFY(!bufferItemWhilePending);
+
+        view->rootObject()->setProperty("creationDelay", 0);
+        vj->setIncubationBudget(-1);
+        QCOMPARE(vj->incubationBudget(), 1);
     }
 
     void testModelRemoveLastNonVisible()
@@ -553,6 +649,80 @@ private Q_SLOTS:
         QCOMPARE(vj->implicitHeight(), 370.);
     }
 
+    void testImagePriorities()
+    {
+        VisibleUrlsNetworkAccessManagerFactory factory;
+        QScopedPointer<QQuickView> imagesView(new QQuickView());
+        imagesView->setResizeMode(QQuickView::SizeRootObjectToView);
+        imagesView->engine()->setNetworkAccessManagerFactory(&factory);
+        imagesView->setSource(QUrl::fromLocalFile(testDataDir() + "/" TEST_DIR "/verticaljournalimagestest.qml"));
+        imagesView->show();
+        QTest::qWaitForWindowExposed(imagesView.data());
+        imagesView->resize(470, 400);
+
+        VerticalJournal *imagesVj = static_cast<VerticalJournal*>(imagesView->rootObject()->findChild<QObject*>("vj"));
+        imagesVj->setModel(model);
+        auto manager = static_cast<VisibleUrlsNetworkAccessManager*>(imagesView->engine()->networkAccessManager());
+
+        auto artUrls = [](int count) {
+            QSet<QUrl> urls;
+            for (int i = 0; i < count; ++i) {
+                urls << QUrl(QStringLiteral("http://localhost/art%1.png").arg(i));
+            }
+            return urls;
+        };
+
+        // Same layout as checkInitialPositions, 15 to 17 are created but culled
+        QTRY_COMPARE(manager->visibleUrls(), artUrls(15));
+
+        // Culled and released items give their priority back
+        imagesView->resize(470, 100);
+        QTRY_COMPARE(manager->visibleUrls(), artUrls(5));
+
+        imagesVj->setDisplayMarginEnd(100);
+        QTRY_COMPARE(manager->visibleUrls(), artUrls(9));
+    }
+
+    void testImagePrioritiesSharedUrls()
+    {
+        VisibleUrlsNetworkAccessManagerFactory factory;
+        QScopedPointer<QQuickView> imagesView(new QQuickView());
+        imagesView->setResizeMode(QQuickView::SizeRootObjectToView);
+        imagesView->engine()->setNetworkAccessManagerFactory(&factory);
+        imagesView->setSource(QUrl::fromLocalFile(testDataDir() + "/" TEST_DIR "/verticaljournalimagestest.qml"));
+        imagesView->show();
+        QTest::qWaitForWindowExposed(imagesView.data());
+        imagesView->resize(470, 400);
+
+        VerticalJournal *imagesVj = static_cast<VerticalJournal*>(imagesView->rootObject()->findChild<QObject*>("vj"));
+        VerticalJournal *imagesVj2 = static_cast<VerticalJournal*>(imagesView->rootObject()->findChild<QObject*>("vj2"));
+        imagesVj->setModel(model);
+        imagesVj2->setModel(model);
+        auto manager = static_cast<VisibleUrlsNetworkAccessManager*>(imagesView->engine()->networkAccessManager());
+
+        auto artCounts = [](int count, int bothCount) {
+            QHash<QUrl, int> counts;
+            for (int i = 0; i < count; ++i) {
+                counts.insert(QUrl(QStringLiteral("http://localhost/art%1.png").arg(i)), i < bothCount ? 2 : 1);
+            }
+            return counts;
+        };
+
+        // Both views show the same 15 items
+        QTRY_COMPARE(manager->visibleCounts, artCounts(15, 15));
+
+        // One of them only shows 5 of them now, the other still shows them all
+        imagesVj2->setHeight(100);
+        QTRY_COMPARE(manager->visibleCounts, artCounts(15, 5));
+
+        // The other one going away leaves the ones the first one shows
+        imagesVj->setModel(nullptr);
+        QTRY_COMPARE(manager->visibleCounts, artCounts(5, 0));
+
+        delete imagesVj2;
+        QCOMPARE(manager->visibleCounts, artCounts(0, 0));
+    }
+
 private:
     QQuickView *view;
     VerticalJournal *vj;
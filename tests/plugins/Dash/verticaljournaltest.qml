@@ -18,6 +18,10 @@ import QtQuick 2.4
 import Dash 0.1
 
 Item {
+    id: root
+
+    // Milliseconds each delegate takes to be created
+    property int creationDelay: 0
 
     VerticalJournal {
         id: vj
@@ -35,6 +39,11 @@ Item {
             height: modelHeight
             border.width: 3
 
+            Component.onCompleted: {
+                var end = Date.now() + root.creationDelay;
+                while (Date.now() < end) {}
+            }
+
             Text {
                 text: index + "\ny: " + parent.y + "\nheight: " + parent.height
                 x: 10
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares ImageScaler with what the image cache did before it, reading
+ * with QImageReader::setScaledSize() and scaling with
+ * Qt::SmoothTransformation, on wallpaper and screenshot sized images
+ * shrunk to a phone screen and to an icon.
+ */
+
+#include <QImageReader>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "ImageScaler.h"
+
+class ImageScalerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    // A photo-like image, so the compressed formats don't get it for free
+    static QImage sampleImage(const QSize &size)
+    {
+        QImage image(size, QImage::Format_RGB32);
+        QPainter painter(&image);
+        QLinearGradient gradient(0, 0, size.width(), size.height());
+        gradient.setColorAt(0, QColor(230, 80, 30));
+        gradient.setColorAt(1, QColor(30, 60, 200));
+        painter.fillRect(image.rect(), gradient);
+        painter.end();
+
+        quint32 seed = 1;
+        for (int y = 0; y < image.height(); ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                seed = seed * 1103515245 + 12345;
+                const int noise = int((seed >> 16) % 32) - 16;
+                const QRgb pixel = line[x];
+                line[x] = qRgb(qBound(0, qRed(pixel) + noise, 255),
+                               qBound(0, qGreen(pixel) + noise, 255),
+                               qBound(0, qBlue(pixel) + noise, 255));
+            }
+        }
+        return image;
+    }
+
+    QString path(const QByteArray &format, const QSize &size)
+    {
+        const QString filePath = QStringLiteral("%1/%2x%3.%4").arg(m_dir.path()).arg(size.width())
+                                                              .arg(size.height()).arg(QString::fromLatin1(format));
+        if (!QFile::exists(filePath)) {
+            sampleImage(size).save(filePath, format.constData(), 90);
+        }
+        return filePath;
+    }
+
+    void addData(bool withFormats)
+    {
+        QTest::addColumn<QByteArray>("format");
+        QTest::addColumn<QSize>("sourceSize");
+        QTest::addColumn<QSize>("size");
+        QTest::addColumn<bool>("imageScaler");
+
+        const QList<QByteArray> formats = withFormats ? QList<QByteArray>{ "jpeg", "png" } : QList<QByteArray>{ "" };
+        const QList<QSize> sourceSizes = { QSize(1920, 1080), QSize(2560, 1440), QSize(3840, 2160) };
+        // A phone screen wide and a launcher icon high
+        const QList<int> widths = { 540, 256 };
+        Q_FOREACH(const QByteArray &format, formats) {
+            Q_FOREACH(const QSize &sourceSize, sourceSizes) {
+                Q_FOREACH(int width, widths) {
+                    const QSize size(width, sourceSize.height() * width / sourceSize.width());
+                    Q_FOREACH(bool imageScaler, QList<bool>() << false << true) {
+                        const QByteArray tag = (format.isEmpty() ? QByteArray() : format + '-')
+                            + QByteArray::number(sourceSize.width()) + 'x' + QByteArray::number(sourceSize.height())
+                            + "-to-" + QByteArray::number(width) + (imageScaler ? "-imagescaler" : "-qt");
+                        QTest::newRow(tag.constData()) << format << sourceSize << size << imageScaler;
+                    }
+                }
+            }
+        }
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void benchmarkRead_data()
+    {
+        addData(true);
+    }
+
+    void benchmarkRead()
+    {
+        QFETCH(QByteArray, format);
+        QFETCH(QSize, sourceSize);
+        QFETCH(QSize, size);
+        QFETCH(bool, imageScaler);
+
+        const QString filePath = path(format, sourceSize);
+        QBENCHMARK {
+            QImageReader reader(filePath, format);
+            reader.setQuality(100);
+            QImage image;
+            if (imageScaler) {
+                image = ImageScaler::read(reader, size);
+            } else {
+                reader.setScaledSize(size);
+                image = reader.read();
+            }
+            QCOMPARE(image.size(), size);
+        }
+    }
+
+    void benchmarkScale_data()
+    {
+        addData(false);
+    }
+
+    void benchmarkScale()
+    {
+        QFETCH(QSize, sourceSize);
+        QFETCH(QSize, size);
+        QFETCH(bool, imageScaler);
+
+        const QImage source = sampleImage(sourceSize);
+        QBENCHMARK {
+            const QImage image = imageScaler ? ImageScaler::scaled(source, size)
+                                             : source.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            QCOMPARE(image.size(), size);
+        }
+    }
+
+private:
+    QTemporaryDir m_dir;
+};
+
+QTEST_GUILESS_MAIN(ImageScalerBenchmark)
+
+#include "imagescalerbenchmark.moc"
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "ImageScaler.h"
+
+#include <math.h>
+
+class ImageScalerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QImage noise(const QSize &size, QImage::Format format, quint32 seed)
+    {
+        QImage image(size, format);
+        for (int y = 0; y < image.height(); ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                seed = seed * 1103515245 + 12345;
+                const int alpha = format == QImage::Format_RGB32 ? 255 : (seed >> 24);
+                line[x] = qPremultiply(qRgba(seed >> 8, seed >> 13, seed >> 18, alpha));
+            }
+        }
+        return image;
+    }
+
+    // The exact area average, in floating point
+    static QImage reference(const QImage &image, const QSize &size)
+    {
+        QImage result(size, image.format());
+        const double scaleX = double(image.width()) / size.width();
+        const double scaleY = double(image.height()) / size.height();
+        for (int y = 0; y < size.height(); ++y) {
+            for (int x = 0; x < size.width(); ++x) {
+                double sum[4] = { 0, 0, 0, 0 };
+                for (int sy = y * scaleY; sy < qMin<double>((y + 1) * scaleY, image.height()); ++sy) {
+                    const double weightY = qMin<double>(sy + 1, (y + 1) * scaleY) - qMax<double>(sy, y * scaleY);
+                    for (int sx = x * scaleX; sx < qMin<double>((x + 1) * scaleX, image.width()); ++sx) {
+                        const double weight = weightY * (qMin<double>(sx + 1, (x + 1) * scaleX) - qMax<double>(sx, x * scaleX));
+                        const uchar *pixel = image.constScanLine(sy) + sx * 4;
+                        for (int c = 0; c < 4; ++c) {
+                            sum[c] += weight * pixel[c];
+                        }
+                    }
+                }
+                uchar *pixel = result.scanLine(y) + x * 4;
+                for (int c = 0; c < 4; ++c) {
+                    pixel[c] = qRound(sum[c] / (scaleX * scaleY));
+                }
+            }
+        }
+        return result;
+    }
+
+    static int maxDifference(const QImage &a, const QImage &b)
+    {
+        int difference = 0;
+        for (int y = 0; y < a.height(); ++y) {
+            for (int i = 0; i < a.width() * 4; ++i) {
+                difference = qMax(difference, qAbs(a.constScanLine(y)[i] - b.constScanLine(y)[i]));
+            }
+        }
+        return difference;
+    }
+
+private Q_SLOTS:
+
+    void testAreaAverage_data()
+    {
+        QTest::addColumn<QSize>("sourceSize");
+        QTest::addColumn<QSize>("size");
+        QTest::addColumn<bool>("alpha");
+
+        QTest::newRow("half") << QSize(64, 32) << QSize(32, 16) << false;
+        QTest::newRow("fraction") << QSize(250, 100) << QSize(100, 40) << false;
+        QTest::newRow("small reduction") << QSize(101, 77) << QSize(100, 70) << false;
+        QTest::newRow("big reduction") << QSize(1000, 700) << QSize(37, 23) << false;
+        QTest::newRow("to one pixel") << QSize(33, 17) << QSize(1, 1) << false;
+        QTest::newRow("odd widths") << QSize(131, 61) << QSize(13, 7) << false;
+        QTest::newRow("alpha") << QSize(250, 100) << QSize(100, 40) << true;
+    }
+
+    void testAreaAverage()
+    {
+        QFETCH(QSize, sourceSize);
+        QFETCH(QSize, size);
+        QFETCH(bool, alpha);
+
+        const QImage image = noise(sourceSize, alpha ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32, 42);
+        const QImage scaled = ImageScaler::scaled(image, size);
+        QCOMPARE(scaled.size(), size);
+        QCOMPARE(scaled.format(), image.format());
+        QVERIFY(maxDifference(scaled, reference(image, size)) <= 1);
+
+        // Still premultiplied
+        for (int y = 0; y < scaled.height(); ++y) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(scaled.constScanLine(y));
+            for (int x = 0; x < scaled.width(); ++x) {
+                QVERIFY(qRed(line[x]) <= qAlpha(line[x]));
+                QVERIFY(qGreen(line[x]) <= qAlpha(line[x]));
+                QVERIFY(qBlue(line[x]) <= qAlpha(line[x]));
+            }
+        }
+    }
+
+    void testUniform()
+    {
+        QImage image(640, 480, QImage::Format_RGB32);
+        image.fill(qRgb(255, 128, 1));
+
+        const QImage scaled = ImageScaler::scaled(image, QSize(61, 47));
+        for (int y = 0; y < scaled.height(); ++y) {
+            for (int x = 0; x < scaled.width(); ++x) {
+                QCOMPARE(scaled.pixel(x, y), qRgb(255, 128, 1));
+            }
+        }
+    }
+
+    void testFormats()
+    {
+        QImage indexed(40, 40, QImage::Format_Indexed8);
+        indexed.setColorTable(QVector<QRgb>() << qRgb(0, 0, 255));
+        indexed.fill(0);
+        QImage scaled = ImageScaler::scaled(indexed, QSize(10, 10));
+        QCOMPARE(scaled.format(), QImage::Format_RGB32);
+        QCOMPARE(scaled.pixel(5, 5), qRgb(0, 0, 255));
+
+        QImage transparent(40, 40, QImage::Format_ARGB32);
+        transparent.fill(qRgba(255, 0, 0, 128));
+        scaled = ImageScaler::scaled(transparent, QSize(10, 10));
+        QCOMPARE(scaled.format(), QImage::Format_ARGB32_Premultiplied);
+        QCOMPARE(qAlpha(scaled.pixel(5, 5)), 128);
+    }
+
+    void testNotShrinking()
+    {
+        const QImage image = noise(QSize(50, 20), QImage::Format_RGB32, 1);
+        QCOMPARE(ImageScaler::scaled(image, QSize(50, 20)), image);
+        QCOMPARE(ImageScaler::scaled(image, QSize(100, 40)).size(), QSize(100, 40));
+        QCOMPARE(ImageScaler::scaled(image, QSize(25, 20)).size(), QSize(25, 20));
+        QVERIFY(ImageScaler::scaled(QImage(), QSize(25, 20)).isNull());
+    }
+
+    void testRead_data()
+    {
+        QTest::addColumn<QByteArray>("format");
+
+        QTest::newRow("jpeg") << QByteArray("jpeg");
+        QTest::newRow("png") << QByteArray("png");
+    }
+
+    void testRead()
+    {
+        QFETCH(QByteArray, format);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QImage image(1000, 400, QImage::Format_RGB32);
+        image.fill(qRgb(0, 128, 255));
+        const QString path = dir.path() + "/image." + format;
+        QVERIFY(image.save(path, format.constData(), 100));
+
+        QImageReader reader(path);
+        reader.setQuality(100);
+        const QImage scaled = ImageScaler::read(reader, QSize(100, 40));
+        QCOMPARE(scaled.size(), QSize(100, 40));
+        const QRgb pixel = scaled.pixel(50, 20);
+        QVERIFY(qAbs(qRed(pixel) - 0) <= 2);
+        QVERIFY(qAbs(qGreen(pixel) - 128) <= 2);
+        QVERIFY(qAbs(qBlue(pixel) - 255) <= 2);
+    }
+
+    void testReadPngAreaAverage()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QImage image = noise(QSize(250, 100), QImage::Format_RGB32, 7);
+        const QString path = dir.path() + "/image.png";
+        QVERIFY(image.save(path, "png"));
+
+        // PNG is lossless, so the result is exactly the area average of the
+        // original and not what QImage::scaled() would give
+        QImageReader reader(path);
+        const QImage scaled = ImageScaler::read(reader, QSize(100, 40));
+        QCOMPARE(scaled.size(), QSize(100, 40));
+        QCOMPARE(scaled, ImageScaler::scaled(image, QSize(100, 40)));
+        QVERIFY(maxDifference(scaled, reference(image, QSize(100, 40))) <= 1);
+        QVERIFY(scaled != image.scaled(QSize(100, 40), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    }
+
+    void testReadBroken()
+    {
+        QImageReader reader(QStringLiteral("/nonexistent.jpg"));
+        QVERIFY(ImageScaler::read(reader, QSize(10, 10)).isNull());
+    }
+};
+
+QTEST_GUILESS_MAIN(ImageScalerTest)
+
+#include "imagescalertest.moc"
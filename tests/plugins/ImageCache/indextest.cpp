@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "ImageCacheIndex.h"
+
+class ImageCacheIndexTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static ImageCacheIndex::Entry entry()
+    {
+        ImageCacheIndex::Entry entry;
+        entry.sourcePath = "/usr/share/wide.jpg";
+        entry.sourceModified = QDateTime::fromMSecsSinceEpoch(1490000000123);
+        entry.sourceSize = QSize(500, 200);
+        entry.variants.append({ QSize(250, 100), "jpeg", 1000 });
+        return entry;
+    }
+
+    static ImageCacheIndex::Entry usedEntry(qint64 bytes, qint64 lastAccessSecs)
+    {
+        ImageCacheIndex::Entry e = entry();
+        e.variants[0].bytes = bytes;
+        e.lastAccess = QDateTime::fromMSecsSinceEpoch(lastAccessSecs * 1000, Qt::UTC);
+        return e;
+    }
+
+private Q_SLOTS:
+
+    void init()
+    {
+        dir = new QTemporaryDir();
+        QVERIFY(dir->isValid());
+    }
+
+    void cleanup()
+    {
+        delete dir;
+    }
+
+    void testEmpty()
+    {
+        ImageCacheIndex index(dir->path() + "/index");
+        ImageCacheIndex::Entry found;
+        QVERIFY(!index.find("/names/foo", &found));
+        QVERIFY(!QFile::exists(index.filePath()));
+    }
+
+    void testPersisted()
+    {
+        {
+            ImageCacheIndex index(dir->path() + "/imagecache/index");
+            index.insert("/names/foo", entry());
+        }
+
+        ImageCacheIndex index(dir->path() + "/imagecache/index");
+        ImageCacheIndex::Entry found;
+        QVERIFY(index.find("/names/foo", &found));
+        QCOMPARE(found.sourcePath, entry().sourcePath);
+        QCOMPARE(found.sourceModified, entry().sourceModified);
+        QCOMPARE(found.sourceSize, entry().sourceSize);
+        QCOMPARE(found.variants.count(), 1);
+        QCOMPARE(found.variants[0].size, QSize(250, 100));
+        QCOMPARE(found.variants[0].format, QByteArray("jpeg"));
+        QCOMPARE(found.variants[0].bytes, qint64(1000));
+        QVERIFY(found.lastAccess.isValid());
+    }
+
+    void testTouch()
+    {
+        {
+            ImageCacheIndex index(dir->path() + "/index");
+            index.insert("/names/foo", usedEntry(1000, 1000));
+            index.touch("/names/foo");
+            index.touch("/names/missing");
+        }
+
+        // Saved when the index goes away
+        ImageCacheIndex index(dir->path() + "/index");
+        ImageCacheIndex::Entry found;
+        QVERIFY(index.find("/names/foo", &found));
+        QVERIFY(found.lastAccess > QDateTime::fromMSecsSinceEpoch(1000000, Qt::UTC));
+        QVERIFY(!index.find("/names/missing", &found));
+    }
+
+    void testTotals()
+    {
+        ImageCacheIndex index(dir->path() + "/index");
+        auto e = usedEntry(1000, 1000);
+        e.setVariant({ QSize(100, 40), "png", 300 });
+        index.insert("/names/foo", e);
+        index.insert("/names/bar", usedEntry(200, 1000));
+
+        QCOMPARE(index.count(), 2);
+        QCOMPARE(index.bytes(), qint64(1500));
+        QVERIFY(index.contains("/names/foo", QSize(100, 40)));
+        QVERIFY(!index.contains("/names/foo", QSize(50, 20)));
+        QVERIFY(!index.contains("/names/baz", QSize(100, 40)));
+    }
+
+    void testEvict_data()
+    {
+        QTest::addColumn<qint64>("maxBytes");
+        QTest::addColumn<int>("maxEntries");
+        QTest::addColumn<QStringList>("kept");
+
+        QTest::newRow("within quota") << qint64(10000) << 10 << (QStringList() << "/names/a" << "/names/b" << "/names/c");
+        QTest::newRow("bytes") << qint64(2500) << 10 << (QStringList() << "/names/b" << "/names/c");
+        QTest::newRow("entries") << qint64(10000) << 1 << (QStringList() << "/names/b");
+        QTest::newRow("everything") << qint64(0) << 10 << QStringList();
+    }
+
+    void testEvict()
+    {
+        QFETCH(qint64, maxBytes);
+        QFETCH(int, maxEntries);
+        QFETCH(QStringList, kept);
+
+        {
+            ImageCacheIndex index(dir->path() + "/index");
+            // Least recently used first: a, c, b
+            index.insert("/names/a", usedEntry(1000, 1000));
+            index.insert("/names/b", usedEntry(1000, 3000));
+            index.insert("/names/c", usedEntry(1000, 2000));
+
+            const auto evicted = index.evict(maxBytes, maxEntries);
+            QCOMPARE(evicted.count(), 3 - kept.count());
+            if (!evicted.isEmpty()) {
+                QCOMPARE(evicted.first().first, QString("/names/a"));
+                QCOMPARE(evicted.first().second.variants.count(), 1);
+            }
+        }
+
+        ImageCacheIndex index(dir->path() + "/index");
+        QCOMPARE(index.count(), kept.count());
+        Q_FOREACH(const QString &key, kept) {
+            ImageCacheIndex::Entry found;
+            QVERIFY(index.find(key, &found));
+        }
+    }
+
+    void testRemove()
+    {
+        {
+            ImageCacheIndex index(dir->path() + "/index");
+            index.insert("/names/foo", entry());
+            index.insert("/names/bar", entry());
+            index.remove("/names/foo");
+        }
+
+        ImageCacheIndex index(dir->path() + "/index");
+        ImageCacheIndex::Entry found;
+        QVERIFY(!index.find("/names/foo", &found));
+        QVERIFY(index.find("/names/bar", &found));
+    }
+
+    void testBatchedSaves()
+    {
+        ImageCacheIndex index(dir->path() + "/index");
+        index.insert("/names/foo", entry());
+        index.insert("/names/bar", entry());
+        index.remove("/names/foo");
+
+        // Only the first change was written right away
+        ImageCacheIndex::Entry found;
+        {
+            ImageCacheIndex saved(index.filePath());
+            QVERIFY(saved.find("/names/foo", &found));
+            QVERIFY(!saved.find("/names/bar", &found));
+        }
+
+        // The quota pass writes the rest
+        index.evict(10000, 10);
+        ImageCacheIndex saved(index.filePath());
+        QVERIFY(!saved.find("/names/foo", &found));
+        QVERIFY(saved.find("/names/bar", &found));
+    }
+
+    void testSetVariant()
+    {
+        auto e = entry();
+        e.setVariant({ QSize(100, 40), "png", 0 });
+        e.setVariant({ QSize(250, 100), "png", 0 });
+
+        QCOMPARE(e.variants.count(), 2);
+        QVERIFY(e.hasVariant(QSize(100, 40)));
+        QVERIFY(e.hasVariant(QSize(250, 100)));
+        QVERIFY(!e.hasVariant(QSize(50, 20)));
+        QCOMPARE(e.variants[0].format, QByteArray("png"));
+
+        e.setVariant({ QSize(100, 40), "raw", 10 });
+        QCOMPARE(e.variants.count(), 2);
+        QVERIFY(e.findVariant(QSize(100, 40)));
+        QCOMPARE(e.findVariant(QSize(100, 40))->format, QByteArray("raw"));
+        QCOMPARE(e.findVariant(QSize(100, 40))->bytes, qint64(10));
+        QVERIFY(!e.findVariant(QSize(50, 20)));
+    }
+
+    void testBrokenFile()
+    {
+        QFile file(dir->path() + "/index");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not an index");
+        file.close();
+
+        ImageCacheIndex index(file.fileName());
+        ImageCacheIndex::Entry found;
+        QVERIFY(!index.find("/names/foo", &found));
+
+        // And it is replaced on the next change
+        index.insert("/names/foo", entry());
+        ImageCacheIndex reloaded(file.fileName());
+        QVERIFY(reloaded.find("/names/foo", &found));
+    }
+
+private:
+    QTemporaryDir *dir;
+};
+
+QTEST_GUILESS_MAIN(ImageCacheIndexTest)
+
+#include "indextest.moc"
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include "ImageMemoryCache.h"
+
+class ImageMemoryCacheTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static ImageMemoryCache::Key key(const QString &path, const QSize &size = QSize(10, 10))
+    {
+        return ImageMemoryCache::Key{path, size, QDateTime::fromTime_t(1000)};
+    }
+
+    // 10x10 ARGB32, 400 bytes
+    static QImage image(QRgb color = qRgb(255, 0, 0))
+    {
+        QImage image(10, 10, QImage::Format_ARGB32);
+        image.fill(color);
+        return image;
+    }
+
+private Q_SLOTS:
+
+    void testHitAndMiss()
+    {
+        ImageMemoryCache cache(4000);
+        QVERIFY(cache.find(key("a")).isNull());
+
+        cache.insert(key("a"), image(qRgb(0, 255, 0)));
+        const QImage found = cache.find(key("a"));
+        QCOMPARE(found.pixel(0, 0), qRgb(0, 255, 0));
+
+        auto stats = cache.stats();
+        QCOMPARE(stats.hits, qint64(1));
+        QCOMPARE(stats.misses, qint64(1));
+        QCOMPARE(stats.count, 1);
+        QCOMPARE(stats.bytes, qint64(400));
+        QCOMPARE(stats.maxBytes, qint64(4000));
+    }
+
+    void testKey()
+    {
+        ImageMemoryCache cache(4000);
+        cache.insert(key("a"), image());
+
+        QVERIFY(cache.find(key("b")).isNull());
+        QVERIFY(cache.find(key("a", QSize(20, 20))).isNull());
+        // A source modified after it was cached is a miss
+        QVERIFY(cache.find(ImageMemoryCache::Key{"a", QSize(10, 10), QDateTime::fromTime_t(2000)}).isNull());
+        QVERIFY(!cache.find(key("a")).isNull());
+    }
+
+    void testLeastRecentlyUsedIsEvicted()
+    {
+        ImageMemoryCache cache(1200);
+        cache.insert(key("a"), image());
+        cache.insert(key("b"), image());
+        cache.insert(key("c"), image());
+
+        // Makes "b" the least recently used
+        QVERIFY(!cache.find(key("a")).isNull());
+        cache.insert(key("d"), image());
+
+        QVERIFY(cache.find(key("b")).isNull());
+        QVERIFY(!cache.find(key("a")).isNull());
+        QVERIFY(!cache.find(key("c")).isNull());
+        QVERIFY(!cache.find(key("d")).isNull());
+
+        auto stats = cache.stats();
+        QCOMPARE(stats.evictions, qint64(1));
+        QCOMPARE(stats.count, 3);
+        QCOMPARE(stats.bytes, qint64(1200));
+    }
+
+    void testReplaceIsNotEviction()
+    {
+        ImageMemoryCache cache(1200);
+        cache.insert(key("a"), image());
+        cache.insert(key("a"), image(qRgb(0, 0, 255)));
+
+        QCOMPARE(cache.find(key("a")).pixel(0, 0), qRgb(0, 0, 255));
+        QCOMPARE(cache.stats().evictions, qint64(0));
+        QCOMPARE(cache.stats().count, 1);
+    }
+
+    void testTooBigIsNotCached()
+    {
+        ImageMemoryCache cache(300);
+        cache.insert(key("a"), image());
+
+        QVERIFY(cache.find(key("a")).isNull());
+        QCOMPARE(cache.stats().count, 0);
+        QCOMPARE(cache.stats().bytes, qint64(0));
+    }
+};
+
+QTEST_GUILESS_MAIN(ImageMemoryCacheTest)
+
+#include "memorycachetest.moc"
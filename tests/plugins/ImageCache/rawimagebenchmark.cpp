@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares reading an image back from the cache in the formats it can be
+ * stored in. Every read also touches all the pixels, like uploading the
+ * image to a texture would, so the lazily mapped raw files are not
+ * measured as free.
+ */
+
+#include <QImageReader>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "RawImage.h"
+
+class RawImageBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    // A photo-like image, so the compressed formats don't get it for free
+    static QImage sampleImage(const QSize &size)
+    {
+        QImage image(size, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&image);
+        QLinearGradient gradient(0, 0, size.width(), size.height());
+        gradient.setColorAt(0, QColor(230, 80, 30));
+        gradient.setColorAt(1, QColor(30, 60, 200));
+        painter.fillRect(image.rect(), gradient);
+        painter.end();
+
+        quint32 seed = 1;
+        for (int y = 0; y < image.height(); ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                seed = seed * 1103515245 + 12345;
+                const int noise = int((seed >> 16) % 32) - 16;
+                const QRgb pixel = line[x];
+                line[x] = qRgb(qBound(0, qRed(pixel) + noise, 255),
+                               qBound(0, qGreen(pixel) + noise, 255),
+                               qBound(0, qBlue(pixel) + noise, 255));
+            }
+        }
+        return image;
+    }
+
+    static quint32 checksum(const QImage &image)
+    {
+        quint32 sum = 0;
+        for (int y = 0; y < image.height(); ++y) {
+            const uchar *line = image.constScanLine(y);
+            for (int i = 0; i < image.bytesPerLine(); ++i) {
+                sum += line[i];
+            }
+        }
+        return sum;
+    }
+
+    QString path(const QByteArray &format, const QSize &size) const
+    {
+        return QStringLiteral("%1/%2x%3.%4").arg(m_dir.path()).arg(size.width())
+                                            .arg(size.height()).arg(QString::fromLatin1(format));
+    }
+
+    static bool write(const QImage &image, const QByteArray &format, const QString &path)
+    {
+        if (format == RawImage::formatName()) {
+            return RawImage::write(image, path);
+        }
+        return image.save(path, format.constData(), 100);
+    }
+
+    void addData()
+    {
+        QTest::addColumn<QByteArray>("format");
+        QTest::addColumn<QSize>("size");
+
+        const QList<QByteArray> formats = { "jpeg", "png", RawImage::formatName() };
+        // A launcher icon and a screen wide dash art or wallpaper
+        const QList<QSize> sizes = { QSize(256, 256), QSize(1080, 1920) };
+        Q_FOREACH(const QByteArray &format, formats) {
+            Q_FOREACH(const QSize &size, sizes) {
+                const QByteArray tag = format + '-' + QByteArray::number(size.width()) + 'x' + QByteArray::number(size.height());
+                QTest::newRow(tag.constData()) << format << size;
+            }
+        }
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void benchmarkRead_data()
+    {
+        addData();
+    }
+
+    void benchmarkRead()
+    {
+        QFETCH(QByteArray, format);
+        QFETCH(QSize, size);
+
+        const QString filePath = path(format, size);
+        QVERIFY(write(sampleImage(size), format, filePath));
+
+        quint32 sum = 0;
+        QBENCHMARK {
+            QImage image;
+            if (format == RawImage::formatName()) {
+                image = RawImage::read(filePath);
+            } else {
+                QImageReader reader(filePath, format);
+                image = reader.read();
+            }
+            QCOMPARE(image.size(), size);
+            sum += checksum(image);
+        }
+        QVERIFY(sum != 0);
+    }
+
+    void benchmarkWrite_data()
+    {
+        addData();
+    }
+
+    void benchmarkWrite()
+    {
+        QFETCH(QByteArray, format);
+        QFETCH(QSize, size);
+
+        const QImage image = sampleImage(size);
+        const QString filePath = path(format, size);
+        QBENCHMARK {
+            QVERIFY(write(image, format, filePath));
+        }
+        QFileInfo info(filePath);
+        qDebug() << "File size:" << info.size();
+    }
+
+private:
+    QTemporaryDir m_dir;
+};
+
+QTEST_GUILESS_MAIN(RawImageBenchmark)
+
+#include "rawimagebenchmark.moc"
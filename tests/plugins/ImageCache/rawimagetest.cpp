@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "RawImage.h"
+
+class RawImageTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString path(const QString &name) const
+    {
+        return m_dir.path() + QLatin1Char('/') + name;
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void testRoundTrip()
+    {
+        QImage image(13, 7, QImage::Format_ARGB32);
+        image.fill(qRgba(255, 0, 0, 255));
+        image.setPixel(3, 4, qRgba(0, 0, 255, 128));
+
+        QVERIFY(RawImage::write(image, path("roundtrip")));
+
+        const QImage read = RawImage::read(path("roundtrip"));
+        QCOMPARE(read.size(), QSize(13, 7));
+        QCOMPARE(read.format(), QImage::Format_ARGB32_Premultiplied);
+        QCOMPARE(read, image.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    }
+
+    void testOutlivesFile()
+    {
+        QImage image(4, 4, QImage::Format_RGB32);
+        image.fill(qRgb(0, 255, 0));
+        QVERIFY(RawImage::write(image, path("replaced")));
+        const QImage read = RawImage::read(path("replaced"));
+
+        // Replacing the file renames a new one over it, the mapping stays valid
+        image.fill(qRgb(0, 0, 255));
+        QVERIFY(RawImage::write(image, path("replaced")));
+        QCOMPARE(read.pixel(0, 0), qRgb(0, 255, 0));
+        QCOMPARE(RawImage::read(path("replaced")).pixel(0, 0), qRgb(0, 0, 255));
+    }
+
+    void testNotRaw()
+    {
+        QImage image(4, 4, QImage::Format_RGB32);
+        image.fill(qRgb(0, 255, 0));
+        QVERIFY(image.save(path("image.png"), "png"));
+
+        QVERIFY(RawImage::read(path("image.png")).isNull());
+        QVERIFY(RawImage::read(path("missing")).isNull());
+    }
+
+    void testTruncated()
+    {
+        QImage image(16, 16, QImage::Format_RGB32);
+        image.fill(qRgb(0, 255, 0));
+        QVERIFY(RawImage::write(image, path("truncated")));
+
+        QFile file(path("truncated"));
+        QVERIFY(file.resize(file.size() - 1));
+        QVERIFY(RawImage::read(path("truncated")).isNull());
+
+        QVERIFY(file.resize(10));
+        QVERIFY(RawImage::read(path("truncated")).isNull());
+    }
+
+private:
+    QTemporaryDir m_dir;
+};
+
+QTEST_GUILESS_MAIN(RawImageTest)
+
+#include "rawimagetest.moc"
@@ -15,8 +15,12 @@
  */
 
 #include <QCoreApplication>
+#include <QDir>
 #include <QFileInfo>
 #include <QImageReader>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
 #include <QQuickView>
 #include <QTemporaryDir>
 #include <QtTestGui>
@@ -26,6 +30,8 @@
 
 #include <paths.h>
 
+#include "ImageCacheIndex.h"
+
 Q_DECLARE_METATYPE(QQuickImage::Status)
 
 class ImageCacheTest : public QObject
@@ -57,12 +63,26 @@ private:
         return testDataDir() + "/" TEST_DIR "/graphics/" + name;
     }
 
-    QString cachedFile(bool isPath, const QString &name)
+    QString cacheRoot()
+    {
+        return home->path() + "/.cache/unity8/imagecache";
+    }
+
+    QString cachedFile(bool isPath, const QString &name, const QSize &size)
     {
+        const QString variant = QString("@%1x%2").arg(size.width()).arg(size.height());
         if (isPath)
-            return home->path() + "/.cache/unity8/imagecache/paths" + sourceFile(name);
+            return cacheRoot() + "/paths" + sourceFile(name) + variant;
         else
-            return home->path() + "/.cache/unity8/imagecache/names/" + name;
+            return cacheRoot() + "/names/" + name + variant;
+    }
+
+    void createVariant(const QString &cachePath, const QSize &size, QRgb color)
+    {
+        QImage variant(size, QImage::Format_RGB32);
+        variant.fill(color);
+        QFileInfo(cachePath).dir().mkpath(QStringLiteral("."));
+        QVERIFY(variant.save(cachePath, "PNG"));
     }
 
     void createCachedImage(const QString &name, const QString &cachePath, const QSize &cacheSize, time_t mtime_in = 0)
@@ -86,14 +106,9 @@ private:
         QCOMPARE(utime(cachePath.toUtf8().data(), &timebuffer), 0);
     }
 
-private Q_SLOTS:
-
-    void init()
+    // The provider is created with the engine, and reads its settings then
+    void createView()
     {
-        home = new QTemporaryDir();
-        QVERIFY(home->isValid());
-        qputenv("HOME", home->path().toUtf8());
-
         view = new QQuickView();
         view->setSource(QUrl::fromLocalFile(testDataDir() + "/" TEST_DIR "/test.qml"));
         image = view->rootObject();
@@ -104,38 +119,76 @@ private Q_SLOTS:
         waitForImage(QQuickImage::Null);
     }
 
+    // Files cached before there was an index are only taken in by the
+    // compaction on startup
+    void restartView()
+    {
+        delete view;
+        createView();
+        waitForCompaction();
+    }
+
+    void waitForCompaction()
+    {
+        QQmlComponent component(view->engine());
+        component.setData("import QtQuick 2.4\n"
+                          "import ImageCache 0.1\n"
+                          "QtObject { property QtObject stats: ImageCacheStats }", QUrl());
+        QScopedPointer<QObject> statsHolder(component.create());
+        QVERIFY(statsHolder);
+        QObject *stats = statsHolder->property("stats").value<QObject *>();
+        QVERIFY(stats);
+        auto compactions = [stats]() {
+            QMetaObject::invokeMethod(stats, "refresh");
+            return stats->property("compactions").toInt();
+        };
+        QTRY_VERIFY(compactions() > 0);
+    }
+
+private Q_SLOTS:
+
+    void init()
+    {
+        home = new QTemporaryDir();
+        QVERIFY(home->isValid());
+        qputenv("HOME", home->path().toUtf8());
+
+        createView();
+    }
+
     void cleanup()
     {
         delete view;
         delete home;
+        qunsetenv("UNITY8_IMAGECACHE_MAX_ENTRIES");
     }
 
     void testFileNotFound()
     {
         setUpImage("NOTHERE");
         waitForImage(QQuickImage::Error);
-        QVERIFY(!QFile::exists(cachedFile(true, "NOTHERE")));
+        QVERIFY(!QFile::exists(cacheRoot()));
     }
 
     void testNoSourceSize()
     {
         setUpImage("wide.jpg");
         waitForImage();
-        QVERIFY(!QFile::exists(cachedFile(true, "wide.jpg")));
+        QVERIFY(!QFile::exists(cacheRoot()));
     }
 
     void testNoScalingUp()
     {
         setUpImage("wide.jpg", QSize(1000, 1000));
         waitForImage();
-        QVERIFY(!QFile::exists(cachedFile(true, "wide.jpg")));
+        QVERIFY(!QFile::exists(cacheRoot()));
     }
 
     void testFullSourceSize()
     {
         setUpImage("wide.jpg", QSize(100, 100));
         waitForImage();
-        QCOMPARE(cachedImageSize(cachedFile(true, "wide.jpg")), QSize(100, 100));
+        QCOMPARE(cachedImageSize(cachedFile(true, "wide.jpg", QSize(100, 100))), QSize(100, 100));
     }
 
     void testWidthSourceSize()
@@ -143,7 +196,7 @@ private Q_SLOTS:
         setUpImage("wide.jpg", QSize(100, 0));
         waitForImage();
         // wide.jpg is 500x200
-        QCOMPARE(cachedImageSize(cachedFile(true, "wide.jpg")), QSize(100, 40));
+        QCOMPARE(cachedImageSize(cachedFile(true, "wide.jpg", QSize(100, 40))), QSize(100, 40));
     }
 
     void testHeightSourceSize()
@@ -151,22 +204,24 @@ private Q_SLOTS:
         setUpImage("wide.jpg", QSize(0, 100));
         waitForImage();
         // wide.jpg is 500x200
-        QCOMPARE(cachedImageSize(cachedFile(true, "wide.jpg")), QSize(250, 100));
+        QCOMPARE(cachedImageSize(cachedFile(true, "wide.jpg", QSize(250, 100))), QSize(250, 100));
     }
 
     void testNameArg()
     {
         setUpImage("wide.jpg?name=foo", QSize(0, 100));
         waitForImage();
-        QVERIFY(!QFile::exists(cachedFile(true, ""))); // check for dir itself
-        QVERIFY(QFile::exists(cachedFile(false, "foo")));
+        QVERIFY(!QFile::exists(cacheRoot() + "/paths")); // check for dir itself
+        QVERIFY(QFile::exists(cachedFile(false, "foo", QSize(250, 100))));
+        QVERIFY(QFile::exists(cacheRoot() + "/index"));
     }
 
     void testLoadCache()
     {
-        auto cacheName = cachedFile(false, "foo");
+        auto cacheName = cachedFile(false, "foo", QSize(250, 100));
         createCachedImage("wide.jpg", cacheName, QSize(250, 100));
         auto mtime = QFileInfo(cacheName).lastModified();
+        restartView();
 
         auto now = time(NULL);
         QVERIFY(QFileInfo(cacheName).lastModified().toTime_t() < now); // sanity check
@@ -174,28 +229,219 @@ private Q_SLOTS:
         setUpImage("wide.jpg?name=foo", QSize(0, 100));
         waitForImage();
         QCOMPARE(QFileInfo(cacheName).lastModified(), mtime); // wasn't recreated
+
+        // Its format had to be found out once, the index has it now
+        delete view;
+        view = nullptr;
+        ImageCacheIndex index(cacheRoot() + "/index");
+        ImageCacheIndex::Entry entry;
+        QVERIFY(index.find("/names/foo", &entry));
+        QVERIFY(entry.findVariant(QSize(250, 100)));
+        QCOMPARE(entry.findVariant(QSize(250, 100))->format, QByteArray("jpeg"));
     }
 
-    void testDifferentSize()
+    void testLoadCachePath()
     {
-        auto cacheName = cachedFile(false, "foo");
+        auto cacheName = cachedFile(true, "wide.jpg", QSize(250, 100));
         createCachedImage("wide.jpg", cacheName, QSize(250, 100));
+        auto mtime = QFileInfo(cacheName).lastModified();
+        restartView();
+
+        setUpImage("wide.jpg", QSize(0, 100));
+        waitForImage();
+        QCOMPARE(QFileInfo(cacheName).lastModified(), mtime); // wasn't recreated
+    }
 
+    void testNotIndexedIsNotLookedFor()
+    {
+        // Appeared after startup, so the index doesn't know about it
+        waitForCompaction();
+        auto cacheName = cachedFile(false, "foo", QSize(250, 100));
+        createCachedImage("wide.jpg", cacheName, QSize(250, 100));
         auto now = time(NULL);
-        QVERIFY(QFileInfo(cacheName).lastModified().toTime_t() < now); // sanity check
 
-        setUpImage("wide.jpg?name=foo", QSize(100, 0));
+        setUpImage("wide.jpg?name=foo", QSize(0, 100));
         waitForImage();
         QVERIFY(QFileInfo(cacheName).lastModified().toTime_t() >= now); // was recreated
     }
 
+    void testDifferentSize()
+    {
+        auto cacheName = cachedFile(false, "foo", QSize(250, 100));
+        createCachedImage("wide.jpg", cacheName, QSize(250, 100));
+        auto mtime = QFileInfo(cacheName).lastModified();
+        restartView();
+
+        setUpImage("wide.jpg?name=foo", QSize(100, 0));
+        waitForImage();
+        QCOMPARE(cachedImageSize(cachedFile(false, "foo", QSize(100, 40))), QSize(100, 40));
+        QCOMPARE(QFileInfo(cacheName).lastModified(), mtime); // other size was kept
+    }
+
+    void testNearestLargerVariant()
+    {
+        createVariant(cachedFile(false, "foo", QSize(400, 160)), QSize(400, 160), qRgb(255, 0, 0));
+        createVariant(cachedFile(false, "foo", QSize(250, 100)), QSize(250, 100), qRgb(0, 0, 255));
+        createVariant(cachedFile(false, "foo", QSize(50, 20)), QSize(50, 20), qRgb(0, 255, 0));
+        // Bigger but a different crop
+        createVariant(cachedFile(false, "foo", QSize(200, 200)), QSize(200, 200), qRgb(255, 255, 0));
+        restartView();
+
+        setUpImage("wide.jpg?name=foo", QSize(100, 0));
+        waitForImage();
+        QImage cachedImage(cachedFile(false, "foo", QSize(100, 40)));
+        QCOMPARE(cachedImage.size(), QSize(100, 40));
+        QCOMPARE(cachedImage.pixel(50, 20), qRgb(0, 0, 255));
+    }
+
+    void testConcurrentRequests()
+    {
+        // Many delegates asking for the same icon at once
+        QQmlComponent component(view->engine());
+        component.setData("import QtQuick 2.4\n"
+                          "Repeater {\n"
+                          "    model: 20\n"
+                          "    Image { asynchronous: true; cache: false; sourceSize: Qt.size(0, 100); source: url }\n"
+                          "}", QUrl());
+        const QString url = "image://unity8imagecache/file://" + sourceFile("wide.jpg") + "?name=foo";
+        view->engine()->rootContext()->setContextProperty("url", url);
+        QQuickItem *repeater = qobject_cast<QQuickItem *>(component.beginCreate(view->engine()->rootContext()));
+        QVERIFY(repeater);
+        repeater->setParent(image);
+        repeater->setParentItem(qobject_cast<QQuickItem *>(image));
+        component.completeCreate();
+
+        QList<QQuickImage *> images;
+        Q_FOREACH(QQuickItem *child, qobject_cast<QQuickItem *>(image)->childItems()) {
+            if (QQuickImage *delegate = qobject_cast<QQuickImage *>(child)) {
+                images << delegate;
+            }
+        }
+        QCOMPARE(images.count(), 20);
+        Q_FOREACH(QQuickImage *delegate, images) {
+            QTRY_COMPARE(delegate->status(), QQuickImage::Ready);
+            QCOMPARE(delegate->implicitWidth(), qreal(250));
+        }
+
+        // Just the one file, no leftovers of concurrent writes
+        QCOMPARE(QDir(cacheRoot() + "/names").entryList(QDir::Files | QDir::Hidden), QStringList() << "foo@250x100");
+        QCOMPARE(cachedImageSize(cachedFile(false, "foo", QSize(250, 100))), QSize(250, 100));
+    }
+
+    void testQuota()
+    {
+        delete view;
+        qputenv("UNITY8_IMAGECACHE_MAX_ENTRIES", "1");
+        createView();
+
+        QQmlComponent component(view->engine());
+        component.setData("import QtQuick 2.4\n"
+                          "import ImageCache 0.1\n"
+                          "QtObject { property QtObject stats: ImageCacheStats }", QUrl());
+        QScopedPointer<QObject> statsHolder(component.create());
+        QVERIFY(statsHolder);
+        QObject *stats = statsHolder->property("stats").value<QObject *>();
+        QVERIFY(stats);
+        QCOMPARE(stats->property("diskMaxCount").toInt(), 1);
+
+        setUpImage("wide.jpg?name=foo", QSize(0, 100));
+        waitForImage();
+        QVERIFY(QFile::exists(cachedFile(false, "foo", QSize(250, 100))));
+
+        setUpImage("wide.jpg?name=bar", QSize(0, 100));
+        waitForImage();
+
+        // The least recently used one is gone
+        QTRY_VERIFY(!QFile::exists(cachedFile(false, "foo", QSize(250, 100))));
+        QVERIFY(QFile::exists(cachedFile(false, "bar", QSize(250, 100))));
+        QTRY_COMPARE(stats->property("evictions").toInt(), 1);
+        QCOMPARE(stats->property("diskCount").toInt(), 1);
+    }
+
+    void testEvictionBelowQuota()
+    {
+        delete view;
+        qputenv("UNITY8_IMAGECACHE_MAX_ENTRIES", "10");
+        createView();
+        waitForCompaction();
+
+        QQmlComponent component(view->engine());
+        component.setData("import QtQuick 2.4\n"
+                          "import ImageCache 0.1\n"
+                          "QtObject { property QtObject stats: ImageCacheStats }", QUrl());
+        QScopedPointer<QObject> statsHolder(component.create());
+        QVERIFY(statsHolder);
+        QObject *stats = statsHolder->property("stats").value<QObject *>();
+        QVERIFY(stats);
+        auto property = [stats](const char *name) {
+            QMetaObject::invokeMethod(stats, "refresh");
+            return stats->property(name).toInt();
+        };
+
+        for (int i = 0; i < 11; ++i) {
+            setUpImage(QString("wide.jpg?name=foo%1").arg(i), QSize(0, 100));
+            waitForImage();
+        }
+
+        // Down to 90%, not just back to the quota
+        QTRY_COMPARE(property("evictions"), 2);
+        QCOMPARE(property("diskCount"), 9);
+        QTRY_COMPARE(property("compactions"), 2);
+        QVERIFY(!QFile::exists(cachedFile(false, "foo0", QSize(250, 100))));
+        QVERIFY(!QFile::exists(cachedFile(false, "foo1", QSize(250, 100))));
+        QVERIFY(QFile::exists(cachedFile(false, "foo2", QSize(250, 100))));
+
+        // Up to the quota without another compaction, the one after that
+        // goes over it again
+        setUpImage("wide.jpg?name=foo11", QSize(0, 100));
+        waitForImage();
+        setUpImage("wide.jpg?name=foo12", QSize(0, 100));
+        waitForImage();
+        QTRY_COMPARE(property("evictions"), 4);
+        QTRY_COMPARE(property("compactions"), 3);
+        QCOMPARE(property("diskCount"), 9);
+    }
+
+    void testPrewarm()
+    {
+        QQmlComponent component(view->engine());
+        component.setData("import QtQuick 2.4\n"
+                          "import ImageCache 0.1\n"
+                          "QtObject {\n"
+                          "    property QtObject stats: ImageCacheStats\n"
+                          "    function prewarm(source, size) { ImageCachePrewarmer.prewarm(source, size); }\n"
+                          "}", QUrl());
+        QScopedPointer<QObject> object(component.create());
+        QVERIFY(object);
+        QObject *stats = object->property("stats").value<QObject *>();
+
+        const QString url = "image://unity8imagecache/file://" + sourceFile("wide.jpg") + "?name=foo";
+        QMetaObject::invokeMethod(object.data(), "prewarm", Q_ARG(QVariant, QUrl(url)), Q_ARG(QVariant, QSize(0, 100)));
+        // Not ours, ignored
+        QMetaObject::invokeMethod(object.data(), "prewarm", Q_ARG(QVariant, QUrl::fromLocalFile(sourceFile("wide.jpg"))), Q_ARG(QVariant, QSize(0, 100)));
+
+        auto memoryCount = [stats]() {
+            QMetaObject::invokeMethod(stats, "refresh");
+            return stats->property("memoryCount").toInt();
+        };
+        QTRY_COMPARE(memoryCount(), 1);
+        QVERIFY(QFile::exists(cachedFile(false, "foo", QSize(250, 100))));
+
+        // And the Image finds it in memory
+        setUpImage("wide.jpg?name=foo", QSize(0, 100));
+        waitForImage();
+        QMetaObject::invokeMethod(stats, "refresh");
+        QCOMPARE(stats->property("memoryHits").toInt(), 1);
+    }
+
     void testStaleCache()
     {
         auto sourceName = sourceFile("wide.jpg");
         auto mtime = QFileInfo(sourceName).lastModified().toTime_t() - 5;
 
-        auto cacheName = cachedFile(false, "foo");
+        auto cacheName = cachedFile(false, "foo", QSize(250, 100));
         createCachedImage("wide.jpg", cacheName, QSize(250, 100), mtime);
+        restartView();
 
         auto now = time(NULL);
         QVERIFY(QFileInfo(cacheName).lastModified().toTime_t() < now); // sanity check
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how long a TouchGate takes to replay the events it stored while
+ * waiting for ownership of a touch that kept moving, with and without
+ * merging the stored updates. Only the replay, which happens all at once
+ * when ownership is granted, is timed.
+ */
+
+#include <qpa/qwindowsysteminterface.h>
+#include <QElapsedTimer>
+#include <QQuickView>
+#include <QtTest>
+
+#include <TouchGate.h>
+
+#include "TestItem.h"
+
+#include <paths.h>
+
+class TouchGateBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<QTouchEvent::TouchPoint> touchPoints(Qt::TouchPointState state, const QPointF &pos)
+    {
+        QTouchEvent::TouchPoint touchPoint(0);
+        touchPoint.setState(state);
+        touchPoint.setPos(pos);
+        touchPoint.setScenePos(pos);
+        return {touchPoint};
+    }
+
+    // A press, moveCount moves and a release, all held back waiting for ownership
+    void storeGesture(TouchGate *touchGate, int moveCount)
+    {
+        touchGate->m_touchInfoMap[0].ownership = TouchGate::OwnershipRequested;
+
+        ulong timestamp = 0;
+        touchGate->storeTouchEvent(m_device, Qt::NoModifier,
+                touchPoints(Qt::TouchPointPressed, QPointF(10, 10)), m_view, timestamp);
+        for (int i = 1; i <= moveCount; ++i) {
+            timestamp += 8;
+            touchGate->storeTouchEvent(m_device, Qt::NoModifier,
+                    touchPoints(Qt::TouchPointMoved, QPointF(10 + i % 500, 10)), m_view, timestamp);
+        }
+        touchGate->storeTouchEvent(m_device, Qt::NoModifier,
+                touchPoints(Qt::TouchPointReleased, QPointF(10 + moveCount % 500, 10)), m_view, timestamp);
+        touchGate->m_touchInfoMap[0].ended = true;
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        m_device = new QTouchDevice;
+        m_device->setType(QTouchDevice::TouchScreen);
+        QWindowSystemInterface::registerTouchDevice(m_device);
+
+        m_view = new QQuickView;
+        m_view->setResizeMode(QQuickView::SizeRootObjectToView);
+        m_view->setSource(QUrl::fromLocalFile(testDataDir() + "/plugins/Ubuntu/Gestures/touchGateExample.qml"));
+        m_view->show();
+        QVERIFY(QTest::qWaitForWindowExposed(m_view));
+        QVERIFY(m_view->rootObject() != 0);
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_view;
+        m_view = nullptr;
+    }
+
+    void benchmarkReplay_data()
+    {
+        QTest::addColumn<int>("moveCount");
+        QTest::addColumn<bool>("merge");
+
+        QTest::newRow("50 moves, all stored") << 50 << false;
+        QTest::newRow("50 moves, merged") << 50 << true;
+        QTest::newRow("500 moves, all stored") << 500 << false;
+        QTest::newRow("500 moves, merged") << 500 << true;
+    }
+
+    void benchmarkReplay()
+    {
+        QFETCH(int, moveCount);
+        QFETCH(bool, merge);
+
+        TouchGate *touchGate = m_view->rootObject()->findChild<TouchGate*>("touchGate");
+        QVERIFY(touchGate);
+
+        TestItem testItem;
+        testItem.setWidth(touchGate->width());
+        testItem.setHeight(touchGate->height());
+        testItem.setParentItem(m_view->rootObject());
+        touchGate->setTargetItem(&testItem);
+        touchGate->m_mergeStoredEvents = merge;
+
+        const int rounds = 20;
+        qint64 elapsed = 0;
+        int storedEvents = 0;
+        for (int round = 0; round < rounds; ++round) {
+            testItem.touchEventsReceived.clear();
+            storeGesture(touchGate, moveCount);
+            storedEvents = touchGate->m_storedEvents.count();
+
+            QElapsedTimer timer;
+            timer.start();
+            touchGate->m_touchInfoMap[0].ownership = TouchGate::OwnershipGranted;
+            touchGate->dispatchFullyOwnedEvents();
+            elapsed += timer.nsecsElapsed();
+
+            QVERIFY(touchGate->m_storedEvents.isEmpty());
+            QVERIFY(touchGate->m_touchInfoMap.isEmpty());
+        }
+
+        // The target ends up with the touch where it was last reported, either way
+        const QTouchEvent *lastEvent = testItem.touchEventsReceived.last().data();
+        QCOMPARE(lastEvent->touchPoints().first().state(), Qt::TouchPointReleased);
+        QCOMPARE(lastEvent->touchPoints().first().scenePos(), QPointF(10 + moveCount % 500, 10));
+
+        touchGate->setTargetItem(nullptr);
+        touchGate->m_mergeStoredEvents = true;
+
+        qDebug() << "Events replayed:" << storedEvents;
+        QTest::setBenchmarkResult(elapsed / rounds, QTest::WalltimeNanoseconds);
+    }
+
+private:
+    QTouchDevice *m_device;
+    QQuickView *m_view;
+};
+
+QTEST_MAIN(TouchGateBenchmark)
+
+#include "touchgatebenchmark.moc"
@@ -66,9 +66,13 @@ private:
 
 private Q_SLOTS:
     void disabledWhileHoldingTouch();
+    void mergesStoredUpdates();
+    void mergesStationaryTouchPoints();
+    void mergesIntoPressesWhenFull();
 
 private:
     QQuickView *createView();
+    static QTouchEvent::TouchPoint touchPoint(int id, Qt::TouchPointState state, const QPointF &pos);
     TouchRegistry *touchRegistry;
     QQuickView *view;
     QTouchDevice *device;
@@ -370,6 +374,102 @@ void tst_TouchGate::disabledWhileHoldingTouch()
     }
 }
 
+QTouchEvent::TouchPoint tst_TouchGate::touchPoint(int id, Qt::TouchPointState state, const QPointF &pos)
+{
+    QTouchEvent::TouchPoint touchPoint(id);
+    touchPoint.setState(state);
+    touchPoint.setPos(pos);
+    touchPoint.setScenePos(pos);
+    return touchPoint;
+}
+
+/*
+    A touch that moves for a long while before ownership is decided ends up as
+    just its press and its latest position
+ */
+void tst_TouchGate::mergesStoredUpdates()
+{
+    TouchGate touchGate;
+
+    touchGate.storeTouchEvent(device, Qt::NoModifier,
+            {touchPoint(0, Qt::TouchPointPressed, QPointF(100, 100))}, nullptr, 0);
+    for (int i = 1; i <= 500; ++i) {
+        touchGate.storeTouchEvent(device, Qt::NoModifier,
+                {touchPoint(0, Qt::TouchPointMoved, QPointF(100 + i, 100))}, nullptr, i);
+    }
+
+    QCOMPARE(touchGate.m_storedEvents.count(), 2);
+    QCOMPARE(touchGate.m_storedEvents[0].touchPoints[0].state(), Qt::TouchPointPressed);
+    QCOMPARE(touchGate.m_storedEvents[0].touchPoints[0].pos(), QPointF(100, 100));
+    QCOMPARE(touchGate.m_storedEvents[1].touchPoints[0].state(), Qt::TouchPointMoved);
+    QCOMPARE(touchGate.m_storedEvents[1].touchPoints[0].pos(), QPointF(600, 100));
+    QCOMPARE(touchGate.m_storedEvents[1].timestamp, (ulong)500);
+
+    // A release is never merged
+    touchGate.storeTouchEvent(device, Qt::NoModifier,
+            {touchPoint(0, Qt::TouchPointReleased, QPointF(600, 100))}, nullptr, 501);
+    QCOMPARE(touchGate.m_storedEvents.count(), 3);
+}
+
+/*
+    A touch point that moved and then stood still is still a moved one once merged
+ */
+void tst_TouchGate::mergesStationaryTouchPoints()
+{
+    TouchGate touchGate;
+
+    touchGate.storeTouchEvent(device, Qt::NoModifier,
+            {touchPoint(0, Qt::TouchPointPressed, QPointF(100, 100)),
+             touchPoint(1, Qt::TouchPointPressed, QPointF(200, 200))}, nullptr, 0);
+    touchGate.storeTouchEvent(device, Qt::NoModifier,
+            {touchPoint(0, Qt::TouchPointMoved, QPointF(110, 100)),
+             touchPoint(1, Qt::TouchPointStationary, QPointF(200, 200))}, nullptr, 10);
+    touchGate.storeTouchEvent(device, Qt::NoModifier,
+            {touchPoint(0, Qt::TouchPointStationary, QPointF(110, 100)),
+             touchPoint(1, Qt::TouchPointMoved, QPointF(210, 200))}, nullptr, 20);
+
+    QCOMPARE(touchGate.m_storedEvents.count(), 2);
+    const auto &touchPoints = touchGate.m_storedEvents[1].touchPoints;
+    QCOMPARE(touchPoints.count(), 2);
+    QCOMPARE(touchPoints[0].state(), Qt::TouchPointMoved);
+    QCOMPARE(touchPoints[0].pos(), QPointF(110, 100));
+    QCOMPARE(touchPoints[1].state(), Qt::TouchPointMoved);
+    QCOMPARE(touchPoints[1].pos(), QPointF(210, 200));
+}
+
+/*
+    Updates stop taking room of their own once the store is full
+ */
+void tst_TouchGate::mergesIntoPressesWhenFull()
+{
+    TouchGate touchGate;
+
+    touchGate.storeTouchEvent(device, Qt::NoModifier,
+            {touchPoint(0, Qt::TouchPointPressed, QPointF(100, 100))}, nullptr, 0);
+
+    // Fingers keep landing while touch 0 moves
+    const int fingers = TouchGate::MAX_STORED_EVENTS;
+    for (int i = 1; i <= fingers; ++i) {
+        touchGate.storeTouchEvent(device, Qt::NoModifier,
+                {touchPoint(0, Qt::TouchPointStationary, QPointF(100 + i, 100)),
+                 touchPoint(i, Qt::TouchPointPressed, QPointF(200, 200))}, nullptr, 2 * i);
+        touchGate.storeTouchEvent(device, Qt::NoModifier,
+                {touchPoint(0, Qt::TouchPointMoved, QPointF(101 + i, 100)),
+                 touchPoint(i, Qt::TouchPointMoved, QPointF(201, 200))}, nullptr, 2 * i + 1);
+    }
+
+    // Every press is kept, not every update
+    QVERIFY(touchGate.m_storedEvents.count() < 1 + 2 * fingers);
+    QVERIFY(touchGate.m_storedEvents.count() >= 1 + fingers);
+
+    const TouchGate::TouchEvent &lastEvent = touchGate.m_storedEvents.last();
+    QCOMPARE(lastEvent.touchPoints.count(), 2);
+    QCOMPARE(lastEvent.touchPoints[0].state(), Qt::TouchPointMoved);
+    QCOMPARE(lastEvent.touchPoints[0].pos(), QPointF(101 + fingers, 100));
+    QCOMPARE(lastEvent.touchPoints[1].state(), Qt::TouchPointPressed);
+    QCOMPARE(lastEvent.touchPoints[1].pos(), QPointF(201, 200));
+}
+
 ///////////// CandidateItem /////////////////////////////////////////////////////////////
 
 void CandidateItem::touchEvent(QTouchEvent *event)
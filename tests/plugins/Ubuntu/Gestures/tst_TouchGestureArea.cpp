@@ -45,6 +45,9 @@ private Q_SLOTS:
     void releaseAndPressRecognisedGestureDoesNotRejectForPeriod();
     void topAreaReceivesOwnershipFirstWithEqualPoints();
     void topAreaReceivesOwnershipFirstWithMorePoints();
+    void reusesTouchPoints();
+    void reusedTouchPointNotifies();
+    void coalescesUpdatesPerFrame();
 
 private:
     void initGestureComponent(TouchGestureArea *area);
@@ -75,6 +78,8 @@ void tst_TouchGestureArea::init()
 {
     GestureTest::init();
 
+    qRegisterMetaType<QList<QObject*>>("QList<QObject*>");
+
     m_blueRect = m_view->rootObject()->findChild<QQuickItem*>("blueRect");
     Q_ASSERT(m_blueRect != nullptr);
 
@@ -265,6 +270,96 @@ void tst_TouchGestureArea::topAreaReceivesOwnershipFirstWithMorePoints()
     QCOMPARE((int)m_gestureMiddle->status(), (int)TouchGestureArea::Rejected);
 }
 
+void tst_TouchGestureArea::reusesTouchPoints()
+{
+    m_gestureBottom->setEnabled(true);
+
+    QPointF touchPoint = calculateInitialTouchPos(m_gestureBottom);
+
+    sendTouchPress(0, 0, touchPoint);
+    QCOMPARE((int)m_gestureBottom->status(), (int)TouchGestureArea::Recognized);
+    // One for the live touch point and one for the cached one
+    QCOMPARE(m_gestureBottom->m_touchPointPool.count(), TouchGestureArea::PREALLOCATED_TOUCH_POINTS - 2);
+
+    sendTouchRelease(10, 0, touchPoint);
+    sendTouchPress(20, 1, touchPoint);
+
+    // The new touch got the ones the released touch had
+    QCOMPARE(m_gestureBottom->m_touchPointPool.count(), TouchGestureArea::PREALLOCATED_TOUCH_POINTS - 2);
+}
+
+void tst_TouchGestureArea::reusedTouchPointNotifies()
+{
+    m_gestureBottom->setEnabled(true);
+
+    QSignalSpy releasedSpy(m_gestureBottom, &TouchGestureArea::released);
+    QPointF touchPoint = calculateInitialTouchPos(m_gestureBottom);
+
+    sendTouchPress(0, 0, touchPoint);
+    sendTouchRelease(10, 0, touchPoint);
+    QCOMPARE(releasedSpy.count(), 1);
+
+    // Held on to like QML would, by a binding to the released point
+    GestureTouchPoint *released = qobject_cast<GestureTouchPoint*>(
+        releasedSpy.first().first().value<QList<QObject*>>().first());
+    QVERIFY(released);
+    QCOMPARE(released->id(), 0);
+    QCOMPARE(released->pressed(), false);
+    const qreal releasedX = released->x();
+    QSignalSpy idSpy(released, &GestureTouchPoint::idChanged);
+    QSignalSpy pressedSpy(released, &GestureTouchPoint::pressedChanged);
+    QSignalSpy xSpy(released, &GestureTouchPoint::xChanged);
+
+    sendTouchPress(20, 1, touchPoint + QPointF(30, 0));
+
+    // It is handed out again for the new touch, and says so
+    QCOMPARE(released->id(), 1);
+    QCOMPARE(idSpy.count(), 1);
+    QCOMPARE(released->pressed(), true);
+    QCOMPARE(pressedSpy.count(), 1);
+    QCOMPARE(released->x(), releasedX + 30);
+    QCOMPARE(xSpy.count(), 1);
+}
+
+void tst_TouchGestureArea::coalescesUpdatesPerFrame()
+{
+    m_gestureBottom->setEnabled(true);
+    m_gestureBottom->setCoalesceUpdates(true);
+
+    QSignalSpy updatedSpy(m_gestureBottom, &TouchGestureArea::updated);
+    QSignalSpy releasedSpy(m_gestureBottom, &TouchGestureArea::released);
+    QQmlListProperty<GestureTouchPoint> touchPoints = m_gestureBottom->touchPoints();
+
+    QPointF touchPoint = calculateInitialTouchPos(m_gestureBottom);
+
+    sendTouchPress(0, 0, touchPoint);
+    QCOMPARE((int)m_gestureBottom->status(), (int)TouchGestureArea::Recognized);
+
+    for (int i = 1; i <= 5; ++i) {
+        sendTouchUpdate(i * 5, 0, touchPoint + QPointF(i * 10, 0));
+    }
+
+    // Nothing until the next frame
+    QCOMPARE(updatedSpy.count(), 0);
+    QCOMPARE(touchPoints.count(&touchPoints), 1);
+    QCOMPARE(touchPoints.at(&touchPoints, 0)->x(), touchPoint.x());
+
+    Q_EMIT m_view->afterAnimating();
+
+    QCOMPARE(updatedSpy.count(), 1);
+    QCOMPARE(touchPoints.at(&touchPoints, 0)->x(), touchPoint.x() + 50);
+
+    Q_EMIT m_view->afterAnimating();
+    QCOMPARE(updatedSpy.count(), 1);
+
+    sendTouchUpdate(30, 0, touchPoint + QPointF(60, 0));
+    sendTouchRelease(35, 0, touchPoint + QPointF(60, 0));
+
+    // The pending movement is reported ahead of the release
+    QCOMPARE(updatedSpy.count(), 2);
+    QCOMPARE(releasedSpy.count(), 1);
+}
+
 QTEST_MAIN(tst_TouchGestureArea)
 
 #include "tst_TouchGestureArea.moc"
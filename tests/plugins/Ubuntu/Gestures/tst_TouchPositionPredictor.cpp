@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QtCore/qmath.h>
+
+#include <TouchPositionPredictor.h>
+#include <UbuntuGestures/private/timer_p.h>
+
+UG_USE_NAMESPACE
+
+namespace {
+
+/*
+    A finger moving along a known path, as a touchscreen would report it:
+    roughly every 8ms, with some jitter in the timestamps, and positions
+    rounded to whole pixels after some noise.
+ */
+struct Trace
+{
+    enum Path {
+        Swipe, // accelerates then decelerates, like pulling the launcher out
+        SteadyDrag,
+        Arc
+    };
+
+    Trace(Path path) : path(path) {}
+
+    QPointF positionAt(qreal time) const
+    {
+        switch (path) {
+        case Swipe: {
+            const qreal progress = qMin(time / 300., 1.);
+            return QPointF(400 * (1 - qCos(M_PI * progress)) / 2, 5 * qSin(time / 100));
+        }
+        case SteadyDrag:
+            return QPointF(0.5 * time, 0.1 * time);
+        case Arc:
+        default:
+            return QPointF(200 * qCos(time / 400 * M_PI), 200 * qSin(time / 400 * M_PI));
+        }
+    }
+
+    QList<QPair<qint64, QPointF>> events() const
+    {
+        QList<QPair<qint64, QPointF>> result;
+        quint32 seed = 1;
+        auto random = [&seed]() {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) % 1000 / 1000.;
+        };
+
+        for (qint64 time = 0; time <= 600; time += 7 + qFloor(random() * 3)) {
+            QPointF position = positionAt(time);
+            position.rx() = qRound(position.x() + random() - 0.5);
+            position.ry() = qRound(position.y() + random() - 0.5);
+            result.append(qMakePair(time, position));
+        }
+        return result;
+    }
+
+    Path path;
+};
+
+qreal distance(const QPointF &a, const QPointF &b)
+{
+    const QPointF delta = a - b;
+    return qSqrt(delta.x() * delta.x() + delta.y() * delta.y());
+}
+
+} // namespace {
+
+class tst_TouchPositionPredictor : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init(); // called right before each and every test function is executed
+    void cleanup(); // called right after each and every test function is executed
+
+    void notEnoughSamples();
+    void constantVelocity();
+    void standingStill();
+    void settlesWhenIdle();
+    void disabled();
+    void traces_data();
+    void traces();
+
+private:
+    void moveTo(qint64 time, const QPointF &position);
+
+    TouchPositionPredictor *predictor;
+    FakeTimerFactory *fakeTimerFactory;
+};
+
+void tst_TouchPositionPredictor::init()
+{
+    fakeTimerFactory = new FakeTimerFactory;
+
+    predictor = new TouchPositionPredictor(fakeTimerFactory->timeSource());
+    predictor->setIdleTimer(fakeTimerFactory->createTimer(predictor));
+    predictor->setPredictionTime(16);
+}
+
+void tst_TouchPositionPredictor::cleanup()
+{
+    delete predictor;
+    predictor = nullptr;
+
+    delete fakeTimerFactory;
+    fakeTimerFactory = nullptr;
+}
+
+void tst_TouchPositionPredictor::moveTo(qint64 time, const QPointF &position)
+{
+    fakeTimerFactory->updateTime(time);
+    predictor->setTrackedPosition(position);
+}
+
+void tst_TouchPositionPredictor::notEnoughSamples()
+{
+    moveTo(0, QPointF(0, 0));
+    moveTo(10, QPointF(20, 10));
+
+    QCOMPARE(predictor->predictedPosition(), QPointF(20, 10));
+}
+
+void tst_TouchPositionPredictor::constantVelocity()
+{
+    moveTo(0, QPointF(0, 0));
+    moveTo(10, QPointF(20, 10));
+    moveTo(20, QPointF(40, 20));
+    moveTo(30, QPointF(60, 30));
+
+    // 2 and 1 pixels per millisecond, 16 milliseconds ahead
+    QCOMPARE(predictor->predictedPosition(), QPointF(92, 46));
+}
+
+void tst_TouchPositionPredictor::standingStill()
+{
+    for (int i = 0; i < 5; ++i) {
+        moveTo(i * 8, QPointF(50, 50));
+    }
+
+    QCOMPARE(predictor->predictedPosition(), QPointF(50, 50));
+}
+
+void tst_TouchPositionPredictor::settlesWhenIdle()
+{
+    moveTo(0, QPointF(0, 0));
+    moveTo(10, QPointF(20, 0));
+    moveTo(20, QPointF(40, 0));
+    QVERIFY(predictor->predictedPosition() != QPointF(40, 0));
+
+    // The touchscreen stops reporting a finger that stopped moving
+    for (qint64 time = 20; time <= 20 + 4 * TouchPositionPredictor::IDLE_TIME; time += 5) {
+        fakeTimerFactory->updateTime(time);
+    }
+
+    QCOMPARE(predictor->predictedPosition(), QPointF(40, 0));
+}
+
+void tst_TouchPositionPredictor::disabled()
+{
+    predictor->setEnabled(false);
+
+    moveTo(0, QPointF(0, 0));
+    moveTo(10, QPointF(20, 0));
+    moveTo(20, QPointF(40, 0));
+
+    QCOMPARE(predictor->numSamples(), 0);
+    QCOMPARE(predictor->predictedPosition(), QPointF(40, 0));
+
+    predictor->setEnabled(true);
+    moveTo(30, QPointF(60, 0));
+
+    // movement from while it was disabled is not taken into account
+    QCOMPARE(predictor->numSamples(), 1);
+    QCOMPARE(predictor->predictedPosition(), QPointF(60, 0));
+}
+
+void tst_TouchPositionPredictor::traces_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("swipe") << (int)Trace::Swipe;
+    QTest::newRow("steady drag") << (int)Trace::SteadyDrag;
+    QTest::newRow("arc") << (int)Trace::Arc;
+}
+
+/*
+    Compares how far the predicted and the reported positions are from where
+    the finger actually is predictionTime later
+ */
+void tst_TouchPositionPredictor::traces()
+{
+    QFETCH(int, path);
+    Trace trace((Trace::Path)path);
+
+    qreal trackedError = 0;
+    qreal predictedError = 0;
+
+    auto events = trace.events();
+    for (int i = 0; i < events.count(); ++i) {
+        moveTo(events[i].first, events[i].second);
+
+        const QPointF actual = trace.positionAt(events[i].first + predictor->predictionTime());
+        trackedError += distance(predictor->trackedPosition(), actual);
+        predictedError += distance(predictor->predictedPosition(), actual);
+    }
+
+    trackedError /= events.count();
+    predictedError /= events.count();
+    QVERIFY2(predictedError < trackedError / 2,
+             qPrintable(QString("average error, tracked: %1 predicted: %2").arg(trackedError).arg(predictedError)));
+}
+
+QTEST_MAIN(tst_TouchPositionPredictor)
+
+#include "tst_TouchPositionPredictor.moc"
@@ -629,7 +629,7 @@ Item {
             waitForRendering(dashContent);
             dashContent.setCurrentScopeAtIndex(0);
 
-            // Our cards are of type AbstractButton as defined in CardCreator.js
+            // Our cards are of type AbstractButton as generated by CardCreator
             // This gives also other things that are not cards but for our purpose it
             // does not matter
 
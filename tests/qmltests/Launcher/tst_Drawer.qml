@@ -133,6 +133,7 @@ StyledItem {
         function init() {
             launcher.lastSelectedApplication = "";
             launcher.lockedVisible = false;
+            launcher.predictTouch = false;
             launcher.hide();
             var drawer = findChild(launcher, "drawer");
             tryCompare(drawer, "x", -drawer.width);
@@ -246,12 +247,16 @@ StyledItem {
 
         function test_dragDirectionOnLeftEdgeDrag_data() {
             return [
-                { tag: "reveal", direction: "right", endState: "drawer" },
-                { tag: "cancel", direction: "left", endState: "visible" },
+                { tag: "reveal", direction: "right", endState: "drawer", predictTouch: false },
+                { tag: "cancel", direction: "left", endState: "visible", predictTouch: false },
+                // A prediction overshooting the turn must not decide the direction
+                { tag: "reveal predicted", direction: "right", endState: "drawer", predictTouch: true },
+                { tag: "cancel predicted", direction: "left", endState: "visible", predictTouch: true },
             ]
         }
 
         function test_dragDirectionOnLeftEdgeDrag(data) {
+            launcher.predictTouch = data.predictTouch;
             var startX = launcher.dragAreaWidth/2;
             var startY = launcher.height/2;
             var stopX = startX + units.gu(35);
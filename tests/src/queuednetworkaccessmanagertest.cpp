@@ -0,0 +1,415 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "QueuedNetworkAccessManager.h"
+
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QSharedPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/*
+ * Just enough of an HTTP server for the tests: answers every GET with
+ * "content of <path>", or a 404 for paths starting with /missing, and
+ * remembers the paths it was asked for.
+ *
+ * Paths in versions are answered with "<version> of <path>", the version
+ * as ETag and an immediate expiration, and a 304 if the request already
+ * has that version.
+ */
+class HttpStandIn : public QTcpServer
+{
+    Q_OBJECT
+public:
+    HttpStandIn()
+    {
+        connect(this, &QTcpServer::newConnection, this, &HttpStandIn::onNewConnection);
+    }
+
+    QUrl url(const QString &path) const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1%2").arg(serverPort()).arg(path));
+    }
+
+    QStringList requests;
+    QStringList conditionalRequests;
+    QHash<QByteArray, QByteArray> versions;
+    QHash<QByteArray, QByteArray> cacheControls;
+
+private Q_SLOTS:
+    void onNewConnection()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            connect(socket, &QIODevice::readyRead, this, [this, socket] { onReadyRead(socket); });
+            connect(socket, &QAbstractSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    }
+
+private:
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &buffer = m_buffers[socket];
+        buffer += socket->readAll();
+
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) != -1) {
+            const QList<QByteArray> lines = buffer.left(end).split('\n');
+            buffer.remove(0, end + 4);
+            const QByteArray path = lines.first().split(' ').value(1);
+            requests << QString::fromLatin1(path);
+
+            QByteArray ifNoneMatch;
+            Q_FOREACH(const QByteArray &line, lines) {
+                if (line.toLower().startsWith("if-none-match:")) {
+                    ifNoneMatch = line.mid(line.indexOf(':') + 1).trimmed();
+                    conditionalRequests << QString::fromLatin1(path);
+                }
+            }
+
+            const bool missing = path.startsWith("/missing");
+            const QByteArray version = versions.value(path);
+            const QByteArray etag = '"' + version + '"';
+            const QByteArray cacheControl = cacheControls.value(path, "max-age=0");
+            if (!version.isEmpty() && ifNoneMatch == etag) {
+                socket->write("HTTP/1.1 304 Not Modified\r\nETag: " + etag + "\r\nCache-Control: " + cacheControl + "\r\n\r\n");
+                continue;
+            }
+
+            const QByteArray body = (version.isEmpty() ? "content" : version) + " of " + path;
+            QByteArray response = missing ? "HTTP/1.1 404 Not Found\r\n" : "HTTP/1.1 200 OK\r\n";
+            response += "Content-Type: text/plain\r\n";
+            if (!version.isEmpty()) {
+                response += "ETag: " + etag + "\r\nCache-Control: " + cacheControl + "\r\n";
+            }
+            response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n";
+            response += body;
+            socket->write(response);
+        }
+    }
+
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+};
+
+class QueuedNetworkAccessManagerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QNetworkReply *get(const QString &path, QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority)
+    {
+        QNetworkRequest request(server->url(path));
+        request.setPriority(priority);
+        return manager->get(request);
+    }
+
+    void useCache()
+    {
+        QNetworkDiskCache *cache = new QNetworkDiskCache(manager);
+        cache->setCacheDirectory(cacheDir->path());
+        manager->setCache(cache);
+    }
+
+    QByteArray fetch(const QString &path, bool *fromCache = nullptr)
+    {
+        QScopedPointer<QNetworkReply> reply(get(path));
+        QSignalSpy finishedSpy(reply.data(), SIGNAL(finished()));
+        if (!reply->isFinished()) {
+            finishedSpy.wait();
+        }
+        if (fromCache) {
+            *fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+        }
+        return reply->readAll();
+    }
+
+private Q_SLOTS:
+    void init()
+    {
+        server = new HttpStandIn();
+        QVERIFY(server->listen(QHostAddress::LocalHost));
+        manager = new QueuedNetworkAccessManager();
+        cacheDir = new QTemporaryDir();
+    }
+
+    void cleanup()
+    {
+        delete manager;
+        delete server;
+        delete cacheDir;
+    }
+
+    void testGet()
+    {
+        QScopedPointer<QNetworkReply> reply(get("/image.png"));
+        QTRY_VERIFY(reply->isFinished());
+
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+        QCOMPARE(reply->header(QNetworkRequest::ContentTypeHeader).toString(), QString("text/plain"));
+        QCOMPARE(reply->readAll(), QByteArray("content of /image.png"));
+        QCOMPARE(manager->activeRequests(), 0);
+    }
+
+    void testError()
+    {
+        QScopedPointer<QNetworkReply> reply(get("/missing.png"));
+        QSignalSpy errorSpy(reply.data(), SIGNAL(error(QNetworkReply::NetworkError)));
+        QTRY_VERIFY(reply->isFinished());
+
+        QCOMPARE(reply->error(), QNetworkReply::ContentNotFoundError);
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 404);
+        QCOMPARE(errorSpy.count(), 1);
+    }
+
+    void testCoalescing()
+    {
+        QList<QSharedPointer<QNetworkReply>> replies;
+        for (int i = 0; i < 5; ++i) {
+            replies << QSharedPointer<QNetworkReply>(get("/same.png"));
+        }
+        QCOMPARE(manager->activeRequests(), 1);
+
+        Q_FOREACH(const QSharedPointer<QNetworkReply> &reply, replies) {
+            QTRY_VERIFY(reply->isFinished());
+            QCOMPARE(reply->error(), QNetworkReply::NoError);
+            QCOMPARE(reply->readAll(), QByteArray("content of /same.png"));
+        }
+        QCOMPARE(server->requests, QStringList() << "/same.png");
+
+        // Once done the url is fetched again
+        QScopedPointer<QNetworkReply> reply(get("/same.png"));
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(server->requests.count(), 2);
+    }
+
+    void testPriorities()
+    {
+        manager->setMaximumActiveRequests(1);
+
+        QList<QSharedPointer<QNetworkReply>> replies;
+        replies << QSharedPointer<QNetworkReply>(get("/first.png", QNetworkRequest::LowPriority));
+        replies << QSharedPointer<QNetworkReply>(get("/low.png", QNetworkRequest::LowPriority));
+        replies << QSharedPointer<QNetworkReply>(get("/normal.png"));
+        replies << QSharedPointer<QNetworkReply>(get("/high.png", QNetworkRequest::HighPriority));
+        replies << QSharedPointer<QNetworkReply>(get("/buffered.png", QNetworkRequest::LowPriority));
+        replies << QSharedPointer<QNetworkReply>(get("/normal2.png"));
+        QCOMPARE(manager->activeRequests(), 1);
+        QCOMPARE(manager->queuedRequests(), 5);
+
+        // Scrolled into view while waiting
+        QueuedNetworkAccessManager::setUrlPriority(server->url("/buffered.png"), QNetworkRequest::HighPriority);
+
+        Q_FOREACH(const QSharedPointer<QNetworkReply> &reply, replies) {
+            QTRY_VERIFY(reply->isFinished());
+        }
+        QueuedNetworkAccessManager::clearUrlPriority(server->url("/buffered.png"));
+
+        QCOMPARE(server->requests, QStringList() << "/first.png" << "/high.png" << "/buffered.png"
+                                                 << "/normal.png" << "/normal2.png" << "/low.png");
+    }
+
+    void testUrlVisible()
+    {
+        manager->setMaximumActiveRequests(1);
+
+        QScopedPointer<QNetworkReply> first(get("/first.png"));
+        QScopedPointer<QNetworkReply> normal(get("/normal.png"));
+        QScopedPointer<QNetworkReply> hidden(get("/hidden.png"));
+        QScopedPointer<QNetworkReply> visible(get("/visible.png"));
+
+        // The way the Dash views reach it through the engine's manager
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/visible.png")), Q_ARG(bool, true)));
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/hidden.png")), Q_ARG(bool, true)));
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/hidden.png")), Q_ARG(bool, false)));
+
+        QTRY_VERIFY(hidden->isFinished());
+        QVERIFY(visible->isFinished());
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/visible.png")), Q_ARG(bool, false)));
+
+        QCOMPARE(server->requests, QStringList() << "/first.png" << "/visible.png" << "/normal.png" << "/hidden.png");
+    }
+
+    void testUrlVisibleCounted()
+    {
+        manager->setMaximumActiveRequests(1);
+
+        // Two views show the same art, one of them hides it
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/art.png")), Q_ARG(bool, true)));
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/art.png")), Q_ARG(bool, true)));
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/art.png")), Q_ARG(bool, false)));
+
+        QScopedPointer<QNetworkReply> first(get("/first.png"));
+        QScopedPointer<QNetworkReply> normal(get("/normal.png"));
+        QScopedPointer<QNetworkReply> art(get("/art.png"));
+        QTRY_VERIFY(normal->isFinished());
+        QVERIFY(art->isFinished());
+        QCOMPARE(server->requests, QStringList() << "/first.png" << "/art.png" << "/normal.png");
+
+        // Hidden by both now, and hiding it once more doesn't go below none
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/art.png")), Q_ARG(bool, false)));
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/art.png")), Q_ARG(bool, false)));
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/art.png")), Q_ARG(bool, true)));
+        QVERIFY(QMetaObject::invokeMethod(manager, "setUrlVisible", Q_ARG(QUrl, server->url("/art.png")), Q_ARG(bool, false)));
+        server->requests.clear();
+
+        QScopedPointer<QNetworkReply> second(get("/second.png"));
+        QScopedPointer<QNetworkReply> other(get("/other.png"));
+        QScopedPointer<QNetworkReply> artAgain(get("/art.png"));
+        QTRY_VERIFY(artAgain->isFinished());
+        QCOMPARE(server->requests, QStringList() << "/second.png" << "/other.png" << "/art.png");
+    }
+
+    void testCoalescedPriority()
+    {
+        manager->setMaximumActiveRequests(1);
+
+        QScopedPointer<QNetworkReply> first(get("/first.png"));
+        QScopedPointer<QNetworkReply> normal(get("/normal.png"));
+        QScopedPointer<QNetworkReply> buffered(get("/art.png", QNetworkRequest::LowPriority));
+        QScopedPointer<QNetworkReply> visible(get("/art.png", QNetworkRequest::HighPriority));
+
+        QTRY_VERIFY(normal->isFinished());
+        QVERIFY(visible->isFinished());
+        QVERIFY(buffered->isFinished());
+        QCOMPARE(server->requests, QStringList() << "/first.png" << "/art.png" << "/normal.png");
+    }
+
+    void testAbortQueued()
+    {
+        manager->setMaximumActiveRequests(1);
+
+        QScopedPointer<QNetworkReply> first(get("/first.png"));
+        QScopedPointer<QNetworkReply> second(get("/second.png"));
+        QSignalSpy finishedSpy(second.data(), SIGNAL(finished()));
+        QCOMPARE(manager->queuedRequests(), 1);
+
+        second->abort();
+        QCOMPARE(finishedSpy.count(), 1);
+        QCOMPARE(second->error(), QNetworkReply::OperationCanceledError);
+        QCOMPARE(manager->queuedRequests(), 0);
+
+        QTRY_VERIFY(first->isFinished());
+        QTest::qWait(50);
+        QCOMPARE(server->requests, QStringList() << "/first.png");
+    }
+
+    void testAbortShared()
+    {
+        QScopedPointer<QNetworkReply> kept(get("/shared.png"));
+        QScopedPointer<QNetworkReply> aborted(get("/shared.png"));
+
+        aborted->abort();
+        QCOMPARE(aborted->error(), QNetworkReply::OperationCanceledError);
+
+        QTRY_VERIFY(kept->isFinished());
+        QCOMPARE(kept->error(), QNetworkReply::NoError);
+        QCOMPARE(kept->readAll(), QByteArray("content of /shared.png"));
+    }
+
+    void testDeleteActive()
+    {
+        manager->setMaximumActiveRequests(1);
+
+        QNetworkReply *deleted = get("/deleted.png");
+        QScopedPointer<QNetworkReply> next(get("/next.png"));
+        delete deleted;
+
+        // The slot is freed right away
+        QCOMPARE(manager->activeRequests(), 1);
+        QCOMPARE(manager->queuedRequests(), 0);
+        QTRY_VERIFY(next->isFinished());
+        QCOMPARE(next->readAll(), QByteArray("content of /next.png"));
+    }
+
+    void testStaleWhileRevalidate()
+    {
+        useCache();
+        manager->setStaleWhileRevalidate(true);
+        QSignalSpy updatedSpy(manager, &QueuedNetworkAccessManager::updated);
+        server->versions["/art.png"] = "v1";
+
+        bool fromCache;
+        QCOMPARE(fetch("/art.png", &fromCache), QByteArray("v1 of /art.png"));
+        QVERIFY(!fromCache);
+
+        // The expired copy is shown, the new one fetched behind it
+        server->versions["/art.png"] = "v2";
+        QCOMPARE(fetch("/art.png", &fromCache), QByteArray("v1 of /art.png"));
+        QVERIFY(fromCache);
+        QTRY_COMPARE(updatedSpy.count(), 1);
+        QCOMPARE(updatedSpy.first().first().toUrl(), server->url("/art.png"));
+        QCOMPARE(server->conditionalRequests, QStringList() << "/art.png");
+
+        QCOMPARE(fetch("/art.png", &fromCache), QByteArray("v2 of /art.png"));
+        QVERIFY(fromCache);
+    }
+
+    void testStaleWhileRevalidateNotModified()
+    {
+        useCache();
+        manager->setStaleWhileRevalidate(true);
+        QSignalSpy updatedSpy(manager, &QueuedNetworkAccessManager::updated);
+        server->versions["/art.png"] = "v1";
+
+        QCOMPARE(fetch("/art.png"), QByteArray("v1 of /art.png"));
+        QCOMPARE(fetch("/art.png"), QByteArray("v1 of /art.png"));
+
+        QTRY_COMPARE(server->conditionalRequests, QStringList() << "/art.png");
+        QTRY_COMPARE(manager->activeRequests(), 0);
+        QCOMPARE(updatedSpy.count(), 0);
+    }
+
+    void testStaleWhileRevalidateMustRevalidate()
+    {
+        useCache();
+        manager->setStaleWhileRevalidate(true);
+        QSignalSpy updatedSpy(manager, &QueuedNetworkAccessManager::updated);
+        server->versions["/art.png"] = "v1";
+        server->cacheControls["/art.png"] = "max-age=0, Must-Revalidate";
+
+        QCOMPARE(fetch("/art.png"), QByteArray("v1 of /art.png"));
+
+        // The expired copy can't be shown, the server is asked first
+        server->versions["/art.png"] = "v2";
+        bool fromCache;
+        QCOMPARE(fetch("/art.png", &fromCache), QByteArray("v2 of /art.png"));
+        QVERIFY(!fromCache);
+        QCOMPARE(server->conditionalRequests, QStringList() << "/art.png");
+        QCOMPARE(updatedSpy.count(), 0);
+    }
+
+    void testWithoutStaleWhileRevalidate()
+    {
+        useCache();
+        server->versions["/art.png"] = "v1";
+
+        QCOMPARE(fetch("/art.png"), QByteArray("v1 of /art.png"));
+        server->versions["/art.png"] = "v2";
+        QCOMPARE(fetch("/art.png"), QByteArray("v2 of /art.png"));
+    }
+
+private:
+    HttpStandIn *server = nullptr;
+    QueuedNetworkAccessManager *manager = nullptr;
+    QTemporaryDir *cacheDir = nullptr;
+};
+
+QTEST_GUILESS_MAIN(QueuedNetworkAccessManagerTest)
+
+#include "queuednetworkaccessmanagertest.moc"